@@ -0,0 +1,150 @@
+/*!
+ *\file objparserbenchmark.cpp
+ *\brief Throughput and accuracy measurement of OBJ parser
+ *
+ * Parses OBJ files given in command line (meshes/model.obj by default) with ObjParser
+ * and with line-based sscanf parser similar to the previous QString-based reader.
+ * Throughput is reported in MB/s, vertex coordinates parsed by ObjParser are compared with strtod results.
+ *
+ * Build (no Qt is needed):
+ *   cl /O2 /EHsc /I..\src /I..\lib\vmath-0.10\src objparserbenchmark.cpp ..\src\objparser.cpp
+ *   g++ -O2 -I../src -I../lib/vmath-0.10/src objparserbenchmark.cpp ../src/objparser.cpp
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#include "objparser.h"
+
+#define REPEATS_COUNT 20
+
+static bool readFile(const char *fileName, std::vector<char> &contents) {
+  FILE *file = fopen(fileName, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  contents.resize(size);
+  bool isRead = size == 0 || fread(&contents[0], 1, size, file) == static_cast<size_t>(size);
+  fclose(file);
+  return isRead;
+}
+
+// Reference parser, splits contents into lines and scans them with sscanf
+static size_t parseWithScanf(const std::vector<char> &contents, std::vector<float> &coordinates) {
+  size_t trianglesCount = 0;
+  char line[1024];
+  const char *cursor = contents.empty() ? NULL : &contents[0];
+  const char *end = cursor + contents.size();
+
+  while (cursor < end) {
+    const char *lineEnd = std::find(cursor, end, '\n');
+    size_t length = std::min(static_cast<size_t>(lineEnd - cursor), sizeof(line) - 1);
+    memcpy(line, cursor, length);
+    line[length] = '\0';
+    cursor = lineEnd + 1;
+
+    if (line[0] == 'v' && line[1] == ' ') {
+      float x, y, z;
+      sscanf(line + 2, "%f %f %f", &x, &y, &z);
+      coordinates.push_back(x);
+      coordinates.push_back(y);
+      coordinates.push_back(z);
+    } else if (line[0] == 'f' && line[1] == ' ') {
+      int verticesCount = 0;
+      for (char *token = strtok(line + 2, " \t\r"); token != NULL; token = strtok(NULL, " \t\r")) {
+        int position = 0, textureCoordinates = 0, normal = 0;
+        sscanf(token, "%d/%d/%d", &position, &textureCoordinates, &normal);
+        ++verticesCount;
+      }
+      trianglesCount += std::max(verticesCount - 2, 0);
+    }
+  }
+  return trianglesCount;
+}
+
+// Compares parsed coordinates with correctly rounded ones, returns number of mismatching floats
+static int compareWithStrtod(const std::vector<char> &contents, const ObjParser &parser, float &maxRelativeError) {
+  std::vector<char> text(contents);
+  text.push_back('\0');
+
+  const std::vector<Vector> &positions = parser.getMeshData().positions;
+  size_t positionIndex = 0;
+  int mismatchesCount = 0;
+  maxRelativeError = 0.f;
+
+  for (char *line = strtok(&text[0], "\n"); line != NULL && positionIndex < positions.size(); line = strtok(NULL, "\n")) {
+    if (line[0] != 'v' || line[1] != ' ') {
+      continue;
+    }
+    char *cursor = line + 2;
+    const Vector &position = positions[positionIndex++];
+    const float parsed[3] = { position.x, position.y, position.z };
+    for (int component = 0; component < 3; ++component) {
+      float reference = static_cast<float>(strtod(cursor, &cursor));
+      if (parsed[component] != reference) {
+        ++mismatchesCount;
+        float relativeError = fabsf(parsed[component] - reference) / std::max(fabsf(reference), FLT_MIN);
+        maxRelativeError = std::max(maxRelativeError, relativeError);
+      }
+    }
+  }
+  return mismatchesCount;
+}
+
+static void runBenchmark(const char *fileName) {
+  std::vector<char> contents;
+  if (!readFile(fileName, contents)) {
+    printf("Unable to read file '%s'\n", fileName);
+    return;
+  }
+  const double megabytes = contents.size() / (1024.0 * 1024.0);
+  const char *begin = contents.empty() ? NULL : &contents[0];
+
+  size_t trianglesCount = 0;
+  clock_t start = clock();
+  for (int repeat = 0; repeat < REPEATS_COUNT; ++repeat) {
+    ObjParser parser;
+    if (!parser.parse(begin, begin + contents.size())) {
+      printf("'%s': malformed line %d\n", fileName, parser.getErrorLineNumber());
+      return;
+    }
+    trianglesCount = parser.getMeshData().triangleVertices.size() / 3;
+  }
+  double parserSeconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / REPEATS_COUNT;
+
+  size_t scanfTrianglesCount = 0;
+  start = clock();
+  for (int repeat = 0; repeat < REPEATS_COUNT; ++repeat) {
+    std::vector<float> coordinates;
+    scanfTrianglesCount = parseWithScanf(contents, coordinates);
+  }
+  double scanfSeconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC / REPEATS_COUNT;
+
+  ObjParser parser;
+  parser.parse(begin, begin + contents.size());
+  float maxRelativeError;
+  int mismatchesCount = compareWithStrtod(contents, parser, maxRelativeError);
+
+  printf("%s: %.2f MB, %u triangles\n", fileName, megabytes, static_cast<unsigned>(trianglesCount));
+  printf("  ObjParser %8.1f MB/s\n", megabytes / std::max(parserSeconds, 1e-9));
+  printf("  sscanf    %8.1f MB/s (%u triangles)\n", megabytes / std::max(scanfSeconds, 1e-9), static_cast<unsigned>(scanfTrianglesCount));
+  printf("  coordinates differing from strtod: %d, max relative error %.3g\n", mismatchesCount, maxRelativeError);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    runBenchmark("../meshes/model.obj");
+  }
+  for (int i = 1; i < argc; ++i) {
+    runBenchmark(argv[i]);
+  }
+  return 0;
+}
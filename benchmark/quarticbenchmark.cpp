@@ -0,0 +1,202 @@
+/*!
+ *\file quarticbenchmark.cpp
+ *\brief Accuracy and speed comparison of torus quartic solvers
+ *
+ * Compares double precision QuarticEquation from quarticsolver library, as it was used by Torus,
+ * with FloatQuarticEquation used together with bounding volume culling and ray origin shifting.
+ * Rays are shot from the camera of scenes/torus.xml through the torus bounding square,
+ * the closest root of each solver is checked against reference root polished in long double.
+ *
+ * Build (no Qt is needed):
+ *   cl /O2 /EHsc /I..\src /I..\lib\quarticsolver\src quarticbenchmark.cpp ..\src\floatquarticequation.cpp ..\lib\quarticsolver\src\quarticsolver.cpp
+ *   g++ -O2 -I../src -I../lib/quarticsolver/src quarticbenchmark.cpp ../src/floatquarticequation.cpp ../lib/quarticsolver/src/quarticsolver.cpp
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#include <quarticsolver.h>
+#include "floatquarticequation.h"
+
+#define RAYS_COUNT 1000000
+#define REPEATS_COUNT 5
+#define NO_ROOT -1.f
+
+// Torus from scenes/torus.xml in its local frame
+static const float innerRadius = 1.f;
+static const float outerRadius = 3.f;
+
+struct LocalRay {
+  float origin[3];
+  float direction[3];
+};
+
+struct Coefficients {
+  float b, c, d, e;
+};
+
+static float dot(const float *a, const float *b) {
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+// Same coefficients as Torus::intersectWithRay calculates for normalized direction
+static Coefficients calculateCoefficients(const float *origin, const float *direction) {
+  float squaredOuterRadius = outerRadius * outerRadius;
+  float fourSquaredOuterRadius = 4 * squaredOuterRadius;
+  float d = dot(origin, origin) + squaredOuterRadius - innerRadius * innerRadius;
+  Coefficients coefficients;
+  coefficients.b = 4 * dot(origin, direction);
+  coefficients.c = 2 * d + coefficients.b * coefficients.b * 0.25f - fourSquaredOuterRadius * (direction[0] * direction[0] + direction[1] * direction[1]);
+  coefficients.d = coefficients.b * d - 2 * fourSquaredOuterRadius * (origin[0] * direction[0] + origin[1] * direction[1]);
+  coefficients.e = d * d - fourSquaredOuterRadius * (origin[0] * origin[0] + origin[1] * origin[1]);
+  return coefficients;
+}
+
+// Closest positive root by quarticsolver library, as Torus used to find it
+static float solveWithDoubleSolver(const LocalRay &ray) {
+  Coefficients coefficients = calculateCoefficients(ray.origin, ray.direction);
+  QuarticEquation equation(1.0, coefficients.b, coefficients.c, coefficients.d, coefficients.e);
+  double roots[4] = {-1.0, -1.0, -1.0, -1.0};
+  int rootsCount = equation.Solve(roots);
+  float closestRoot = NO_ROOT;
+  for (int idx = 0; idx < rootsCount; ++idx) {
+    float root = static_cast<float>(roots[idx]);
+    if (root > 0.000001f && (closestRoot == NO_ROOT || root < closestRoot)) {
+      closestRoot = root;
+    }
+  }
+  return closestRoot;
+}
+
+// Closest positive root by culling and float solver, as Torus finds it now
+static float solveWithFloatSolver(const LocalRay &ray) {
+  const float *origin = ray.origin;
+  const float *direction = ray.direction;
+  float boundingRadius = outerRadius + innerRadius;
+  float originDotDirection = dot(origin, direction);
+  float descriminant = originDotDirection * originDotDirection - dot(origin, origin) + boundingRadius * boundingRadius;
+  if (descriminant < 0.f) {
+    return NO_ROOT;
+  }
+  descriminant = sqrtf(descriminant);
+  float nearDistance = -originDotDirection - descriminant;
+  float farDistance = -originDotDirection + descriminant;
+  if (direction[2] != 0.f) {
+    float slabNear = (-innerRadius - origin[2]) / direction[2];
+    float slabFar = (innerRadius - origin[2]) / direction[2];
+    nearDistance = std::max(nearDistance, std::min(slabNear, slabFar));
+    farDistance = std::min(farDistance, std::max(slabNear, slabFar));
+  }
+  nearDistance = std::max(nearDistance, 0.f);
+  if (nearDistance > farDistance) {
+    return NO_ROOT;
+  }
+
+  float shiftedOrigin[3] = {origin[0] + direction[0] * nearDistance,
+                            origin[1] + direction[1] * nearDistance,
+                            origin[2] + direction[2] * nearDistance};
+  Coefficients coefficients = calculateCoefficients(shiftedOrigin, direction);
+  FloatQuarticEquation equation(coefficients.b, coefficients.c, coefficients.d, coefficients.e);
+  float roots[4];
+  int rootsCount = equation.solve(0.f, farDistance - nearDistance, roots);
+  for (int idx = 0; idx < rootsCount; ++idx) {
+    if (roots[idx] + nearDistance > 0.000001f) {
+      return roots[idx] + nearDistance;
+    }
+  }
+  return NO_ROOT;
+}
+
+// Signed distance from point to torus surface, its zero crossing along the ray gives reference root
+static long double torusDistance(const LocalRay &ray, long double distance) {
+  long double x = ray.origin[0] + ray.direction[0] * distance;
+  long double y = ray.origin[1] + ray.direction[1] * distance;
+  long double z = ray.origin[2] + ray.direction[2] * distance;
+  long double radial = sqrtl(x * x + y * y) - outerRadius;
+  return sqrtl(radial * radial + z * z) - innerRadius;
+}
+
+// Refines root found by a solver with bisection in long double, returns solver error
+static float calculateError(const LocalRay &ray, float root) {
+  long double step = 0.01L;
+  long double left = root - step;
+  long double right = root + step;
+  if (left < 0.L || (torusDistance(ray, left) < 0.L) == (torusDistance(ray, right) < 0.L)) {
+    // Root is not a surface crossing
+    return -1.f;
+  }
+  for (int iteration = 0; iteration < 64; ++iteration) {
+    long double middle = 0.5L * (left + right);
+    if ((torusDistance(ray, middle) < 0.L) == (torusDistance(ray, left) < 0.L)) {
+      left = middle;
+    } else {
+      right = middle;
+    }
+  }
+  return static_cast<float>(fabsl(0.5L * (left + right) - root));
+}
+
+static std::vector<LocalRay> generateRays() {
+  // Camera position of scenes/torus.xml relative to torus center, rays cover torus bounding square
+  const float cameraPosition[3] = {0.f, 4.f, 16.f};
+  const float extent = outerRadius + innerRadius + 1.f;
+  srand(1);
+  std::vector<LocalRay> rays(RAYS_COUNT);
+  for (int idx = 0; idx < RAYS_COUNT; ++idx) {
+    float target[3] = {extent * (2.f * rand() / RAND_MAX - 1.f),
+                       extent * (2.f * rand() / RAND_MAX - 1.f),
+                       innerRadius * (2.f * rand() / RAND_MAX - 1.f)};
+    float direction[3] = {target[0] - cameraPosition[0], target[1] - cameraPosition[1], target[2] - cameraPosition[2]};
+    float length = sqrtf(dot(direction, direction));
+    for (int axis = 0; axis < 3; ++axis) {
+      rays[idx].origin[axis] = cameraPosition[axis];
+      rays[idx].direction[axis] = direction[axis] / length;
+    }
+  }
+  return rays;
+}
+
+template <float (*solve)(const LocalRay &)>
+static void runBenchmark(const char *name, const std::vector<LocalRay> &rays) {
+  std::vector<float> closestRoots(rays.size());
+  clock_t start = clock();
+  for (int repeat = 0; repeat < REPEATS_COUNT; ++repeat) {
+    for (size_t idx = 0; idx < rays.size(); ++idx) {
+      closestRoots[idx] = solve(rays[idx]);
+    }
+  }
+  double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+
+  int hitsCount = 0;
+  int wrongCount = 0;
+  double errorSum = 0.0;
+  float maxError = 0.f;
+  for (size_t idx = 0; idx < rays.size(); ++idx) {
+    if (closestRoots[idx] == NO_ROOT) {
+      continue;
+    }
+    ++hitsCount;
+    float error = calculateError(rays[idx], closestRoots[idx]);
+    if (error < 0.f) {
+      ++wrongCount;
+      continue;
+    }
+    errorSum += error;
+    maxError = std::max(maxError, error);
+  }
+
+  printf("%-14s %8.1f ns/ray  hits %7d  wrong %5d  mean error %.3g  max error %.3g\n",
+         name, seconds * 1e9 / (static_cast<double>(rays.size()) * REPEATS_COUNT),
+         hitsCount, wrongCount, hitsCount > 0 ? errorSum / hitsCount : 0.0, maxError);
+}
+
+int main() {
+  std::vector<LocalRay> rays = generateRays();
+  runBenchmark<solveWithDoubleSolver>("double solver", rays);
+  runBenchmark<solveWithFloatSolver>("float solver", rays);
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*!
+ *\file shapebenchmark.cpp
+ *\brief Speed measurement of ray intersection with each shape type
+ *
+ * Shapes are taken from scenes/sample.xml, scenes/csg.xml and scenes/torus.xml, rays are shot from the camera of scenes/sample.xml
+ * at random points of the shape bounding box enlarged by half of its size, so that both hits and misses are timed.
+ * Only Shape constructors and intersectWithRay are used, so the benchmark builds against earlier revisions
+ * of the shapes as well and their timings can be compared.
+ *
+ * Build (QtCore headers and library are needed for shared pointers):
+ *   cl /O2 /EHsc /I..\src /I..\lib\vmath-0.10\src /I..\lib\quarticsolver\src /I%QTDIR%\include /I%QTDIR%\include\QtCore
+ *      shapebenchmark.cpp ..\src\ray.cpp ..\src\sphere.cpp ..\src\plane.cpp ..\src\box.cpp ..\src\cylinder.cpp ..\src\cone.cpp
+ *      ..\src\triangle.cpp ..\src\torus.cpp ..\src\floatquarticequation.cpp %QTDIR%\lib\QtCore4.lib
+ *   g++ -O2 -I../src -I../lib/vmath-0.10/src -I../lib/quarticsolver/src $(pkg-config --cflags --libs QtCore)
+ *      shapebenchmark.cpp ../src/ray.cpp ../src/sphere.cpp ../src/plane.cpp ../src/box.cpp ../src/cylinder.cpp ../src/cone.cpp
+ *      ../src/triangle.cpp ../src/torus.cpp ../src/floatquarticequation.cpp
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+
+#include "sphere.h"
+#include "plane.h"
+#include "box.h"
+#include "cylinder.h"
+#include "cone.h"
+#include "triangle.h"
+#include "torus.h"
+#include "rayintersection.h"
+
+#define RAYS_COUNT 200000
+#define REPEATS_COUNT 10
+
+static float generateFloat(float min, float max) {
+  return min + (max - min) * rand() / RAND_MAX;
+}
+
+static std::vector<Ray> generateRays(const Vector &boundsMin, const Vector &boundsMax) {
+  // Camera position of scenes/sample.xml
+  const Vector cameraPosition(0.f, 7.f, 21.f);
+  Vector margin = (boundsMax - boundsMin) * 0.5f;
+  Vector targetMin = boundsMin - margin;
+  Vector targetMax = boundsMax + margin;
+
+  srand(1);
+  std::vector<Ray> rays;
+  rays.reserve(RAYS_COUNT);
+  for (int idx = 0; idx < RAYS_COUNT; ++idx) {
+    Vector target(generateFloat(targetMin.x, targetMax.x), generateFloat(targetMin.y, targetMax.y), generateFloat(targetMin.z, targetMax.z));
+    Vector direction = target - cameraPosition;
+    direction.normalize();
+    rays.push_back(Ray(cameraPosition, direction));
+  }
+  return rays;
+}
+
+static void runBenchmark(const char *name, const Shape &shape, const Vector &boundsMin, const Vector &boundsMax) {
+  std::vector<Ray> rays = generateRays(boundsMin, boundsMax);
+
+  int hitsCount = 0;
+  double distancesSum = 0.0;
+  // The fastest repeat is reported, slower ones are disturbed by other processes
+  double bestSeconds = 0.0;
+  for (int repeat = 0; repeat < REPEATS_COUNT; ++repeat) {
+    hitsCount = 0;
+    distancesSum = 0.0;
+    clock_t start = clock();
+    for (size_t idx = 0; idx < rays.size(); ++idx) {
+      RayIntersection intersection = shape.intersectWithRay(rays[idx]);
+      if (intersection.rayIntersectsWithShape) {
+        ++hitsCount;
+        distancesSum += intersection.distanceFromRayOrigin;
+      }
+    }
+    double seconds = static_cast<double>(clock() - start) / CLOCKS_PER_SEC;
+    if (repeat == 0 || seconds < bestSeconds) {
+      bestSeconds = seconds;
+    }
+  }
+
+  printf("%-10s %8.1f ns/ray  hits %6d  mean distance %.4f\n",
+         name, bestSeconds * 1e9 / rays.size(), hitsCount, hitsCount > 0 ? distancesSum / hitsCount : 0.0);
+}
+
+int main() {
+  MaterialPointer material(new Material());
+
+  runBenchmark("sphere", Sphere(Vector(7.f, 2.5f, 7.f), 2.5f, material), Vector(4.5f, 0.f, 4.5f), Vector(9.5f, 5.f, 9.5f));
+  runBenchmark("plane", Plane(Vector(0.f, 1.f, 0.f), 0.f, material), Vector(-10.f, -1.f, -10.f), Vector(10.f, 1.f, 10.f));
+  runBenchmark("box", Box(Vector(5.f, 1.f, 3.f), Vector(9.f, 5.f, 7.f), material), Vector(5.f, 1.f, 3.f), Vector(9.f, 5.f, 7.f));
+  runBenchmark("cylinder", Cylinder(Vector(-7.f, 4.f, 7.f), Vector(-7.f, 0.f, 7.f), 2.f, material), Vector(-9.f, 0.f, 5.f), Vector(-5.f, 4.f, 9.f));
+  runBenchmark("cone", Cone(Vector(0.f, 7.f, 1.5f), Vector(0.f, 0.f, 1.5f), 2.5f, material), Vector(-2.5f, 0.f, -1.f), Vector(2.5f, 7.f, 4.f));
+  runBenchmark("triangle", Triangle(Vector(-2.f, 0.f, 13.f), Vector(2.f, 0.f, 13.f), Vector(0.f, 2.5f, 11.f), material),
+               Vector(-2.f, 0.f, 11.f), Vector(2.f, 2.5f, 13.f));
+  runBenchmark("torus", Torus(Vector(0.f, 3.f, 5.f), Vector(1.f, 2.f, 1.f), 1.f, 3.f, material), Vector(-4.f, -1.f, 1.f), Vector(4.f, 7.f, 9.f));
+  return 0;
+}
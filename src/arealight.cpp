@@ -0,0 +1,42 @@
+/*!
+ *\file arealight.cpp
+ *\brief Contains AreaLight class definition
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "arealight.h"
+
+AreaLight::AreaLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, Vector position, 
+                     float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient)
+  : PointLight(ambientIntensity, diffuseIntensity, specularIntensity, position, 
+               constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient) {
+  setSamplesCount(AREA_LIGHT_DEFAULT_SAMPLES_COUNT);
+}
+
+AreaLight::~AreaLight() {
+}
+
+void AreaLight::setSamplesCount(int samplesCount) {
+  // Strata count is a multiple of initial strata count, so that each initial stratum is a block of strata
+  int blocksCount = static_cast<int>(sqrtf(static_cast<float>(samplesCount)) / AREA_LIGHT_INITIAL_STRATA_COUNT + 0.5f);
+  mStrataCount = std::max(blocksCount, 1) * AREA_LIGHT_INITIAL_STRATA_COUNT;
+}
+
+bool AreaLight::calculateShadowRay(const Ray &ray, float distance, const Vector &normal, 
+                                   int stratumX, int stratumY, int strataCount, float u, float v, Ray &shadowRay) const {
+  Vector point = ray.getPointAt(distance);
+  Vector surfacePoint = sampleSurface(point, (stratumX + u) / strataCount, (stratumY + v) / strataCount);
+  Vector shadowRayDirection = surfacePoint - point;
+  float distanceToLight = shadowRayDirection.length();
+  shadowRayDirection.normalize();
+
+  // If the surface point is not visible from the point
+  if (shadowRayDirection.dotProduct(normal) <= 0.0) {
+    return false;
+  }
+
+  shadowRay = Ray(point + shadowRayDirection * EPS_FOR_SHADOW_RAYS, shadowRayDirection, 0.f, distanceToLight);
+  return true;
+}
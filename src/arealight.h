@@ -0,0 +1,46 @@
+/*!
+ *\file arealight.h
+ *\brief Contains AreaLight class declaration
+ */
+
+#pragma once
+
+#include "pointlight.h"
+
+#define AREA_LIGHT_DEFAULT_SAMPLES_COUNT 16
+// Strata count per side of the first sampling pass, its samples decide if the point lies in penumbra
+#define AREA_LIGHT_INITIAL_STRATA_COUNT 2
+
+class AreaLight;
+
+typedef QSharedPointer<AreaLight> AreaLightPointer;
+
+/*!
+ * Light source with surface, casts soft shadows.
+ * Shading is calculated as for point light placed in the light center, diffuse and specular components 
+ * are scaled by fraction of shadow rays to stratified points of light surface which are not occluded.
+ */
+class AreaLight : public PointLight {
+  public:
+    AreaLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, Vector position, 
+              float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient);
+    virtual ~AreaLight();
+
+    // Shadow rays count is rounded to the square of strata count per side, which is a multiple of initial strata count
+    void setSamplesCount(int samplesCount);
+    int getStrataCount() const { return mStrataCount; }
+
+    // Calculates shadow ray to the point of light surface in stratum (stratumX, stratumY) of strataCount x strataCount grid,
+    // u and v are random numbers in [0, 1) range placing the point inside stratum.
+    // Returns false if the surface point is below the point horizon, so it can not illuminate the point
+    bool calculateShadowRay(const Ray &ray, float distance, const Vector &normal, 
+                            int stratumX, int stratumY, int strataCount, float u, float v, Ray &shadowRay) const;
+    using PointLight::calculateShadowRay;
+
+  protected:
+    // Maps point of unit square to point of light surface visible from the shaded point
+    virtual Vector sampleSurface(const Vector &point, float u, float v) const = 0;
+
+  private:
+    int mStrataCount;
+};
@@ -0,0 +1,109 @@
+/*!
+ *\file asyncimagewriter.cpp
+ *\brief Contains AsyncImageWriter class definition
+ */
+
+#include <algorithm>
+#include <QMutexLocker>
+
+#include "asyncimagewriter.h"
+
+AsyncImageWriter::AsyncImageWriter(int queueCapacity)
+  : mQueueCapacity(std::max(queueCapacity, 1)),
+    mIsOpen(false),
+    mIsClosed(false),
+    mHasError(false) {
+}
+
+AsyncImageWriter::~AsyncImageWriter() {
+  close();
+}
+
+bool AsyncImageWriter::open(const QString &filePath, int imageWidth, int imageHeight) {
+  if (!mImageWriter.open(filePath, imageWidth, imageHeight)) {
+    return false;
+  }
+
+  mIsOpen = true;
+  mIsClosed = false;
+  mHasError = false;
+  start();
+  return true;
+}
+
+bool AsyncImageWriter::writeBand(std::vector<float> &colors, int rowsCount) {
+  QMutexLocker locker(&mMutex);
+  while (static_cast<int>(mBands.size()) >= mQueueCapacity && !mHasError) {
+    mBandWritten.wait(&mMutex);
+  }
+  if (mHasError) {
+    return false;
+  }
+
+  mBands.push_back(AsyncImageBand());
+  mBands.back().colors.swap(colors);
+  mBands.back().rowsCount = rowsCount;
+  // Caller gets buffer of written band to render the next one
+  if (!mFreeBuffers.empty()) {
+    colors.swap(mFreeBuffers.back());
+    mFreeBuffers.pop_back();
+  }
+  mBandQueued.wakeOne();
+  return true;
+}
+
+bool AsyncImageWriter::close() {
+  if (!mIsOpen) {
+    return !mHasError;
+  }
+
+  {
+    QMutexLocker locker(&mMutex);
+    mIsClosed = true;
+    mBandQueued.wakeOne();
+  }
+  wait();
+  mIsOpen = false;
+
+  const bool isWritten = mImageWriter.close();
+  return isWritten && !mHasError;
+}
+
+/*
+* protected:
+*/
+void AsyncImageWriter::run() {
+  std::vector<float> colors;
+
+  while (true) {
+    int rowsCount = 0;
+    {
+      QMutexLocker locker(&mMutex);
+      while (mBands.empty() && !mIsClosed) {
+        mBandQueued.wait(&mMutex);
+      }
+      if (mBands.empty()) {
+        return;
+      }
+      // Band stays in queue while it is written, so that queued bands do not exceed the capacity
+      colors.swap(mBands.front().colors);
+      rowsCount = mBands.front().rowsCount;
+    }
+
+    const bool isWritten = mImageWriter.writeBand(&colors[0], rowsCount);
+
+    QMutexLocker locker(&mMutex);
+    mBands.pop_front();
+    mFreeBuffers.push_back(std::vector<float>());
+    mFreeBuffers.back().swap(colors);
+    if (!isWritten) {
+      // Rendering is stopped at the next band, the rest of queued bands is dropped
+      mHasError = true;
+      mBands.clear();
+    }
+    mBandWritten.wakeAll();
+    if (mHasError) {
+      return;
+    }
+  }
+}
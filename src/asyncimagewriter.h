@@ -0,0 +1,60 @@
+/*!
+ *\file asyncimagewriter.h
+ *\brief Contains AsyncImageWriter class declaration
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "streamingimagewriter.h"
+
+class AsyncImageWriter;
+
+typedef QSharedPointer<AsyncImageWriter> AsyncImageWriterPointer;
+
+struct AsyncImageBand {
+  std::vector<float> colors;
+  int rowsCount;
+};
+
+/*!
+ * Writes bands of image with StreamingImageWriter on its own thread, so that tone mapping,
+ * encoding and writing of a band overlap with rendering of the next one.
+ * Queue of bands is bounded, rendering thread waits when it is full, so memory stays bounded by band size.
+ * Band buffers are passed by swapping vectors and are reused, so bands are neither copied nor allocated per band.
+ */
+class AsyncImageWriter : public QThread {
+  public:
+    explicit AsyncImageWriter(int queueCapacity);
+    virtual ~AsyncImageWriter();
+
+    // Opens file on calling thread, so that errors are reported at once, and starts writing thread
+    bool open(const QString &filePath, int imageWidth, int imageHeight);
+    // Queues band, colors are swapped with a buffer of an already written band. Waits while queue is full
+    bool writeBand(std::vector<float> &colors, int rowsCount);
+    // Waits until all queued bands are written
+    bool close();
+
+  protected:
+    virtual void run();
+
+  private:
+    StreamingImageWriter mImageWriter;
+    int mQueueCapacity;
+    QMutex mMutex;
+    QWaitCondition mBandQueued;
+    QWaitCondition mBandWritten;
+    // Band at front is being written, its colors are held by writing thread
+    std::deque<AsyncImageBand> mBands;
+    std::vector<std::vector<float> > mFreeBuffers;
+    bool mIsOpen;
+    // No more bands are queued, writing thread finishes when queue is empty
+    bool mIsClosed;
+    bool mHasError;
+};
@@ -0,0 +1,67 @@
+/*!
+ *\file boundingbox.h
+ *\brief Contains BoundingBox struct declaration and definition
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include "types.h"
+#include "ray.h"
+#include "mathcommons.h"
+
+/*!
+ * Axis aligned bounding box.
+ * Ray tests use branchless slab method relying on precalculated inverted ray direction and direction signs.
+ */
+struct BoundingBox {
+  BoundingBox() {}
+  BoundingBox(const Vector &minPoint, const Vector &maxPoint) : min(minPoint), max(maxPoint) {}
+
+  // Calculates distances at which ray enters and leaves box slabs, returns false if there is no overlap
+  bool intersectWithRay(const Ray &ray, float &nearDistance, float &farDistance) const {
+    const Vector &rayOrigin = ray.getOriginPosition();
+    const Vector &invertedDirection = ray.getInvertedDirection();
+
+    nearDistance = -MAX_DISTANCE_TO_INTERSECTON;
+    farDistance  = MAX_DISTANCE_TO_INTERSECTON;
+
+    // Near slab is the max bound for negative direction components and the min bound otherwise.
+    // Argument order of std::max/std::min keeps accumulated value when ray lies in slab plane (0 * inf = NaN)
+    nearDistance = std::max(nearDistance, (getBound(ray.getDirectionSign(0)).x - rayOrigin.x) * invertedDirection.x);
+    farDistance  = std::min(farDistance, (getBound(1 - ray.getDirectionSign(0)).x - rayOrigin.x) * invertedDirection.x);
+    nearDistance = std::max(nearDistance, (getBound(ray.getDirectionSign(1)).y - rayOrigin.y) * invertedDirection.y);
+    farDistance  = std::min(farDistance, (getBound(1 - ray.getDirectionSign(1)).y - rayOrigin.y) * invertedDirection.y);
+    nearDistance = std::max(nearDistance, (getBound(ray.getDirectionSign(2)).z - rayOrigin.z) * invertedDirection.z);
+    farDistance  = std::min(farDistance, (getBound(1 - ray.getDirectionSign(2)).z - rayOrigin.z) * invertedDirection.z);
+
+    return nearDistance <= farDistance;
+  }
+
+  // Checks if box overlaps with ray distance interval
+  bool intersectsWithRay(const Ray &ray) const {
+    float nearDistance, farDistance;
+    return intersectWithRay(ray, nearDistance, farDistance) &&
+           farDistance >= ray.getMinDistance() && 
+           nearDistance <= ray.getMaxDistance();
+  }
+
+  // Checks if boxes have common points
+  bool overlapsWithBox(const BoundingBox &other) const {
+    return min.x <= other.max.x && other.min.x <= max.x &&
+           min.y <= other.max.y && other.min.y <= max.y &&
+           min.z <= other.max.z && other.min.z <= max.z;
+  }
+
+  // Extends box to contain other box
+  void merge(const BoundingBox &other) {
+    min = componentwiseMin(min, other.min);
+    max = componentwiseMax(max, other.max);
+  }
+
+  const Vector &getBound(int index) const { return index ? max : min; }
+
+  Vector min;
+  Vector max;
+};
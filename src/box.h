@@ -1,6 +1,7 @@
 #pragma once
 
 #include "shape.h"
+#include "boundingbox.h"
 
 class Box;
 
@@ -14,7 +15,12 @@ class Box : public Shape {
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const BoundingBox &getBoundingBox() const { return mBoundingBox; }
+
   private:
-    Vector mMin;
-    Vector mMax;
+    BoundingBox mBoundingBox;
+
+    // Invariants calculated at construction
+    Vector mCenter;
+    Vector mInvertedHalfSize;
 };
\ No newline at end of file
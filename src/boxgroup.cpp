@@ -0,0 +1,102 @@
+/*!
+ *\file boxgroup.cpp
+ *\brief Contains BoxGroup class definition
+ */
+
+#include "boxgroup.h"
+#include "rayintersection.h"
+#include "simdpacket.h"
+
+BoxGroup::BoxGroup(const std::vector<BoxPointer> &boxes)
+  : Shape(MaterialPointer(NULL)),  // materials are owned by boxes
+    mBoxes(boxes) {
+  int paddedSize = (boxes.size() + PACKET_SIZE - 1) / PACKET_SIZE * PACKET_SIZE;
+  // Padding boxes are inverted (minimum is greater than maximum), so they are never intersected
+  for (int bound = 0; bound < 2; ++bound) {
+    float paddingValue = bound == 0 ? MAX_DISTANCE_TO_INTERSECTON : -MAX_DISTANCE_TO_INTERSECTON;
+    mBoundsX[bound].resize(paddedSize, paddingValue);
+    mBoundsY[bound].resize(paddedSize, paddingValue);
+    mBoundsZ[bound].resize(paddedSize, paddingValue);
+  }
+
+  for (int idx = 0, count = boxes.size(); idx < count; ++idx) {
+    const BoundingBox &boundingBox = boxes[idx]->getBoundingBox();
+    for (int bound = 0; bound < 2; ++bound) {
+      mBoundsX[bound][idx] = boundingBox.getBound(bound).x;
+      mBoundsY[bound][idx] = boundingBox.getBound(bound).y;
+      mBoundsZ[bound][idx] = boundingBox.getBound(bound).z;
+    }
+  }
+}
+
+BoxGroup::~BoxGroup() {
+}
+
+RayIntersection BoxGroup::intersectWithRay(const Ray &ray) const {
+  const Vector &rayOrigin = ray.getOriginPosition();
+  const Vector &invertedDirection = ray.getInvertedDirection();
+
+  Packet originX = packetSet(rayOrigin.x);
+  Packet originY = packetSet(rayOrigin.y);
+  Packet originZ = packetSet(rayOrigin.z);
+  Packet invertedDirectionX = packetSet(invertedDirection.x);
+  Packet invertedDirectionY = packetSet(invertedDirection.y);
+  Packet invertedDirectionZ = packetSet(invertedDirection.z);
+  Packet zero = packetSet(0.f);
+  Packet infinity = packetSet(MAX_DISTANCE_TO_INTERSECTON);
+  Packet minusInfinity = packetSet(-MAX_DISTANCE_TO_INTERSECTON);
+
+  // Near and far slabs are chosen once per ray by direction signs
+  const std::vector<float> &nearX = mBoundsX[ray.getDirectionSign(0)];
+  const std::vector<float> &farX  = mBoundsX[1 - ray.getDirectionSign(0)];
+  const std::vector<float> &nearY = mBoundsY[ray.getDirectionSign(1)];
+  const std::vector<float> &farY  = mBoundsY[1 - ray.getDirectionSign(1)];
+  const std::vector<float> &nearZ = mBoundsZ[ray.getDirectionSign(2)];
+  const std::vector<float> &farZ  = mBoundsZ[1 - ray.getDirectionSign(2)];
+
+  float closestDistance = MAX_DISTANCE_TO_INTERSECTON;
+  int closestBoxIndex = -1;
+  float distances[PACKET_SIZE];
+
+  for (int first = 0, count = nearX.size(); first < count; first += PACKET_SIZE) {
+    // Slab distances of PACKET_SIZE boxes, accumulators are passed last to skip NaN lanes
+    Packet nearDistance = packetMax(packetMul(packetSub(packetLoad(&nearX[first]), originX), invertedDirectionX), minusInfinity);
+    Packet farDistance  = packetMin(packetMul(packetSub(packetLoad(&farX[first]), originX), invertedDirectionX), infinity);
+    nearDistance = packetMax(packetMul(packetSub(packetLoad(&nearY[first]), originY), invertedDirectionY), nearDistance);
+    farDistance  = packetMin(packetMul(packetSub(packetLoad(&farY[first]), originY), invertedDirectionY), farDistance);
+    nearDistance = packetMax(packetMul(packetSub(packetLoad(&nearZ[first]), originZ), invertedDirectionZ), nearDistance);
+    farDistance  = packetMin(packetMul(packetSub(packetLoad(&farZ[first]), originZ), invertedDirectionZ), farDistance);
+
+    Packet isHit = packetAnd(packetLessOrEqual(nearDistance, farDistance), packetGreater(farDistance, zero));
+    if (packetMask(isHit) == 0) {
+      continue;
+    }
+
+    // Ray leaves the box if its origin is inside
+    Packet hitDistances = packetSelect(farDistance, nearDistance, packetGreater(nearDistance, zero));
+    hitDistances = packetSelect(infinity, hitDistances, isHit);
+    if (packetMask(packetLess(hitDistances, packetSet(closestDistance))) == 0) {
+      continue;
+    }
+
+    packetStore(distances, hitDistances);
+    for (int lane = 0; lane < PACKET_SIZE; ++lane) {
+      if (distances[lane] < closestDistance) {
+        closestDistance = distances[lane];
+        closestBoxIndex = first + lane;
+      }
+    }
+  }
+
+  if (closestBoxIndex < 0) {
+    return RayIntersection();
+  }
+
+  // Calculate complete intersection data for the closest box only
+  return mBoxes[closestBoxIndex]->intersectWithRay(ray);
+}
+
+Vector BoxGroup::getNormal(const Ray &ray, float distance) const {
+  // This method is actually never called
+  return Vector();
+}
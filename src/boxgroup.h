@@ -0,0 +1,40 @@
+/*!
+ *\file boxgroup.h
+ *\brief Contains BoxGroup class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "shape.h"
+#include "box.h"
+
+class BoxGroup;
+
+typedef QSharedPointer<BoxGroup> BoxGroupPointer;
+
+/*!
+ * Group of boxes stored as structure of arrays.
+ * Ray is tested against PACKET_SIZE boxes at once, full intersection data 
+ * is calculated only for the nearest hit box.
+ */
+class BoxGroup : public Shape {
+  public:
+    BoxGroup(const std::vector<BoxPointer> &boxes);
+    virtual ~BoxGroup();
+
+    virtual RayIntersection intersectWithRay(const Ray &ray) const;
+    virtual Vector getNormal(const Ray &ray, float distance) const;
+
+    const std::vector<BoxPointer> &getBoxes() const { return mBoxes; }
+
+  private:
+    std::vector<BoxPointer> mBoxes;
+
+    // Box bounds per axis, padded to packet size
+    // Index 0 contains minimum bounds, index 1 contains maximum bounds
+    std::vector<float> mBoundsX[2];
+    std::vector<float> mBoundsY[2];
+    std::vector<float> mBoundsZ[2];
+};
@@ -0,0 +1,249 @@
+/*!
+ *\file compiledscene.cpp
+ *\brief Contains CompiledScene class definition
+ */
+
+#include "compiledscene.h"
+
+static BoundingBox calculateSphereBounds(const Vector &center, float radius) {
+  Vector extent(radius, radius, radius);
+  return BoundingBox(center - extent, center + extent);
+}
+
+static BoundingBox calculateCapsBounds(const Vector &firstCenter, const Vector &secondCenter, float radius) {
+  BoundingBox bounds = calculateSphereBounds(firstCenter, radius);
+  bounds.merge(calculateSphereBounds(secondCenter, radius));
+  return bounds;
+}
+
+// Calculates world space bounds of shape, bounds of shape types which are not bounded are infinite
+static BoundingBox calculateShapeBounds(const Shape *shape, ShapeType type) {
+  switch (type) {
+    case SHAPE_TYPE_SPHERE: {
+      const Sphere *sphere = static_cast<const Sphere *>(shape);
+      return calculateSphereBounds(sphere->getCenter(), sphere->getRadius());
+    }
+    case SHAPE_TYPE_BOX:
+      return static_cast<const Box *>(shape)->getBoundingBox();
+    case SHAPE_TYPE_CYLINDER: {
+      const Cylinder *cylinder = static_cast<const Cylinder *>(shape);
+      return calculateCapsBounds(cylinder->getTopCenter(), cylinder->getBottomCenter(), cylinder->getRadius());
+    }
+    case SHAPE_TYPE_CONE: {
+      const Cone *cone = static_cast<const Cone *>(shape);
+      return calculateCapsBounds(cone->getTop(), cone->getBottomCenter(), cone->getRadius());
+    }
+    case SHAPE_TYPE_TRIANGLE: {
+      const Triangle *triangle = static_cast<const Triangle *>(shape);
+      BoundingBox bounds(triangle->getVertex0(), triangle->getVertex0());
+      bounds.merge(BoundingBox(triangle->getVertex1(), triangle->getVertex1()));
+      bounds.merge(BoundingBox(triangle->getVertex2(), triangle->getVertex2()));
+      return bounds;
+    }
+    case SHAPE_TYPE_TORUS: {
+      const Torus *torus = static_cast<const Torus *>(shape);
+      return calculateSphereBounds(torus->getCenter(), torus->getBoundingRadius());
+    }
+    case SHAPE_TYPE_MESH:
+      return static_cast<const MeshModel *>(shape)->getBoundingBox();
+    case SHAPE_TYPE_SPHERE_GROUP: {
+      const std::vector<SpherePointer> &spheres = static_cast<const SphereGroup *>(shape)->getSpheres();
+      BoundingBox bounds = calculateShapeBounds(spheres[0].data(), SHAPE_TYPE_SPHERE);
+      for (int idx = 1, count = spheres.size(); idx < count; ++idx) {
+        bounds.merge(calculateShapeBounds(spheres[idx].data(), SHAPE_TYPE_SPHERE));
+      }
+      return bounds;
+    }
+    case SHAPE_TYPE_BOX_GROUP: {
+      const std::vector<BoxPointer> &boxes = static_cast<const BoxGroup *>(shape)->getBoxes();
+      BoundingBox bounds = boxes[0]->getBoundingBox();
+      for (int idx = 1, count = boxes.size(); idx < count; ++idx) {
+        bounds.merge(boxes[idx]->getBoundingBox());
+      }
+      return bounds;
+    }
+    case SHAPE_TYPE_QUADRIC:
+      return static_cast<const Quadric *>(shape)->getBoundingBox();
+    case SHAPE_TYPE_QUADRIC_GROUP: {
+      const std::vector<QuadricPointer> &quadrics = static_cast<const QuadricGroup *>(shape)->getQuadrics();
+      BoundingBox bounds = quadrics[0]->getBoundingBox();
+      for (int idx = 1, count = quadrics.size(); idx < count; ++idx) {
+        bounds.merge(quadrics[idx]->getBoundingBox());
+      }
+      return bounds;
+    }
+    default: {
+      Vector extent(MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON);
+      return BoundingBox(-extent, extent);
+    }
+  }
+}
+
+// Calculates bounds of ray segment between its min and max distances
+static BoundingBox calculateRaySegmentBounds(const Ray &ray) {
+  Vector startPoint = ray.getPointAt(ray.getMinDistance());
+  Vector endPoint = ray.getPointAt(ray.getMaxDistance());
+  return BoundingBox(componentwiseMin(startPoint, endPoint), componentwiseMax(startPoint, endPoint));
+}
+
+CompiledScene::CompiledScene(const std::vector<ShapePointer> &shapes)
+  : mShapes(shapes) {
+  for each (auto shape in mShapes) {
+    ShapeType type = getShapeType(shape.data());
+    BoundingBox shapeBounds = calculateShapeBounds(shape.data(), type);
+    if (mBuckets[type].empty()) {
+      mBucketsBounds[type] = shapeBounds;
+    } else {
+      mBucketsBounds[type].merge(shapeBounds);
+    }
+    mBuckets[type].push_back(shape.data());
+    mShapesBounds[type].push_back(shapeBounds);
+  }
+}
+
+CompiledScene::~CompiledScene() {
+}
+
+RayIntersection CompiledScene::calculateNearestIntersection(const Ray &ray) const {
+  return intersectBuckets<false>(ray);
+}
+
+RayIntersection CompiledScene::calculateFirstIntersection(const Ray &ray) const {
+  return intersectBuckets<true>(ray);
+}
+
+unsigned CompiledScene::calculateVisibility(const Ray *rays, int raysCount, ShadowOccluder *occluders) const {
+  unsigned allRaysMask = raysCount < SHADOW_RAYS_BATCH_SIZE ? (1u << raysCount) - 1 : ~0u;
+  unsigned occludedMask = 0;
+
+  // Batch bounds start inverted, so an empty batch overlaps no bucket
+  Vector extent(MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON);
+  BoundingBox batchBounds(extent, -extent);
+  BoundingBox raysBounds[SHADOW_RAYS_BATCH_SIZE];
+  for (int rayIndex = 0; rayIndex < raysCount; ++rayIndex) {
+    raysBounds[rayIndex] = calculateRaySegmentBounds(rays[rayIndex]);
+    batchBounds.merge(raysBounds[rayIndex]);
+  }
+
+  for (int type = 0; type < SHAPE_TYPES_COUNT && occludedMask != allRaysMask; ++type) {
+    if (mBuckets[type].empty() || !mBucketsBounds[type].overlapsWithBox(batchBounds)) {
+      continue;
+    }
+
+    switch (type) {
+      case SHAPE_TYPE_SPHERE:        occludeByBucket<Sphere>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_PLANE:         occludeByBucket<Plane>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_BOX:           occludeByBucket<Box>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_CYLINDER:      occludeByBucket<Cylinder>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_CONE:          occludeByBucket<Cone>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_TRIANGLE:      occludeByBucket<Triangle>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_TORUS:         occludeByBucket<Torus>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_MESH:          occludeByBucket<MeshModel>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_CSG:           occludeByBucket<CSGTree>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_SPHERE_GROUP:  occludeByBucket<SphereGroup>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_BOX_GROUP:     occludeByBucket<BoxGroup>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_QUADRIC:       occludeByBucket<Quadric>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      case SHAPE_TYPE_QUADRIC_GROUP: occludeByBucket<QuadricGroup>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+      default:                       occludeByBucket<Shape>(type, rays, raysBounds, batchBounds, raysCount, allRaysMask, occludedMask, occluders); break;
+    }
+  }
+
+  return allRaysMask & ~occludedMask;
+}
+
+template <bool isAnyIntersectionEnough>
+RayIntersection CompiledScene::intersectBuckets(const Ray &ray) const {
+  RayIntersection nearestIntersection;
+
+  for (int type = 0; type < SHAPE_TYPES_COUNT; ++type) {
+    if (mBuckets[type].empty()) {
+      continue;
+    }
+
+    bool isFound = false;
+    switch (type) {
+      case SHAPE_TYPE_SPHERE:        isFound = intersectBucket<Sphere, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_PLANE:         isFound = intersectBucket<Plane, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_BOX:           isFound = intersectBucket<Box, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_CYLINDER:      isFound = intersectBucket<Cylinder, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_CONE:          isFound = intersectBucket<Cone, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_TRIANGLE:      isFound = intersectBucket<Triangle, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_TORUS:         isFound = intersectBucket<Torus, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_MESH:          isFound = intersectBucket<MeshModel, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_CSG:           isFound = intersectBucket<CSGTree, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_SPHERE_GROUP:  isFound = intersectBucket<SphereGroup, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_BOX_GROUP:     isFound = intersectBucket<BoxGroup, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_QUADRIC:       isFound = intersectBucket<Quadric, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      case SHAPE_TYPE_QUADRIC_GROUP: isFound = intersectBucket<QuadricGroup, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+      default:                       isFound = intersectBucket<Shape, isAnyIntersectionEnough>(type, ray, nearestIntersection); break;
+    }
+
+    if (isAnyIntersectionEnough && isFound) {
+      break;
+    }
+  }
+
+  return nearestIntersection;
+}
+
+template <class ShapeClass, bool isAnyIntersectionEnough>
+bool CompiledScene::intersectBucket(int type, const Ray &ray, RayIntersection &nearestIntersection) const {
+  const std::vector<const Shape *> &bucket = mBuckets[type];
+  const std::vector<BoundingBox> &shapesBounds = mShapesBounds[type];
+  bool isFound = false;
+
+  for (int idx = 0, count = bucket.size(); idx < count; ++idx) {
+    float closestDistance = std::min(nearestIntersection.distanceFromRayOrigin, ray.getMaxDistance());
+    float nearDistance, farDistance;
+    if (!shapesBounds[idx].intersectWithRay(ray, nearDistance, farDistance) || nearDistance > closestDistance || farDistance < 0.f) {
+      continue;
+    }
+
+    RayIntersection intersection = intersectShapeOfType<ShapeClass>(bucket[idx], ray);
+    if (!intersection.rayIntersectsWithShape) {
+      continue;
+    }
+
+    if (intersection.distanceFromRayOrigin < closestDistance) {
+      nearestIntersection = intersection;
+      isFound = true;
+      if (isAnyIntersectionEnough) {
+        break;
+      }
+    }
+  }
+
+  return isFound;
+}
+
+template <class ShapeClass>
+void CompiledScene::occludeByBucket(int type, const Ray *rays, const BoundingBox *raysBounds, const BoundingBox &batchBounds, int raysCount,
+                                    unsigned allRaysMask, unsigned &occludedMask, ShadowOccluder *occluders) const {
+  const std::vector<const Shape *> &bucket = mBuckets[type];
+  const std::vector<BoundingBox> &shapesBounds = mShapesBounds[type];
+
+  for (int idx = 0, count = bucket.size(); idx < count; ++idx) {
+    if (!shapesBounds[idx].overlapsWithBox(batchBounds)) {
+      continue;
+    }
+
+    for (int rayIndex = 0; rayIndex < raysCount; ++rayIndex) {
+      unsigned rayBit = 1u << rayIndex;
+      if ((occludedMask & rayBit) || !shapesBounds[idx].overlapsWithBox(raysBounds[rayIndex])) {
+        continue;
+      }
+
+      RayIntersection intersection = intersectShapeOfType<ShapeClass>(bucket[idx], rays[rayIndex]);
+      if (intersection.rayIntersectsWithShape && intersection.distanceFromRayOrigin < rays[rayIndex].getMaxDistance()) {
+        occludedMask |= rayBit;
+        if (occluders != NULL) {
+          occluders[rayIndex] = ShadowOccluder(bucket[idx], ShapeType(type));
+        }
+      }
+    }
+
+    if (occludedMask == allRaysMask) {
+      return;
+    }
+  }
+}
@@ -0,0 +1,65 @@
+/*!
+ *\file compiledscene.h
+ *\brief Contains CompiledScene class declaration
+ */
+
+#pragma once
+
+#include <QSharedPointer>
+#include <vector>
+
+#include "shape.h"
+#include "shapedispatch.h"
+#include "shadowoccludercache.h"
+#include "boundingbox.h"
+
+class CompiledScene;
+
+typedef QSharedPointer<CompiledScene> CompiledScenePointer;
+
+// Maximal number of shadow rays traced together, visibility of each ray is a bit of unsigned mask
+#define SHADOW_RAYS_BATCH_SIZE 32
+
+/*!
+ * Scene shapes representation used for tracing.
+ * Shapes are bucketed by their concrete type, each bucket is intersected by a loop 
+ * instantiated for that type, so no virtual call is made per shape.
+ * Scene shapes remain the authoring API, compiled scene is built from them once after loading.
+ * Shadow ray batches are culled by bounds of the segments they span: a bucket or a shape whose bounds 
+ * do not overlap the batch is skipped for all rays of the batch at once.
+ */
+class CompiledScene {
+  public:
+    CompiledScene(const std::vector<ShapePointer> &shapes);
+    virtual ~CompiledScene();
+
+    RayIntersection calculateNearestIntersection(const Ray &ray) const;
+    RayIntersection calculateFirstIntersection(const Ray &ray) const;
+    // Traces batch of shadow rays, returns mask of rays not occluded by any shape within their [min, max] distance interval.
+    // If occluders array is not NULL, it receives the shape which occluded each ray
+    unsigned calculateVisibility(const Ray *rays, int raysCount, ShadowOccluder *occluders) const;
+
+  private:
+    template <bool isAnyIntersectionEnough>
+    RayIntersection intersectBuckets(const Ray &ray) const;
+
+    // Updates nearest intersection if a closer shape of the bucket is hit within ray max distance.
+    // Shapes whose bounds the ray enters beyond the nearest intersection found so far are not intersected
+    template <class ShapeClass, bool isAnyIntersectionEnough>
+    bool intersectBucket(int type, const Ray &ray, RayIntersection &nearestIntersection) const;
+
+    // Marks rays occluded by shapes of the bucket, shapes are the outer loop so that each shape is fetched once per batch.
+    // Shapes not overlapping bounds of the batch segments are skipped, rays are skipped for shapes not overlapping their segment bounds
+    template <class ShapeClass>
+    void occludeByBucket(int type, const Ray *rays, const BoundingBox *raysBounds, const BoundingBox &batchBounds, int raysCount,
+                         unsigned allRaysMask, unsigned &occludedMask, ShadowOccluder *occluders) const;
+
+  private:
+    // Owns shapes referenced by buckets
+    std::vector<ShapePointer> mShapes;
+    std::vector<const Shape *> mBuckets[SHAPE_TYPES_COUNT];
+    // World space bounds of bucket shapes, unbounded shapes have infinite bounds
+    std::vector<BoundingBox> mShapesBounds[SHAPE_TYPES_COUNT];
+    // Union of bounds of bucket shapes
+    BoundingBox mBucketsBounds[SHAPE_TYPES_COUNT];
+};
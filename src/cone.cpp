@@ -10,141 +10,87 @@ Cone::Cone(Vector top, Vector bottomCenter, float radius, MaterialPointer materi
   : Shape(material),
     mTop(top),
     mBottomCenter(bottomCenter),
-    mRadius(radius) {
+    mRadius(radius),
+    mFrame(top, bottomCenter - top),
+    mHeight((bottomCenter - top).length()),
+    mSquaredRadius(radius * radius) {
+  mRadiusPerHeight = mRadius / mHeight;
+  mSquaredRadiusPerHeight = mRadiusPerHeight * mRadiusPerHeight;
 }
 
 Cone::~Cone() {
 }
 
 RayIntersection Cone::intersectWithRay(const Ray &ray) const {
-  Vector coneAxis	= (mBottomCenter - mTop);
-  coneAxis.normalize();
+  // Transform ray to local frame, where cone axis is Z axis and top is at origin
+  Vector rayOrigin    = mFrame.toLocalPoint(ray.getOriginPosition());
+  Vector rayDirection = mFrame.toLocalDirection(ray.getDirection());
 
-  Vector rayOriginPosition = ray.getOriginPosition();
-  Vector rayDirection = ray.getDirection();
-
-  Vector bottomCenterToRayOrigin = rayOriginPosition - mTop;
-
-  float rayDirectionDotAxis = rayDirection.dotProduct(coneAxis);
-  float bottomCenterToRayOriginDotAxis = bottomCenterToRayOrigin.dotProduct(coneAxis);
-  float radiansPerHeight = mRadius / (mBottomCenter - mTop).length();
-
-  Vector u = rayDirection + coneAxis * (-rayDirectionDotAxis);
-  Vector v = bottomCenterToRayOrigin + coneAxis * (-bottomCenterToRayOriginDotAxis);
-  float  w = bottomCenterToRayOriginDotAxis * radiansPerHeight;
-
-  float	radiansPerDirection = rayDirectionDotAxis * radiansPerHeight;
+  std::vector<float> intersectionDistances;
 
+  // Find intersections with side surface x^2 + y^2 = (k * z)^2, solve square equation a * x^2 + b * x + c = 0
+  float a = rayDirection.x * rayDirection.x + rayDirection.y * rayDirection.y - mSquaredRadiusPerHeight * rayDirection.z * rayDirection.z;
+  float b = 2 * (rayOrigin.x * rayDirection.x + rayOrigin.y * rayDirection.y - mSquaredRadiusPerHeight * rayOrigin.z * rayDirection.z);
+  float c = rayOrigin.x * rayOrigin.x + rayOrigin.y * rayOrigin.y - mSquaredRadiusPerHeight * rayOrigin.z * rayOrigin.z;
 
-  // Solve square equation a * x^2 + b * x + c = 0
-  float a = u.dotProduct(u) - radiansPerDirection * radiansPerDirection;
-  float closestRoot = -1.f;
-  float rayExit = -1.f;
-  float root		= 0.f;
-  std::vector<float> intersectionDistances;
-  
   if (fabs(a) > FLOAT_ZERO) {
-    float b = 2 * (u.dotProduct(v) - w * radiansPerDirection);
-    float c = v.dotProduct(v) - w * w;
     float discriminant = b * b - 4 * a * c;
-
-    if (discriminant < 0.0) {
-      return RayIntersection();
-    }
-
-    discriminant = sqrtf(discriminant);
-    float denominator = 1.0 / (2.0 * a);
-
-    root = (-b - discriminant) * denominator;
-    if (root > 0.0) {
-      Vector point = ray.getPointAt(root);
-      Vector bottomCenterToPoint = point - mTop;
-      Vector topToPoint = point - mBottomCenter;
-      if (coneAxis.dotProduct(bottomCenterToPoint) > 0.0 && (-coneAxis).dotProduct(topToPoint) > 0.0) {
-        intersectionDistances.push_back(root);
-        closestRoot = root;
-      }
-    }
-    
-    root = (-b + discriminant) * denominator;
-    if (root > 0.0) {
-      Vector point = ray.getPointAt(root);
-      Vector bottomCenterToPoint = point - mTop;
-      Vector topToPoint = point - mBottomCenter;
-      if (coneAxis.dotProduct(bottomCenterToPoint) > 0.0 && (-coneAxis).dotProduct(topToPoint) > 0.0) {
-        intersectionDistances.push_back(root);
-        if (closestRoot < 0.0) {
-          closestRoot = root;
-        } else if (root < closestRoot) {
-          rayExit = closestRoot;
-          closestRoot = root;
-        } else {
-          rayExit = root;
+    if (discriminant >= 0.f) {
+      discriminant = sqrtf(discriminant);
+      float denominator = 1.f / (2.f * a);
+
+      float roots[2] = {(-b - discriminant) * denominator, (-b + discriminant) * denominator};
+      for (int idx = 0; idx < 2; ++idx) {
+        float height = rayOrigin.z + rayDirection.z * roots[idx];
+        if (roots[idx] > 0.f && height > 0.f && height < mHeight) {
+          intersectionDistances.push_back(roots[idx]);
         }
       }
     }
-  }
-
-  // Intersection with bottom
-  if (fabs(rayDirectionDotAxis) < FLOAT_ZERO) {
-    if (closestRoot > 0.0) {
-      if (rayExit < 0.f) {
-        intersectionDistances.insert(intersectionDistances.begin(), 0.f);
-      }
-      ConePointer pointer = ConePointer(new Cone(*this));
-      return RayIntersection(true, pointer, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
+  } else if (fabs(b) > FLOAT_ZERO) {
+    // Ray is parallel to cone generatrix, so it crosses side surface only once
+    float root = -c / b;
+    float height = rayOrigin.z + rayDirection.z * root;
+    if (root > 0.f && height > 0.f && height < mHeight) {
+      intersectionDistances.push_back(root);
     }
-
-    return RayIntersection();
   }
 
-  // Intersection with top and bottom points
-  root = (-coneAxis).dotProduct(rayOriginPosition - mBottomCenter) / rayDirectionDotAxis;
-  if (root > 0.0)
-  {
-    Vector topToPoint = ray.getPointAt(root) - mBottomCenter;
-    if (topToPoint.dotProduct(topToPoint) < mRadius * mRadius)
-    {
-      intersectionDistances.push_back(root);
-      if (closestRoot < 0.0) {
-        closestRoot = root;
-        rayExit = root;
-      } else if (root < closestRoot) {
-        rayExit = closestRoot;
-        closestRoot = root;
-      } else {
-        rayExit = root;
+  // Find intersection with bottom
+  if (fabs(rayDirection.z) > FLOAT_ZERO) {
+    float root = (mHeight - rayOrigin.z) / rayDirection.z;
+    if (root > 0.f) {
+      float x = rayOrigin.x + rayDirection.x * root;
+      float y = rayOrigin.y + rayDirection.y * root;
+      if (x * x + y * y < mSquaredRadius) {
+        intersectionDistances.push_back(root);
       }
     }
   }
 
-  if (closestRoot > 0.0) {
-    if (rayExit < 0.0) {
-      intersectionDistances.insert(intersectionDistances.begin(), 0.f);
-    }
-    ConePointer pointer = ConePointer(new Cone(*this));
-    return RayIntersection(true, pointer, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
+  if (intersectionDistances.empty()) {
+    return RayIntersection();
   }
 
-  return RayIntersection();  
+  float closestRoot = *std::min_element(intersectionDistances.begin(), intersectionDistances.end());
+  // Ray origin is inside cone
+  if (intersectionDistances.size() == 1) {
+    intersectionDistances.insert(intersectionDistances.begin(), 0.f);
+  }
+  return RayIntersection(true, this, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
 }
 
 Vector Cone::getNormal(const Ray &ray, float distance) const {
-  Vector coneAxis	= (mBottomCenter - mTop);
-  coneAxis.normalize();
-  Vector point = ray.getPointAt(distance);
+  Vector point = mFrame.toLocalPoint(ray.getPointAt(distance));
+  float distanceToAxis = sqrtf(point.x * point.x + point.y * point.y);
 
   // If point is lying at bottom
-  Vector pointPositionRelativelyToBottom	= point - mBottomCenter;
-  if (fabs(coneAxis.dotProduct(pointPositionRelativelyToBottom)) < FLOAT_ZERO && 
-      pointPositionRelativelyToBottom.dotProduct(pointPositionRelativelyToBottom) < mRadius * mRadius) {
-    return coneAxis;
+  if (fabs(point.z - mHeight) < fabs(distanceToAxis - mRadiusPerHeight * point.z)) {
+    return mFrame.getZAxis();
   }
 
   // Otherwise, if point is lying at side surface
-  Vector approximatedNormal = point - (coneAxis * (point - mBottomCenter).dotProduct(coneAxis) + mBottomCenter);
-  float radiansPerHeight = mRadius / (mBottomCenter - mTop).length();
-  Vector normal = approximatedNormal + coneAxis * (-radiansPerHeight * approximatedNormal.length());
+  Vector normal = mFrame.toWorldDirection(Vector(point.x, point.y, -mRadiusPerHeight * distanceToAxis));
   normal.normalize();
   return normal;
-}
\ No newline at end of file
+}
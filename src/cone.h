@@ -7,6 +7,7 @@
 
 #include "shape.h"
 #include "types.h"
+#include "coordinateframe.h"
 
 class Cone;
 
@@ -20,8 +21,21 @@ class Cone : public Shape {
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const Vector &getTop() const { return mTop; }
+    const Vector &getBottomCenter() const { return mBottomCenter; }
+    float getRadius() const { return mRadius; }
+
   private:
     Vector mTop;
     Vector mBottomCenter;
     float mRadius;
+
+    // Invariants calculated at construction
+    // Local frame with origin at top and Z axis directed to bottom center
+    CoordinateFrame mFrame;
+    float mHeight;
+    float mSquaredRadius;
+    // Cone slope (radius change per height unit) and its square
+    float mRadiusPerHeight;
+    float mSquaredRadiusPerHeight;
 };
\ No newline at end of file
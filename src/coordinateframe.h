@@ -0,0 +1,54 @@
+/*!
+ *\file coordinateframe.h
+ *\brief Contains CoordinateFrame class declaration and definition
+ */
+
+#pragma once
+
+#include "types.h"
+
+/*!
+ * Orthonormal local coordinate system of a shape.
+ * Shapes with an axis (cylinder, cone, torus) transform rays into this frame
+ * so that intersection is calculated against the canonical shape lying along Z axis.
+ * Since the frame is orthonormal, distances along transformed rays are preserved.
+ */
+class CoordinateFrame {
+  public:
+    CoordinateFrame()
+      : mXAxis(1.f, 0.f, 0.f),
+        mYAxis(0.f, 1.f, 0.f),
+        mZAxis(0.f, 0.f, 1.f) {}
+
+    CoordinateFrame(const Vector &origin, const Vector &zAxis)
+      : mOrigin(origin),
+        mZAxis(zAxis) {
+      mZAxis.normalize();
+      // Take world axis which is the least collinear with Z axis to build X axis
+      Vector helper = fabs(mZAxis.x) < 0.9f ? Vector(1.f, 0.f, 0.f) : Vector(0.f, 1.f, 0.f);
+      mXAxis = helper.crossProduct(mZAxis);
+      mXAxis.normalize();
+      mYAxis = mZAxis.crossProduct(mXAxis);
+    }
+
+    Vector toLocalPoint(const Vector &point) const {
+      return toLocalDirection(point - mOrigin);
+    }
+
+    Vector toLocalDirection(const Vector &direction) const {
+      return Vector(direction.dotProduct(mXAxis), direction.dotProduct(mYAxis), direction.dotProduct(mZAxis));
+    }
+
+    Vector toWorldDirection(const Vector &direction) const {
+      return mXAxis * direction.x + mYAxis * direction.y + mZAxis * direction.z;
+    }
+
+    const Vector &getOrigin() const { return mOrigin; }
+    const Vector &getZAxis() const { return mZAxis; }
+
+  private:
+    Vector mOrigin;
+    Vector mXAxis;
+    Vector mYAxis;
+    Vector mZAxis;
+};
@@ -3,14 +3,15 @@
 
 CSGShapeNode::CSGShapeNode(ShapePointer shape) 
   : CSGNode(shape->getMaterial()),
-    mShape(shape) {
+    mShape(shape),
+    mShapeType(getShapeType(shape.data())) {
 }
 
 CSGShapeNode::~CSGShapeNode() {
 }
 
 RayIntersection CSGShapeNode::intersectWithRay(const Ray &ray) const {
-  return mShape->intersectWithRay(ray);
+  return intersectShape(mShapeType, mShape.data(), ray);
 }
 
 Vector CSGShapeNode::getNormal(const Ray &ray, float distance) const {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "csgnode.h"
+#include "shapedispatch.h"
 
 class CSGShapeNode;
 
@@ -16,4 +17,5 @@ public:
 
 private:
   ShapePointer mShape;
+  ShapeType mShapeType;
 };
\ No newline at end of file
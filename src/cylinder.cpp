@@ -10,164 +10,90 @@ Cylinder::Cylinder(Vector topCenter, Vector bottomCenter, float radius, Material
   : Shape(material),
     mTopCenter(topCenter),
     mBottomCenter(bottomCenter),
-    mRadius(radius) {
+    mRadius(radius),
+    mFrame(bottomCenter, topCenter - bottomCenter),
+    mHeight((topCenter - bottomCenter).length()),
+    mSquaredRadius(radius * radius) {
 }
 
 Cylinder::~Cylinder() {
 }
 
 RayIntersection Cylinder::intersectWithRay(const Ray &ray) const {
-  Vector cylinderAxis = mTopCenter - mBottomCenter;
-  cylinderAxis.normalize();
+  // Transform ray to local frame, where cylinder axis is Z axis and bottom center is at origin
+  Vector rayOrigin    = mFrame.toLocalPoint(ray.getOriginPosition());
+  Vector rayDirection = mFrame.toLocalDirection(ray.getDirection());
 
-  Vector rayOrigin    = ray.getOriginPosition();
-  Vector rayDirection = ray.getDirection();
-
-  Vector bottomCenterToRayOrigin = rayOrigin - mBottomCenter;
-
-  Vector u = rayDirection - cylinderAxis * rayDirection.dotProduct(cylinderAxis);
-  Vector v = bottomCenterToRayOrigin - cylinderAxis * bottomCenterToRayOrigin.dotProduct(cylinderAxis);
-
-  // Solve square equation a * x^2 + b * x + c = 0
-  float a = u.dotProduct(u);
-  float root		= 0.0;
-  float closestRoot = -1.0;
-  float rayExit = -1.f;
   std::vector<float> intersectionDistances;
 
-  if (fabs(a) > FLOAT_ZERO) {
-    const float b = 2 * u.dotProduct(v);
-    const float c = v.dotProduct(v) - mRadius * mRadius;
+  // Find intersections with side surface, solve square equation a * x^2 + b * x + c = 0
+  float a = rayDirection.x * rayDirection.x + rayDirection.y * rayDirection.y;
+  if (a > FLOAT_ZERO) {
+    float b = 2 * (rayOrigin.x * rayDirection.x + rayOrigin.y * rayDirection.y);
+    float c = rayOrigin.x * rayOrigin.x + rayOrigin.y * rayOrigin.y - mSquaredRadius;
 
     float descriminant = b * b - 4 * a * c;
-
-    if (descriminant < 0.0) {
+    if (descriminant < 0.f) {
       return RayIntersection();
     }
 
     descriminant = sqrtf(descriminant);
+    float denominator = 1.f / (2.f * a);
 
-    // Calculate roots and take closest
-    float denominator = 1.0 / (2.0 * a);
-
-    root = (-b - descriminant) * denominator;
-    if (root >= 0.0) {
-      Vector point = ray.getPointAt(root);    
-      Vector pointRelativelyToBottomCenter = point - mBottomCenter;
-      Vector pointRelativelyToTopCenter		= point - mTopCenter;
-      if (cylinderAxis.dotProduct(pointRelativelyToBottomCenter) > 0.0 && 
-          cylinderAxis.dotProduct(pointRelativelyToTopCenter) < 0.0) {
-        intersectionDistances.push_back(root);
-        closestRoot = root;
-      }
-    }
-    
-    root = (-b + descriminant) * denominator;
-    if (root > 0.0) {
-      Vector point = ray.getPointAt(root);    
-      Vector pointRelativelyToBottomCenter = point - mBottomCenter;
-      Vector pointRelativelyToTopCenter		= point - mTopCenter;
-      if (cylinderAxis.dotProduct(pointRelativelyToBottomCenter) > 0.0 && 
-          cylinderAxis.dotProduct(pointRelativelyToTopCenter) < 0.0) {
-        intersectionDistances.push_back(root);
-        if (closestRoot < 0.0) {
-          root = closestRoot;
-        } else if (root < closestRoot) {
-          rayExit = closestRoot;
-          closestRoot = root;
-        } else {
-          rayExit = root;
-        }
-      }
-    }
-  }
-
-  // Find intersection with bottom
-  float cyliderAxisDotDirection = cylinderAxis.dotProduct(rayDirection);
-  if (fabs(cyliderAxisDotDirection) < FLOAT_ZERO) {
-    if (closestRoot > 0.f) {
-      if (rayExit < 0.f) {
-        intersectionDistances.insert(intersectionDistances.begin(), 0.f);
+    float roots[2] = {(-b - descriminant) * denominator, (-b + descriminant) * denominator};
+    for (int idx = 0; idx < 2; ++idx) {
+      float height = rayOrigin.z + rayDirection.z * roots[idx];
+      if (roots[idx] > 0.f && height > 0.f && height < mHeight) {
+        intersectionDistances.push_back(roots[idx]);
       }
-      CylinderPointer pointer = CylinderPointer(new Cylinder(*this));
-      return RayIntersection(true, pointer, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
     }
-
-    return RayIntersection();
   }
 
-  float cylinderAxisDotRayOrigin = cylinderAxis.dotProduct(rayOrigin);
-  float bottomCenterToRayOriginDotCylinderAxis = bottomCenterToRayOrigin.dotProduct(cylinderAxis);
-  root = -bottomCenterToRayOriginDotCylinderAxis / cyliderAxisDotDirection;
-  if (root > 0.0) {
-    Vector point = ray.getPointAt(root);    
-    Vector pointRelativelyToBottomCenter = point - mBottomCenter;
-    if (pointRelativelyToBottomCenter.dotProduct(pointRelativelyToBottomCenter) < mRadius * mRadius) {
-      intersectionDistances.push_back(root);
-      if (closestRoot < 0.0) {
-        closestRoot = root;
-      } else if (root < closestRoot) {
-        rayExit = closestRoot;
-        closestRoot = root;
-      } else {
-        rayExit = root;
+  // Find intersections with bottom and top
+  if (fabs(rayDirection.z) > FLOAT_ZERO) {
+    float invertedDirectionZ = 1.f / rayDirection.z;
+    float capHeights[2] = {0.f, mHeight};
+    for (int idx = 0; idx < 2; ++idx) {
+      float root = (capHeights[idx] - rayOrigin.z) * invertedDirectionZ;
+      if (root > 0.f) {
+        float x = rayOrigin.x + rayDirection.x * root;
+        float y = rayOrigin.y + rayDirection.y * root;
+        if (x * x + y * y < mSquaredRadius) {
+          intersectionDistances.push_back(root);
+        }
       }
     }
   }
 
-  // Find intersection with top
-  Vector topCenterToRayOrigin = rayOrigin - mTopCenter;
-  float topCenterToRayOriginDotAxis = topCenterToRayOrigin.dotProduct(-cylinderAxis);
-  root = topCenterToRayOriginDotAxis / cyliderAxisDotDirection;
-  if (root > 0.0) {
-    Vector point = ray.getPointAt(root);    
-    Vector pointRelativelyToTopCenter = point - mTopCenter;
-    if (pointRelativelyToTopCenter.dotProduct(pointRelativelyToTopCenter) < mRadius * mRadius) {
-      intersectionDistances.push_back(root);
-      if (closestRoot < 0.0) {
-        closestRoot = root;
-      } else if (root < closestRoot) {
-        rayExit = closestRoot;
-        closestRoot = root;
-      } else {
-        rayExit = root;
-      }
-    }
+  if (intersectionDistances.empty()) {
+    return RayIntersection();
   }
 
-  if (closestRoot >= 0.0) {
-    if (rayExit < 0.f) {
-      intersectionDistances.insert(intersectionDistances.begin(), 0.f);
-    }
-    CylinderPointer pointer = CylinderPointer(new Cylinder(*this));
-    return RayIntersection(true, pointer, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
+  float closestRoot = *std::min_element(intersectionDistances.begin(), intersectionDistances.end());
+  // Ray origin is inside cylinder
+  if (intersectionDistances.size() == 1) {
+    intersectionDistances.insert(intersectionDistances.begin(), 0.f);
   }
-  
-  return RayIntersection();
+  return RayIntersection(true, this, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
 }
 
 Vector Cylinder::getNormal(const Ray &ray, float distance) const {
-  Vector intersectionPoint = ray.getPointAt(distance);
-  Vector cylinderAxis = mTopCenter - mBottomCenter;
-  cylinderAxis.normalize();
-  float squaredRadius = mRadius * mRadius;
-
-  // Check if intersection point is at cylinder top surface
-  Vector intersectionPointRelativelyToTopCenter = intersectionPoint - mTopCenter;
-  if (cylinderAxis.dotProduct(intersectionPointRelativelyToTopCenter) < FLOAT_ZERO &&
-      intersectionPointRelativelyToTopCenter.dotProduct(intersectionPointRelativelyToTopCenter) < squaredRadius) {
-    return cylinderAxis;
-  }
+  Vector point = mFrame.toLocalPoint(ray.getPointAt(distance));
+  float distanceToAxis = sqrtf(point.x * point.x + point.y * point.y);
+
+  // Choose the surface which is the closest to intersection point
+  float distanceToSide   = fabs(distanceToAxis - mRadius);
+  float distanceToTop    = fabs(point.z - mHeight);
+  float distanceToBottom = fabs(point.z);
 
-  // Check if intersection point is at cylinder bottom surface
-  Vector intersectionPointRelativelyToBottomCenter = intersectionPoint - mBottomCenter;
-  if (cylinderAxis.dotProduct(intersectionPointRelativelyToBottomCenter) < FLOAT_ZERO &&
-      intersectionPointRelativelyToBottomCenter.dotProduct(intersectionPointRelativelyToBottomCenter) < squaredRadius) {
-    return -cylinderAxis;
+  if (distanceToTop < distanceToSide && distanceToTop < distanceToBottom) {
+    return mFrame.getZAxis();
+  }
+  if (distanceToBottom < distanceToSide) {
+    return -mFrame.getZAxis();
   }
 
-  // Otherwise, if intersection point is at cylinder side surface
-  Vector normal = intersectionPoint - cylinderAxis * intersectionPointRelativelyToBottomCenter.dotProduct(cylinderAxis) - mBottomCenter;
+  Vector normal = mFrame.toWorldDirection(Vector(point.x, point.y, 0.f));
   normal.normalize();
   return normal;
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 
 #include "shape.h"
 #include "types.h"
+#include "coordinateframe.h"
 
 class Cylinder;
 
@@ -20,8 +21,18 @@ class Cylinder : public Shape {
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const Vector &getTopCenter() const { return mTopCenter; }
+    const Vector &getBottomCenter() const { return mBottomCenter; }
+    float getRadius() const { return mRadius; }
+
   private:
     Vector mBottomCenter;
     Vector mTopCenter;
     float mRadius;
+
+    // Invariants calculated at construction
+    // Local frame with origin at bottom center and Z axis directed to top center
+    CoordinateFrame mFrame;
+    float mHeight;
+    float mSquaredRadius;
 };
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "directedlight.h"
 #include "mathcommons.h"
-#include "scene.h"
 
 DirectedLight::DirectedLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, 
                              Vector direction) 
@@ -11,41 +10,42 @@ DirectedLight::DirectedLight(Color ambientIntensity, Color diffuseIntensity, Col
 DirectedLight::~DirectedLight() {
 }
 
-Color DirectedLight::calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const {
-  Vector point = ray.getPointAt(distance);
+bool DirectedLight::calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const {
+  Vector lightVector = -mDirection;
+  // If the point is not illuminated
+  if (lightVector.dotProduct(normal) <= 0.0) {
+    return false;
+  }
 
-  Color ambientComponent;
-  Color diffuseComponent;
-  Color specularComponent;
+  shadowRay = Ray(ray.getPointAt(distance) + lightVector * EPS_FOR_SHADOW_RAYS, lightVector);
+  return true;
+}
+
+LightIrradiance DirectedLight::calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const {
+  Vector point = ray.getPointAt(distance);
 
-  ambientComponent = componentwiseProduct(material->ambientColor, mAmbientIntensity);
+  LightIrradiance irradiance;
+  irradiance.ambient = mAmbientIntensity;
 
   Vector lightVector = -mDirection;
   const float	lightVectorDotNormal	= lightVector.dotProduct(normal);  
   // If the point is not illuminated
   if (lightVectorDotNormal <= 0.0) {
-    return ambientComponent;
+    return irradiance;
   }
 
-  Ray shadowRay(point + lightVector * EPS_FOR_SHADOW_RAYS, lightVector);	
-  RayIntersection shadowRayIntersection = scene.calculateFirstIntersection(shadowRay);
-  // If object is not in shadow
-  if (!shadowRayIntersection.rayIntersectsWithShape) {
-    Color diffuseColor = material->diffuseColor;
-    diffuseComponent = componentwiseProduct(diffuseColor, mDiffuseIntensity * lightVectorDotNormal);
+  irradiance.diffuse = mDiffuseIntensity * lightVectorDotNormal;
 
-    Vector lightReflect = mDirection - normal * 2 * mDirection.dotProduct(normal);
-    lightReflect.normalize();
+  Vector lightReflect = mDirection - normal * 2 * mDirection.dotProduct(normal);
+  lightReflect.normalize();
 
-    Vector cameraDirection = ray.getOriginPosition() - point;
-    cameraDirection.normalize();
+  Vector cameraDirection = ray.getOriginPosition() - point;
+  cameraDirection.normalize();
 
-    float	cameraDirectionDotLightReflect = cameraDirection.dotProduct(lightReflect);
-    if (cameraDirectionDotLightReflect > 0.0) {
-      const Color specularColor = material->specularColor; 
-      specularComponent	= componentwiseProduct(specularColor, mSpecularIntensity * powf(cameraDirectionDotLightReflect, material->specularPower));
-    }				
-  }
+  float	cameraDirectionDotLightReflect = cameraDirection.dotProduct(lightReflect);
+  if (cameraDirectionDotLightReflect > 0.0) {
+    irradiance.specular = mSpecularIntensity * powf(cameraDirectionDotLightReflect, specularPower);
+  }				
   
-  return ambientComponent + diffuseComponent + specularComponent;
+  return irradiance;
 }
\ No newline at end of file
@@ -11,7 +11,8 @@ class DirectedLight : public LightSource {
     DirectedLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, Vector direction);
     virtual ~DirectedLight();
 
-    virtual Color calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const;
+    virtual bool calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const;
+    virtual LightIrradiance calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const;
 
   private:
     // Light direction
@@ -0,0 +1,123 @@
+/*!
+ *\file floatquarticequation.cpp
+ *\brief Contains FloatQuarticEquation class definition
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "floatquarticequation.h"
+
+#define QUARTIC_MAX_ITERATIONS 32
+// Relative tolerances of quartic roots and roots of its derivatives,
+// the latter only bound monotonic intervals, so they are not polished as precisely
+#define QUARTIC_ROOT_TOLERANCE 1e-5f
+#define DERIVATIVE_ROOT_TOLERANCE 1e-2f
+
+FloatQuarticEquation::FloatQuarticEquation(float b, float c, float d, float e)
+  : mB(b),
+    mC(c),
+    mD(d),
+    mE(e) {
+}
+
+int FloatQuarticEquation::solve(float minRoot, float maxRoot, float *roots) const {
+  if (!(minRoot < maxRoot)) {
+    return 0;
+  }
+  return findRoots(0, minRoot, maxRoot, roots);
+}
+
+float FloatQuarticEquation::evaluate(int order, float x) const {
+  switch (order) {
+    case 0:
+      return (((x + mB) * x + mC) * x + mD) * x + mE;
+    case 1:
+      return ((4.f * x + 3.f * mB) * x + 2.f * mC) * x + mD;
+    case 2:
+      return (12.f * x + 6.f * mB) * x + 2.f * mC;
+    default:
+      return 24.f * x + 6.f * mB;
+  }
+}
+
+int FloatQuarticEquation::findRoots(int order, float minRoot, float maxRoot, float *roots) const {
+  // Second derivative is quadratic 12 * x^2 + 6 * b * x + 2 * c, its roots are found in closed form
+  if (order == 2) {
+    float descriminant = 9.f * mB * mB - 24.f * mC;
+    if (descriminant <= 0.f) {
+      return 0;
+    }
+    descriminant = sqrtf(descriminant);
+    // Numerically stable pair of roots of the quadratic
+    float q = mB > 0.f ? -3.f * mB - descriminant : -3.f * mB + descriminant;
+    float firstRoot = q / 12.f;
+    float secondRoot = q != 0.f ? 2.f * mC / q : firstRoot;
+    if (firstRoot > secondRoot) {
+      std::swap(firstRoot, secondRoot);
+    }
+    int rootsCount = 0;
+    if (firstRoot > minRoot && firstRoot < maxRoot) {
+      roots[rootsCount++] = firstRoot;
+    }
+    if (secondRoot > minRoot && secondRoot < maxRoot && secondRoot != firstRoot) {
+      roots[rootsCount++] = secondRoot;
+    }
+    return rootsCount;
+  }
+
+  // Roots of the next derivative split the interval into parts, where the polynomial is monotonic
+  const int maxPointsCount = 6;
+  float points[maxPointsCount];
+  points[0] = minRoot;
+  int pointsCount = 1 + findRoots(order + 1, minRoot, maxRoot, points + 1);
+  points[pointsCount++] = maxRoot;
+
+  int rootsCount = 0;
+  float leftValue = evaluate(order, points[0]);
+  for (int idx = 1; idx < pointsCount; ++idx) {
+    float rightValue = evaluate(order, points[idx]);
+    if ((leftValue < 0.f) != (rightValue < 0.f)) {
+      roots[rootsCount++] = polishRoot(order, points[idx - 1], points[idx], leftValue, rightValue);
+    }
+    leftValue = rightValue;
+  }
+
+  return rootsCount;
+}
+
+float FloatQuarticEquation::polishRoot(int order, float left, float right, float leftValue, float rightValue) const {
+  bool isLeftNegative = leftValue < 0.f;
+  float relativeTolerance = order == 0 ? QUARTIC_ROOT_TOLERANCE : DERIVATIVE_ROOT_TOLERANCE;
+  // Start from the secant of the bracket
+  float root = left + (right - left) * leftValue / (leftValue - rightValue);
+
+  for (int iteration = 0; iteration < QUARTIC_MAX_ITERATIONS; ++iteration) {
+    float value = evaluate(order, root);
+    if (value == 0.f) {
+      return root;
+    }
+
+    // Keep the bracket around the root
+    if ((value < 0.f) == isLeftNegative) {
+      left = root;
+    } else {
+      right = root;
+    }
+
+    // Newton step, falling back to bisection when it leaves the bracket
+    float derivative = evaluate(order + 1, root);
+    float nextRoot = derivative != 0.f ? root - value / derivative : left;
+    if (!(nextRoot > left && nextRoot < right)) {
+      nextRoot = 0.5f * (left + right);
+    }
+
+    float tolerance = relativeTolerance * (1.f + fabs(nextRoot));
+    if (fabs(nextRoot - root) <= tolerance || right - left <= tolerance) {
+      return nextRoot;
+    }
+    root = nextRoot;
+  }
+
+  return root;
+}
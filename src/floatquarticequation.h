@@ -0,0 +1,37 @@
+/*!
+ *\file floatquarticequation.h
+ *\brief Contains FloatQuarticEquation class declaration
+ */
+
+#pragma once
+
+/*!
+ * Monic quartic equation x^4 + b * x^3 + c * x^2 + d * x + e = 0 solved in single precision.
+ * Unlike QuarticEquation from quarticsolver library it searches only roots lying in the given
+ * finite interval, which is what ray intersection needs: the interval is taken from the shape's
+ * bounding volume. Roots are isolated on intervals where the polynomial is monotonic
+ * (bounded by roots of its derivatives, found the same way) and polished by Newton iterations
+ * safeguarded with bisection, so no precision is lost in a resolvent cubic as in closed form solutions.
+ * Roots of even multiplicity (tangent rays) are not reported.
+ */
+class FloatQuarticEquation {
+  public:
+    FloatQuarticEquation(float b, float c, float d, float e);
+
+    // Writes roots lying in [minRoot, maxRoot] to roots array in ascending order, returns roots count (at most 4)
+    int solve(float minRoot, float maxRoot, float *roots) const;
+
+  private:
+    // Evaluates derivative of the given order, order 0 is the quartic polynomial itself
+    float evaluate(int order, float x) const;
+    // Finds roots of derivative of the given order in [minRoot, maxRoot] in ascending order
+    int findRoots(int order, float minRoot, float maxRoot, float *roots) const;
+    // Finds root of derivative of the given order on [left, right], where it is monotonic and changes sign
+    float polishRoot(int order, float left, float right, float leftValue, float rightValue) const;
+
+  private:
+    float mB;
+    float mC;
+    float mD;
+    float mE;
+};
@@ -10,8 +10,18 @@
 InputParametersParser::InputParametersParser() 
   : mSceneArgumentRegex("--scene=(\\S+)"),
     mOutputArgumentRegex("--output=(\\S+)"),
+    mCompileSceneArgumentRegex("--compile_scene=(\\S+)"),
+    mBuildMeshPagesArgumentRegex("--build_mesh_pages=(\\S+)"),
     mXResolutionArgumentRegex("--resolution_x=(\\d+)"),
-    mYResolutionArgumentRegex("--resolution_y=(\\d+)") {
+    mYResolutionArgumentRegex("--resolution_y=(\\d+)"),
+    mBandHeightArgumentRegex("--band_height=(\\d+)"),
+    mLowerQuadricsArgumentRegex("--lower_quadrics"),
+    mReorderMeshesArgumentRegex("--reorder_meshes"),
+    mLazyMeshesArgumentRegex("--lazy_meshes"),
+    mMemoryBudgetArgumentRegex("--memory_budget=(\\d+)"),
+    mLightSamplesArgumentRegex("--light_samples=(\\d+)"),
+    mSamplesPerPixelArgumentRegex("--samples_per_pixel=(\\d+)"),
+    mIrradianceCacheArgumentRegex("--irradiance_cache=(\\d+\\.?\\d*)") {
 }
 
 InputParametersParser::~InputParametersParser() {
@@ -19,6 +29,14 @@ InputParametersParser::~InputParametersParser() {
 
 InputParametersPointer InputParametersParser::parseInputParameters(QStringList args) const {
   InputParametersPointer inputParameters = InputParametersPointer(new InputParameters());
+  inputParameters->bandHeight = 0;
+  inputParameters->isQuadricLoweringEnabled = false;
+  inputParameters->isMeshReorderingEnabled = false;
+  inputParameters->isLazyMeshLoadingEnabled = false;
+  inputParameters->meshMemoryBudget = 0;
+  inputParameters->lightSamplesCount = 0;
+  inputParameters->samplesPerPixel = 1;
+  inputParameters->irradianceCacheSpacing = 0.f;
   bool isSceneParameterInitialized = false;
   bool isOutputParameterInitialized = false;
   bool isXResolutionParameterInitialized = false;
@@ -39,6 +57,10 @@ InputParametersPointer InputParametersParser::parseInputParameters(QStringList a
       }
       inputParameters->outputFilePath = mOutputArgumentRegex.cap(1);
       isOutputParameterInitialized = true;
+    } else if (mCompileSceneArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->snapshotFilePath = mCompileSceneArgumentRegex.cap(1);
+    } else if (mBuildMeshPagesArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->meshPagesModelFilePath = mBuildMeshPagesArgumentRegex.cap(1);
     } else if (mXResolutionArgumentRegex.indexIn(args.at(i)) != -1 ) {   
       if (isXResolutionParameterInitialized) {
         std::cerr << "Input arguments parse error: 'resolution_x' argument occurred twice" << std::endl;
@@ -53,16 +75,52 @@ InputParametersPointer InputParametersParser::parseInputParameters(QStringList a
       }
       inputParameters->yResolution = mYResolutionArgumentRegex.cap(1).toInt();
       isYResolutionParameterInitialized = true;
+    } else if (mBandHeightArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->bandHeight = mBandHeightArgumentRegex.cap(1).toInt();
+      if (inputParameters->bandHeight == 0) {
+        std::cerr << "Input arguments parse error: 'band_height' argument should be positive" << std::endl;
+        return InputParametersPointer(NULL);
+      }
+    } else if (mLowerQuadricsArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->isQuadricLoweringEnabled = true;
+    } else if (mReorderMeshesArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->isMeshReorderingEnabled = true;
+    } else if (mLazyMeshesArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->isLazyMeshLoadingEnabled = true;
+    } else if (mMemoryBudgetArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->meshMemoryBudget = mMemoryBudgetArgumentRegex.cap(1).toInt();
+      if (inputParameters->meshMemoryBudget == 0) {
+        std::cerr << "Input arguments parse error: 'memory_budget' argument should be positive" << std::endl;
+        return InputParametersPointer(NULL);
+      }
+    } else if (mLightSamplesArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->lightSamplesCount = mLightSamplesArgumentRegex.cap(1).toInt();
+    } else if (mSamplesPerPixelArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->samplesPerPixel = mSamplesPerPixelArgumentRegex.cap(1).toInt();
+      if (inputParameters->samplesPerPixel == 0) {
+        std::cerr << "Input arguments parse error: 'samples_per_pixel' argument should be positive" << std::endl;
+        return InputParametersPointer(NULL);
+      }
+    } else if (mIrradianceCacheArgumentRegex.exactMatch(args.at(i))) {
+      inputParameters->irradianceCacheSpacing = mIrradianceCacheArgumentRegex.cap(1).toFloat();
     } else {
       std::cerr << "Input arguments parse error: unknown argument " << args.at(i).toUtf8().constData() << std::endl;
       return InputParametersPointer(NULL);
     }
   }
 
+  if (!inputParameters->meshPagesModelFilePath.isEmpty()) {
+    // Only mesh page file is built, scene is not loaded
+    return inputParameters;
+  }
   if (!isSceneParameterInitialized) {
     std::cerr << "Input arguments parse error: 'scene' argument is not specified" << std::endl;
     return InputParametersPointer(NULL);
   } 
+  if (!inputParameters->snapshotFilePath.isEmpty()) {
+    // Scene is only compiled, image parameters are not needed
+    return inputParameters;
+  }
   if (!isOutputParameterInitialized) {
     std::cerr << "Input arguments parse error: 'output' argument is not specified" << std::endl;
     return InputParametersPointer(NULL);
@@ -75,6 +133,11 @@ InputParametersPointer InputParametersParser::parseInputParameters(QStringList a
     std::cerr << "Input arguments parse error: 'resolution_y' argument is not specified" << std::endl;
     return InputParametersPointer(NULL);
   }
+  if (inputParameters->bandHeight > 0 && !inputParameters->outputFilePath.endsWith(".ppm", Qt::CaseInsensitive) && 
+      !inputParameters->outputFilePath.endsWith(".pfm", Qt::CaseInsensitive) && inputParameters->outputFilePath != "-") {
+    std::cerr << "Input arguments parse error: image rendered in bands is written in PPM or PFM format, 'output' should have .ppm or .pfm extension or be '-'" << std::endl;
+    return InputParametersPointer(NULL);
+  }
 
   return inputParameters;
 }
\ No newline at end of file
@@ -16,8 +16,28 @@ typedef QSharedPointer<InputParameters> InputParametersPointer;
 
 struct InputParameters {
   QString sceneFilePath;
+  // Image is written to standard output in PPM format if the path is "-"
   QString outputFilePath;
+  // Binary snapshot of loaded scene is written to this path instead of rendering, empty if scene is rendered
+  QString snapshotFilePath;
+  // OBJ file which is split into mesh page file instead of rendering, empty if scene is rendered
+  QString meshPagesModelFilePath;
   int xResolution, yResolution;
+  // Height of bands in which image is rendered and streamed to PPM or PFM output, zero means that the whole image is kept in memory
+  int bandHeight;
+  // Lower spheres, cylinders and cones to general quadrics
+  bool isQuadricLoweringEnabled;
+  // Reorder mesh triangles and vertices for memory locality
+  bool isMeshReorderingEnabled;
+  // Defer reading of mesh models with given bounding box until a ray hits them
+  bool isLazyMeshLoadingEnabled;
+  // Memory budget of resident mesh pages in megabytes, zero means that meshes are kept in memory entirely
+  int meshMemoryBudget;
+  // Number of light sources sampled per shading point, zero means that all light sources are evaluated
+  int lightSamplesCount;
+  int samplesPerPixel;
+  // Spacing of irradiance cache records, zero disables the cache
+  float irradianceCacheSpacing;
 };
 
 class InputParametersParser {
@@ -30,6 +50,16 @@ class InputParametersParser {
   private:
     QRegExp mSceneArgumentRegex;
     QRegExp mOutputArgumentRegex;
+    QRegExp mCompileSceneArgumentRegex;
+    QRegExp mBuildMeshPagesArgumentRegex;
     QRegExp mXResolutionArgumentRegex;
     QRegExp mYResolutionArgumentRegex;
+    QRegExp mBandHeightArgumentRegex;
+    QRegExp mLowerQuadricsArgumentRegex;
+    QRegExp mReorderMeshesArgumentRegex;
+    QRegExp mLazyMeshesArgumentRegex;
+    QRegExp mMemoryBudgetArgumentRegex;
+    QRegExp mLightSamplesArgumentRegex;
+    QRegExp mSamplesPerPixelArgumentRegex;
+    QRegExp mIrradianceCacheArgumentRegex;
 };
\ No newline at end of file
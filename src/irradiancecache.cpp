@@ -0,0 +1,129 @@
+/*!
+ *\file irradiancecache.cpp
+ *\brief Contains IrradianceCache class definition
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "irradiancecache.h"
+
+IrradianceCache::IrradianceCache()
+  : mSpacing(0.f),
+    mLookupsCount(0),
+    mHitsCount(0) {
+}
+
+IrradianceCache::~IrradianceCache() {
+}
+
+void IrradianceCache::setSpacing(float spacing) {
+  mSpacing = spacing;
+  clear();
+}
+
+bool IrradianceCache::lookup(const Vector &point, const Vector &normal, Color &ambient, Color &diffuse) {
+  ++mLookupsCount;
+  if (mCells.empty()) {
+    return false;
+  }
+
+  const std::vector<int> &cell = mCells[getCellIndex(static_cast<int>(floorf(point.x / mSpacing)), 
+                                                     static_cast<int>(floorf(point.y / mSpacing)), 
+                                                     static_cast<int>(floorf(point.z / mSpacing)))];
+  Color ambientSum;
+  Color diffuseSum;
+  float weightsSum = 0.f;
+  for each (int recordIndex in cell) {
+    const Record &record = mRecords[recordIndex];
+    float error = (point - record.position).length() / mSpacing + sqrtf(std::max(1.f - normal.dotProduct(record.normal), 0.f));
+    if (error >= IRRADIANCE_CACHE_MAX_ERROR) {
+      continue;
+    }
+
+    // Irradiance near the point can not be interpolated
+    if (!record.isCacheable) {
+      return false;
+    }
+
+    float weight = 1.f - error / IRRADIANCE_CACHE_MAX_ERROR;
+    ambientSum += record.ambient * weight;
+    diffuseSum += record.diffuse * weight;
+    weightsSum += weight;
+  }
+
+  if (weightsSum <= 0.f) {
+    return false;
+  }
+
+  ambient = ambientSum * (1.f / weightsSum);
+  diffuse = diffuseSum * (1.f / weightsSum);
+  ++mHitsCount;
+  return true;
+}
+
+void IrradianceCache::insert(const Vector &point, const Vector &normal, const Color &ambient, const Color &diffuse) {
+  Record record;
+  record.position = point;
+  record.normal = normal;
+  record.ambient = ambient;
+  record.diffuse = diffuse;
+  record.isCacheable = true;
+  addRecord(record);
+}
+
+void IrradianceCache::insertUncacheable(const Vector &point, const Vector &normal) {
+  Record record;
+  record.position = point;
+  record.normal = normal;
+  record.isCacheable = false;
+  addRecord(record);
+}
+
+void IrradianceCache::addRecord(const Record &record) {
+  if (isFull()) {
+    return;
+  }
+  if (mCells.empty()) {
+    mCells.resize(IRRADIANCE_CACHE_CELLS_COUNT);
+  }
+
+  const Vector &point = record.position;
+  int recordIndex = mRecords.size();
+  mRecords.push_back(record);
+
+  // Record is referenced by all cells its influence sphere overlaps
+  float radius = mSpacing * IRRADIANCE_CACHE_MAX_ERROR;
+  int minX = static_cast<int>(floorf((point.x - radius) / mSpacing));
+  int minY = static_cast<int>(floorf((point.y - radius) / mSpacing));
+  int minZ = static_cast<int>(floorf((point.z - radius) / mSpacing));
+  int maxX = static_cast<int>(floorf((point.x + radius) / mSpacing));
+  int maxY = static_cast<int>(floorf((point.y + radius) / mSpacing));
+  int maxZ = static_cast<int>(floorf((point.z + radius) / mSpacing));
+  for (int x = minX; x <= maxX; ++x) {
+    for (int y = minY; y <= maxY; ++y) {
+      for (int z = minZ; z <= maxZ; ++z) {
+        std::vector<int> &cell = mCells[getCellIndex(x, y, z)];
+        if (cell.empty() || cell.back() != recordIndex) {
+          cell.push_back(recordIndex);
+        }
+      }
+    }
+  }
+}
+
+float IrradianceCache::getHitRate() const {
+  return mLookupsCount > 0 ? static_cast<float>(mHitsCount) / mLookupsCount : 0.f;
+}
+
+void IrradianceCache::clear() {
+  mRecords.clear();
+  mCells.clear();
+  mLookupsCount = 0;
+  mHitsCount = 0;
+}
+
+int IrradianceCache::getCellIndex(int x, int y, int z) const {
+  unsigned hash = static_cast<unsigned>(x) * 73856093u ^ static_cast<unsigned>(y) * 19349663u ^ static_cast<unsigned>(z) * 83492791u;
+  return hash & (IRRADIANCE_CACHE_CELLS_COUNT - 1);
+}
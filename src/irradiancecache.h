@@ -0,0 +1,72 @@
+/*!
+ *\file irradiancecache.h
+ *\brief Contains IrradianceCache class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "types.h"
+
+// Number of hash grid cells, should be a power of two
+#define IRRADIANCE_CACHE_CELLS_COUNT 65536
+// Records are interpolated while distance in cache spacings plus normal deviation is below this bound
+#define IRRADIANCE_CACHE_MAX_ERROR 0.5f
+// Maximal number of records, a record with its cell references takes about 100 bytes
+#define IRRADIANCE_CACHE_MAX_RECORDS_COUNT 524288
+
+/*!
+ * World space cache of view independent direct irradiance (ambient and diffuse components).
+ * Records are stored in a hash grid and interpolated with weights falling to zero at the error bound,
+ * so irradiance calculated once is reused at nearby points with similar normals, also in subsequent frames of static scene.
+ * Once the records budget is exhausted new records are not inserted, the cache is still used for lookups.
+ * Only deterministic irradiance should be inserted: a random estimation (light sampling, area light penumbra) would be reused
+ * with its noise frozen, so the cache does not combine with light sampling. Points with random estimation are recorded
+ * as uncacheable instead, lookups near them fail rather than interpolate neighbouring records over them.
+ * Cache is not synchronized, each rendering thread should own its own cache.
+ */
+class IrradianceCache {
+  public:
+    IrradianceCache();
+    virtual ~IrradianceCache();
+
+    // Spacing of records in world units, zero spacing disables cache
+    void setSpacing(float spacing);
+    bool isEnabled() const { return mSpacing > 0.f; }
+
+    // Interpolates irradiance from cached records, returns false if there are no records close enough to the point
+    bool lookup(const Vector &point, const Vector &normal, Color &ambient, Color &diffuse);
+    void insert(const Vector &point, const Vector &normal, const Color &ambient, const Color &diffuse);
+    // Makes lookups close to the point fail, irradiance there should be calculated every time
+    void insertUncacheable(const Vector &point, const Vector &normal);
+
+    long long getLookupsCount() const { return mLookupsCount; }
+    long long getHitsCount() const { return mHitsCount; }
+    int getRecordsCount() const { return mRecords.size(); }
+    bool isFull() const { return mRecords.size() >= IRRADIANCE_CACHE_MAX_RECORDS_COUNT; }
+    float getHitRate() const;
+
+    void clear();
+
+  private:
+    struct Record {
+      Vector position;
+      Vector normal;
+      Color ambient;
+      Color diffuse;
+      bool isCacheable;
+    };
+
+    void addRecord(const Record &record);
+    int getCellIndex(int x, int y, int z) const;
+
+  private:
+    float mSpacing;
+    std::vector<Record> mRecords;
+    // Indices of records overlapping each cell, cells colliding in hash share the list
+    std::vector<std::vector<int> > mCells;
+
+    long long mLookupsCount;
+    long long mHitsCount;
+};
@@ -0,0 +1,52 @@
+/*!
+ *\file lazymesh.cpp
+ *\brief Contains LazyMesh class definition
+ */
+
+#include <iostream>
+#include <QMutexLocker>
+
+#include "lazymesh.h"
+#include "objfilereader.h"
+
+LazyMesh::LazyMesh(const QString &fileName, const BoundingBox &boundingBox, bool isMeshReorderingEnabled)
+  : mFileName(fileName),
+    mBoundingBox(boundingBox),
+    mIsMeshReorderingEnabled(isMeshReorderingEnabled) {
+}
+
+const IndexedMesh *LazyMesh::getMesh() const {
+  IndexedMesh *mesh = mReadMesh;
+  if (mesh != NULL) {
+    return mesh;
+  }
+
+  // Double-checked, the mesh is read by the first thread only
+  QMutexLocker locker(&mReadingMutex);
+  mesh = mReadMesh;
+  if (mesh == NULL) {
+    mMesh = readMesh();
+    mesh = mMesh.data();
+    mReadMesh.fetchAndStoreOrdered(mesh);
+  }
+  return mesh;
+}
+
+IndexedMeshPointer LazyMesh::readMesh() const {
+  ObjFileReader objFileReader;
+  objFileReader.setMeshReorderingEnabled(mIsMeshReorderingEnabled);
+  IndexedMeshPointer mesh = objFileReader.readMeshFromObjFile(mFileName);
+  if (mesh == NULL) {
+    // Scene is rendered without the model rather than failed, reading is not repeated
+    std::cerr << "Mesh '" << mFileName.toUtf8().constData() << "' can not be read, model is not rendered" << std::endl;
+    return IndexedMeshPointer(new IndexedMesh());
+  }
+
+  const BoundingBox &boundingBox = mesh->boundingBox;
+  if (!mesh->positions.empty() &&
+      (boundingBox.min.x < mBoundingBox.min.x || boundingBox.min.y < mBoundingBox.min.y || boundingBox.min.z < mBoundingBox.min.z ||
+       boundingBox.max.x > mBoundingBox.max.x || boundingBox.max.y > mBoundingBox.max.y || boundingBox.max.z > mBoundingBox.max.z)) {
+    std::cerr << "Mesh '" << mFileName.toUtf8().constData() << "' exceeds its bounding box, parts outside of it are not rendered" << std::endl;
+  }
+  return mesh;
+}
@@ -0,0 +1,41 @@
+/*!
+ *\file lazymesh.h
+ *\brief Contains LazyMesh class declaration
+ */
+
+#pragma once
+
+#include <QAtomicPointer>
+#include <QMutex>
+#include <QString>
+
+#include "meshmodel.h"
+
+/*!
+ * Indexed mesh read from OBJ file when it is requested for the first time.
+ * Object space bounds are given in advance, so rays which miss them never cause the file to be read.
+ * Threads requesting the mesh while it is read wait for it, threads which do not request it are not blocked.
+ */
+class LazyMesh {
+  public:
+    LazyMesh(const QString &fileName, const BoundingBox &boundingBox, bool isMeshReorderingEnabled);
+    virtual ~LazyMesh() {}
+
+    // Bounds given in advance, mesh is not read
+    const BoundingBox &getBoundingBox() const { return mBoundingBox; }
+    // Reads mesh if it is not read yet, mesh without triangles is returned if the file can not be read
+    const IndexedMesh *getMesh() const;
+
+  private:
+    IndexedMeshPointer readMesh() const;
+
+  private:
+    QString mFileName;
+    BoundingBox mBoundingBox;
+    bool mIsMeshReorderingEnabled;
+    mutable QMutex mReadingMutex;
+    // Owns the mesh, written under the mutex
+    mutable IndexedMeshPointer mMesh;
+    // Published after the mesh is read, checked without locking
+    mutable QAtomicPointer<IndexedMesh> mReadMesh;
+};
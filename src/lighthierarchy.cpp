@@ -0,0 +1,117 @@
+/*!
+ *\file lighthierarchy.cpp
+ *\brief Contains LightHierarchy class definition
+ */
+
+#include <algorithm>
+
+#include "lighthierarchy.h"
+#include "mathcommons.h"
+
+#define LIGHT_HIERARCHY_STACK_SIZE 64
+
+// Orders light source indices by influence sphere center coordinate along axis
+struct LightCenterComparator {
+  LightCenterComparator(const std::vector<Vector> &lightCenters, int splitAxis) : centers(lightCenters), axis(splitAxis) {}
+  bool operator()(int first, int second) const { return centers[first][axis] < centers[second][axis]; }
+
+  const std::vector<Vector> &centers;
+  int axis;
+};
+
+LightHierarchy::LightHierarchy(const std::vector<LightSourcePointer> &lightSources) 
+  : mCenters(lightSources.size()),
+    mSquaredRadii(lightSources.size(), 0.f) {
+  std::vector<int> boundedLightIndices;
+  for (int idx = 0, count = lightSources.size(); idx < count; ++idx) {
+    float radius;
+    if (lightSources[idx]->getInfluenceSphere(mCenters[idx], radius)) {
+      mSquaredRadii[idx] = radius * radius;
+      boundedLightIndices.push_back(idx);
+    } else {
+      mUnboundedLightIndices.push_back(idx);
+    }
+  }
+
+  if (!boundedLightIndices.empty()) {
+    mNodes.reserve(2 * boundedLightIndices.size() - 1);
+    buildNode(boundedLightIndices, 0, boundedLightIndices.size());
+  }
+}
+
+LightHierarchy::~LightHierarchy() {
+}
+
+int LightHierarchy::buildNode(std::vector<int> &indices, int begin, int end) {
+  int nodeIndex = mNodes.size();
+  mNodes.push_back(Node());
+
+  BoundingBox bounds(Vector(MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON),
+                     Vector(-MAX_DISTANCE_TO_INTERSECTON, -MAX_DISTANCE_TO_INTERSECTON, -MAX_DISTANCE_TO_INTERSECTON));
+  BoundingBox centerBounds = bounds;
+  for (int idx = begin; idx < end; ++idx) {
+    const Vector &center = mCenters[indices[idx]];
+    float radius = sqrtf(mSquaredRadii[indices[idx]]);
+    Vector extent(radius, radius, radius);
+    bounds.min = componentwiseMin(bounds.min, center - extent);
+    bounds.max = componentwiseMax(bounds.max, center + extent);
+    centerBounds.min = componentwiseMin(centerBounds.min, center);
+    centerBounds.max = componentwiseMax(centerBounds.max, center);
+  }
+  mNodes[nodeIndex].bounds = bounds;
+
+  if (end - begin == 1) {
+    mNodes[nodeIndex].lightIndex = indices[begin];
+    mNodes[nodeIndex].secondChildIndex = -1;
+    return nodeIndex;
+  }
+
+  // Split by median of centers along the longest axis
+  Vector centersExtent = centerBounds.max - centerBounds.min;
+  int axis = 0;
+  if (centersExtent.y > centersExtent[axis]) {
+    axis = 1;
+  }
+  if (centersExtent.z > centersExtent[axis]) {
+    axis = 2;
+  }
+  int middle = (begin + end) / 2;
+  std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end, LightCenterComparator(mCenters, axis));
+
+  mNodes[nodeIndex].lightIndex = -1;
+  buildNode(indices, begin, middle);
+  int secondChildIndex = buildNode(indices, middle, end);
+  mNodes[nodeIndex].secondChildIndex = secondChildIndex;
+  return nodeIndex;
+}
+
+void LightHierarchy::collectLightSources(const Vector &point, std::vector<int> &lightIndices) const {
+  lightIndices = mUnboundedLightIndices;
+  if (mNodes.empty()) {
+    return;
+  }
+
+  int stack[LIGHT_HIERARCHY_STACK_SIZE];
+  int stackSize = 0;
+  stack[stackSize++] = 0;
+  while (stackSize > 0) {
+    int nodeIndex = stack[--stackSize];
+    const Node &node = mNodes[nodeIndex];
+    if (point.x < node.bounds.min.x || point.x > node.bounds.max.x ||
+        point.y < node.bounds.min.y || point.y > node.bounds.max.y ||
+        point.z < node.bounds.min.z || point.z > node.bounds.max.z) {
+      continue;
+    }
+
+    if (node.lightIndex >= 0) {
+      if ((point - mCenters[node.lightIndex]).lengthSq() <= mSquaredRadii[node.lightIndex]) {
+        lightIndices.push_back(node.lightIndex);
+      }
+      continue;
+    }
+
+    // Median split keeps tree balanced, so its depth never exceeds stack size
+    stack[stackSize++] = node.secondChildIndex;
+    stack[stackSize++] = nodeIndex + 1;
+  }
+}
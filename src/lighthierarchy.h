@@ -0,0 +1,50 @@
+/*!
+ *\file lighthierarchy.h
+ *\brief Contains LightHierarchy class declaration
+ */
+
+#pragma once
+
+#include <QSharedPointer>
+#include <vector>
+
+#include "lightsource.h"
+#include "boundingbox.h"
+
+class LightHierarchy;
+
+typedef QSharedPointer<LightHierarchy> LightHierarchyPointer;
+
+/*!
+ * Bounding volume hierarchy over light source influence spheres.
+ * Shading point visits only light sources whose influence sphere contains it,
+ * light sources without influence sphere are always visited.
+ */
+class LightHierarchy {
+  public:
+    LightHierarchy(const std::vector<LightSourcePointer> &lightSources);
+    virtual ~LightHierarchy();
+
+    // Replaces content of lightIndices with indices of light sources which can affect the point
+    void collectLightSources(const Vector &point, std::vector<int> &lightIndices) const;
+
+  private:
+    struct Node {
+      BoundingBox bounds;
+      // Index of light source for leaf node, -1 for inner node
+      int lightIndex;
+      // Inner node first child follows the node, second child is stored by index
+      int secondChildIndex;
+    };
+
+    // Builds subtree over indices in [begin, end) range, returns index of subtree root
+    int buildNode(std::vector<int> &indices, int begin, int end);
+
+  private:
+    std::vector<Node> mNodes;
+    std::vector<int> mUnboundedLightIndices;
+
+    // Influence spheres of bounded light sources
+    std::vector<Vector> mCenters;
+    std::vector<float> mSquaredRadii;
+};
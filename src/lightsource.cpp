@@ -6,7 +6,7 @@
 #include <math.h>
 
 #include "lightsource.h"
-#include "scene.h"
+#include "mathcommons.h"
 
 
 LightSource::LightSource(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity) 
@@ -16,4 +16,48 @@ LightSource::LightSource(Color ambientIntensity, Color diffuseIntensity, Color s
 }
 
 LightSource::~LightSource() {
-}
\ No newline at end of file
+}
+
+bool LightSource::getInfluenceSphere(Vector &center, float &radius) const {
+  return false;
+}
+
+bool LightSource::getAttenuation(Vector &position, float &constantAttenutaionCoefficient, float &linearAttenutaionCoefficient, 
+                                 float &quadraticAttenutaionCoefficient) const {
+  return false;
+}
+
+float LightSource::estimateContribution(const Vector &point, const Vector &normal) const {
+  return getMaxIntensity();
+}
+
+float LightSource::getMaxIntensity() const {
+  return maxComponent(mAmbientIntensity + mDiffuseIntensity + mSpecularIntensity);
+}
+
+float LightSource::estimateAttenuatedContribution(float attenuation, bool isFacingLight) const {
+  Color intensity = isFacingLight ? mAmbientIntensity + mDiffuseIntensity + mSpecularIntensity : mAmbientIntensity;
+  return maxComponent(intensity) * attenuation;
+}
+
+float LightSource::calculateInfluenceRadius(float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, 
+                                            float quadraticAttenutaionCoefficient, float contributionThreshold) const {
+  if (contributionThreshold <= 0.f) {
+    return MAX_DISTANCE_TO_INTERSECTON;
+  }
+
+  // Contribution is intensity / attenuation, so it is below threshold when c + l * r + q * r^2 > intensity / threshold
+  float attenuationLimit = getMaxIntensity() / contributionThreshold - constantAttenutaionCoefficient;
+  if (attenuationLimit <= 0.f) {
+    return 0.f;
+  }
+
+  if (quadraticAttenutaionCoefficient > FLOAT_ZERO) {
+    float discriminant = linearAttenutaionCoefficient * linearAttenutaionCoefficient + 4.f * quadraticAttenutaionCoefficient * attenuationLimit;
+    return (sqrtf(discriminant) - linearAttenutaionCoefficient) / (2.f * quadraticAttenutaionCoefficient);
+  }
+  if (linearAttenutaionCoefficient > FLOAT_ZERO) {
+    return attenuationLimit / linearAttenutaionCoefficient;
+  }
+  return MAX_DISTANCE_TO_INTERSECTON;
+}
@@ -12,18 +12,54 @@
 #include "ray.h"
 
 struct LightSource;
-class Scene;
 
 typedef QSharedPointer<LightSource> LightSourcePointer;
 
+// Light intensity reaching the point, each component is multiplied by corresponding material color.
+// Diffuse and specular components are unshadowed, they are proportional to fraction of light source visible from the point
+struct LightIrradiance {
+  Color ambient;
+  Color diffuse;
+  Color specular;
+
+  // Color of the point lit by the irradiance
+  Color calculateColor(const Material &material) const {
+    return material.ambientColor * ambient + material.diffuseColor * diffuse + material.specularColor * specular;
+  }
+};
+
 struct LightSource {
   public:
     LightSource(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity);
     virtual ~LightSource();
 
-    virtual Color calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const = 0;
+    // Calculates shadow ray from the point to the light source, 
+    // returns false if the point can not be illuminated by the light source directly, so no shadow ray is needed
+    virtual bool calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const = 0;
+    // Calculates unshadowed irradiance at the point, specular component depends on view direction
+    virtual LightIrradiance calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const = 0;
+    // Calculates sphere outside of which light source contribution is negligible,
+    // returns false if light source can affect any point of the scene
+    virtual bool getInfluenceSphere(Vector &center, float &radius) const;
+    // Gets light position and distance attenuation coefficients, returns false if light source has no position
+    virtual bool getAttenuation(Vector &position, float &constantAttenutaionCoefficient, float &linearAttenutaionCoefficient, 
+                                float &quadraticAttenutaionCoefficient) const;
+    // Estimates unshadowed contribution of the light source to the point,
+    // estimation is zero only if light source does not affect the point
+    virtual float estimateContribution(const Vector &point, const Vector &normal) const;
+
+    // Largest component of total light source intensity
+    float getMaxIntensity() const;
 
   protected:
+    // Calculates distance at which the largest component of attenuated intensity drops below threshold,
+    // MAX_DISTANCE_TO_INTERSECTON is returned if there is no such distance
+    float calculateInfluenceRadius(float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, 
+                                   float quadraticAttenutaionCoefficient, float contributionThreshold) const;
+    // Estimates contribution of the light source with given attenuation, diffuse and specular components are
+    // taken into account only if the point faces the light source
+    float estimateAttenuatedContribution(float attenuation, bool isFacingLight) const;
+
     // Colors intensity
     Color	mAmbientIntensity;
     Color	mDiffuseIntensity;
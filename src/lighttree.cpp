@@ -0,0 +1,170 @@
+/*!
+ *\file lighttree.cpp
+ *\brief Contains LightTree class definition
+ */
+
+#include <algorithm>
+
+#include "lighttree.h"
+#include "mathcommons.h"
+
+// Orders light source indices by position coordinate along axis
+struct LightPositionComparator {
+  LightPositionComparator(const std::vector<Vector> &lightPositions, int splitAxis) : positions(lightPositions), axis(splitAxis) {}
+  bool operator()(int first, int second) const { return positions[first][axis] < positions[second][axis]; }
+
+  const std::vector<Vector> &positions;
+  int axis;
+};
+
+LightTree::LightTree(const std::vector<LightSourcePointer> &lightSources) 
+  : mLightSources(lightSources),
+    mPositions(lightSources.size()),
+    mConstantAttenutaionCoefficients(lightSources.size(), 0.f),
+    mLinearAttenutaionCoefficients(lightSources.size(), 0.f),
+    mQuadraticAttenutaionCoefficients(lightSources.size(), 0.f) {
+  std::vector<int> positionedLightIndices;
+  for (int idx = 0, count = lightSources.size(); idx < count; ++idx) {
+    if (lightSources[idx]->getAttenuation(mPositions[idx], mConstantAttenutaionCoefficients[idx], 
+                                          mLinearAttenutaionCoefficients[idx], mQuadraticAttenutaionCoefficients[idx])) {
+      positionedLightIndices.push_back(idx);
+    } else {
+      mUnpositionedLightIndices.push_back(idx);
+    }
+  }
+
+  if (!positionedLightIndices.empty()) {
+    mNodes.reserve(2 * positionedLightIndices.size() - 1);
+    buildNode(positionedLightIndices, 0, positionedLightIndices.size());
+  }
+}
+
+LightTree::~LightTree() {
+}
+
+int LightTree::buildNode(std::vector<int> &indices, int begin, int end) {
+  int nodeIndex = mNodes.size();
+  mNodes.push_back(Node());
+
+  Node node;
+  node.bounds = BoundingBox(mPositions[indices[begin]], mPositions[indices[begin]]);
+  node.intensity = 0.f;
+  node.constantAttenutaionCoefficient = MAX_DISTANCE_TO_INTERSECTON;
+  node.linearAttenutaionCoefficient = MAX_DISTANCE_TO_INTERSECTON;
+  node.quadraticAttenutaionCoefficient = MAX_DISTANCE_TO_INTERSECTON;
+  node.hasInfluenceBounds = true;
+  for (int idx = begin; idx < end; ++idx) {
+    int lightIndex = indices[idx];
+    Vector influenceCenter;
+    float influenceRadius;
+    if (node.hasInfluenceBounds && mLightSources[lightIndex]->getInfluenceSphere(influenceCenter, influenceRadius)) {
+      Vector extent(influenceRadius, influenceRadius, influenceRadius);
+      BoundingBox influenceBounds(influenceCenter - extent, influenceCenter + extent);
+      if (idx == begin) {
+        node.influenceBounds = influenceBounds;
+      } else {
+        node.influenceBounds.merge(influenceBounds);
+      }
+    } else {
+      node.hasInfluenceBounds = false;
+    }
+    node.bounds.min = componentwiseMin(node.bounds.min, mPositions[lightIndex]);
+    node.bounds.max = componentwiseMax(node.bounds.max, mPositions[lightIndex]);
+    node.intensity += mLightSources[lightIndex]->getMaxIntensity();
+    node.constantAttenutaionCoefficient = std::min(node.constantAttenutaionCoefficient, mConstantAttenutaionCoefficients[lightIndex]);
+    node.linearAttenutaionCoefficient = std::min(node.linearAttenutaionCoefficient, mLinearAttenutaionCoefficients[lightIndex]);
+    node.quadraticAttenutaionCoefficient = std::min(node.quadraticAttenutaionCoefficient, mQuadraticAttenutaionCoefficients[lightIndex]);
+  }
+
+  if (end - begin == 1) {
+    node.lightIndex = indices[begin];
+    node.secondChildIndex = -1;
+    mNodes[nodeIndex] = node;
+    return nodeIndex;
+  }
+
+  // Split by median of positions along the longest axis
+  Vector extent = node.bounds.max - node.bounds.min;
+  int axis = 0;
+  if (extent.y > extent[axis]) {
+    axis = 1;
+  }
+  if (extent.z > extent[axis]) {
+    axis = 2;
+  }
+  int middle = (begin + end) / 2;
+  std::nth_element(indices.begin() + begin, indices.begin() + middle, indices.begin() + end, LightPositionComparator(mPositions, axis));
+
+  node.lightIndex = -1;
+  buildNode(indices, begin, middle);
+  node.secondChildIndex = buildNode(indices, middle, end);
+  mNodes[nodeIndex] = node;
+  return nodeIndex;
+}
+
+float LightTree::estimateContribution(int nodeIndex, const Vector &point, const Vector &normal) const {
+  const Node &node = mNodes[nodeIndex];
+  if (node.lightIndex >= 0) {
+    return mLightSources[node.lightIndex]->estimateContribution(point, normal);
+  }
+
+  // The point is outside influence spheres of all node light sources
+  if (node.hasInfluenceBounds && !node.influenceBounds.overlapsWithBox(BoundingBox(point, point))) {
+    return 0.f;
+  }
+
+  // Node over two leaves is estimated exactly, so it is not chosen if neither of its light sources affects the point
+  const Node &firstChild = mNodes[nodeIndex + 1];
+  const Node &secondChild = mNodes[node.secondChildIndex];
+  if (firstChild.lightIndex >= 0 && secondChild.lightIndex >= 0) {
+    return mLightSources[firstChild.lightIndex]->estimateContribution(point, normal) + 
+           mLightSources[secondChild.lightIndex]->estimateContribution(point, normal);
+  }
+
+  // Distance to the cluster is bounded by distance to its box center reduced by half of box diagonal
+  Vector center = (node.bounds.min + node.bounds.max) * 0.5f;
+  float halfDiagonal = (node.bounds.max - node.bounds.min).length() * 0.5f;
+  float distance = std::max((center - point).length() - halfDiagonal, 0.f);
+  float attenuation = node.constantAttenutaionCoefficient + node.linearAttenutaionCoefficient * distance + 
+                      node.quadraticAttenutaionCoefficient * distance * distance;
+  return node.intensity / std::max(attenuation, FLOAT_ZERO);
+}
+
+int LightTree::sampleLightSource(const Vector &point, const Vector &normal, float random, float &probability) const {
+  probability = 1.f;
+  if (mNodes.empty()) {
+    return -1;
+  }
+
+  int nodeIndex = 0;
+  while (mNodes[nodeIndex].lightIndex < 0) {
+    int firstChildIndex = nodeIndex + 1;
+    int secondChildIndex = mNodes[nodeIndex].secondChildIndex;
+    float firstContribution = estimateContribution(firstChildIndex, point, normal);
+    float secondContribution = estimateContribution(secondChildIndex, point, normal);
+    float totalContribution = firstContribution + secondContribution;
+    // Estimation of the node was not zero, but none of its light sources affects the point
+    if (totalContribution <= 0.f) {
+      return -1;
+    }
+
+    // Random number is rescaled after each choice, so the same number drives the whole traversal
+    float firstProbability = firstContribution / totalContribution;
+    if (random < firstProbability) {
+      nodeIndex = firstChildIndex;
+      random = random / firstProbability;
+      probability *= firstProbability;
+    } else {
+      nodeIndex = secondChildIndex;
+      random = (random - firstProbability) / (1.f - firstProbability);
+      probability *= 1.f - firstProbability;
+    }
+    random = std::min(random, 1.f - FLOAT_ZERO);
+  }
+
+  // Single light tree
+  if (nodeIndex == 0 && estimateContribution(0, point, normal) <= 0.f) {
+    return -1;
+  }
+  return mNodes[nodeIndex].lightIndex;
+}
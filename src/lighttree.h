@@ -0,0 +1,70 @@
+/*!
+ *\file lighttree.h
+ *\brief Contains LightTree class declaration
+ */
+
+#pragma once
+
+#include <QSharedPointer>
+#include <vector>
+
+#include "lightsource.h"
+#include "boundingbox.h"
+
+class LightTree;
+
+typedef QSharedPointer<LightTree> LightTreePointer;
+
+/*!
+ * Binary tree over positions of light sources used to sample them by importance.
+ * Each node stores total intensity of its light sources and the weakest attenuation among them,
+ * traversal chooses a child with probability proportional to its estimated unshadowed contribution.
+ * Estimation of inner node is zero if the point is outside influence spheres of all node light sources,
+ * nodes over two leaves are estimated by their light sources exactly, so that subtrees not affecting the point are rarely chosen.
+ * Light sources without position can not be bounded and should be evaluated separately.
+ */
+class LightTree {
+  public:
+    LightTree(const std::vector<LightSourcePointer> &lightSources);
+    virtual ~LightTree();
+
+    const std::vector<int> &getUnpositionedLightIndices() const { return mUnpositionedLightIndices; }
+    bool isEmpty() const { return mNodes.empty(); }
+
+    // Chooses light source with position using random number in [0, 1) range, returns its index and probability of the choice.
+    // Returns -1 if traversal reaches a subtree whose light sources can not affect the point, it is a sample with zero contribution
+    int sampleLightSource(const Vector &point, const Vector &normal, float random, float &probability) const;
+
+  private:
+    struct Node {
+      BoundingBox bounds;
+      // Sum of largest intensity components of node light sources
+      float intensity;
+      // Box bounding influence spheres of node light sources, valid only if all of them have influence sphere
+      BoundingBox influenceBounds;
+      bool hasInfluenceBounds;
+      // Minimal attenuation coefficients of node light sources
+      float constantAttenutaionCoefficient;
+      float linearAttenutaionCoefficient;
+      float quadraticAttenutaionCoefficient;
+      // Index of light source for leaf node, -1 for inner node
+      int lightIndex;
+      // Inner node first child follows the node, second child is stored by index
+      int secondChildIndex;
+    };
+
+    // Builds subtree over indices in [begin, end) range, returns index of subtree root
+    int buildNode(std::vector<int> &indices, int begin, int end);
+    float estimateContribution(int nodeIndex, const Vector &point, const Vector &normal) const;
+
+  private:
+    std::vector<LightSourcePointer> mLightSources;
+    std::vector<Node> mNodes;
+    std::vector<int> mUnpositionedLightIndices;
+
+    // Attenuation data of light sources with position
+    std::vector<Vector> mPositions;
+    std::vector<float> mConstantAttenutaionCoefficients;
+    std::vector<float> mLinearAttenutaionCoefficients;
+    std::vector<float> mQuadraticAttenutaionCoefficients;
+};
@@ -9,6 +9,7 @@
 #include "inputparameters.h"
 #include "sceneloader.h"
 #include "raytracer.h"
+#include "objfilereader.h"
 
 void printUsage();
 
@@ -28,32 +29,106 @@ int main(int argc, char *argv[]) {
     return -1;
   }
 
+  if (StreamingImageWriter::isStandardOutput(inputParameters->outputFilePath)) {
+    // Standard output carries the image, so progress messages go to standard error
+    std::cout.rdbuf(std::cerr.rdbuf());
+  }
+
+  if (!inputParameters->meshPagesModelFilePath.isEmpty()) {
+    // Whole mesh is kept in memory while it is split into pages, so this is done once before rendering with --memory_budget
+    std::cout << "Building mesh page file of '" << inputParameters->meshPagesModelFilePath.toUtf8().constData() << "'..." << std::endl;
+    ObjFileReader objFileReader;
+    objFileReader.setMeshReorderingEnabled(inputParameters->isMeshReorderingEnabled);
+    IndexedMeshPointer mesh = objFileReader.readMeshFromObjFile(inputParameters->meshPagesModelFilePath);
+    if (mesh == NULL || !PagedMesh::writePageFile(*mesh, inputParameters->meshPagesModelFilePath + PAGED_MESH_FILE_SUFFIX)) {
+      return -1;
+    }
+    std::cout << "Mesh page file is built" << std::endl;
+    return 0;
+  }
+
   std::cout << "Loading scene..." << std::endl; 
 
   SceneLoader sceneLoader;
+  sceneLoader.setQuadricLoweringEnabled(inputParameters->isQuadricLoweringEnabled);
+  sceneLoader.setMeshReorderingEnabled(inputParameters->isMeshReorderingEnabled);
+  sceneLoader.setLazyMeshLoadingEnabled(inputParameters->isLazyMeshLoadingEnabled);
+  MeshPageCachePointer meshPageCache;
+  if (inputParameters->meshMemoryBudget > 0) {
+    meshPageCache = MeshPageCachePointer(new MeshPageCache(static_cast<qint64>(inputParameters->meshMemoryBudget) << 20));
+    sceneLoader.setMeshPageCache(meshPageCache);
+  }
+  SceneSnapshotWriter snapshotWriter;
+  const bool isSceneCompiled = !inputParameters->snapshotFilePath.isEmpty();
+  if (isSceneCompiled) {
+    sceneLoader.setSnapshotWriter(&snapshotWriter);
+  }
   ScenePointer scene = sceneLoader.loadScene(inputParameters->sceneFilePath);
   if (scene == NULL) {
     std::cout << "Scene loading failed" << std::endl;
     return -1;    
   }
 
+  if (isSceneCompiled) {
+    std::cout << "Saving scene snapshot to file '" << inputParameters->snapshotFilePath.toUtf8().constData() << "'" << std::endl;
+    if (!snapshotWriter.saveToFile(inputParameters->snapshotFilePath)) {
+      return -1;
+    }
+    std::cout << "Scene snapshot is saved" << std::endl;
+    return 0;
+  }
+  scene->setLightSamplesCount(inputParameters->lightSamplesCount);
+
   std::cout << "Loading scene finished" << std::endl; 
 
   RayTracer rayTracer;
   rayTracer.setScene(scene);
   rayTracer.setImageResolution(inputParameters->xResolution, inputParameters->yResolution);
+  rayTracer.setSamplesPerPixel(inputParameters->samplesPerPixel);
+  rayTracer.setIrradianceCacheSpacing(inputParameters->irradianceCacheSpacing);
 
-  std::cout << "Rendering scene..." << std::endl;
-  rayTracer.renderScene();
+  const bool isImageStreamed = inputParameters->bandHeight > 0;
+  if (isImageStreamed) {
+    std::cout << "Rendering scene to file '" << inputParameters->outputFilePath.toUtf8().constData() << "' in bands of " 
+              << inputParameters->bandHeight << " rows..." << std::endl;
+    if (!rayTracer.renderSceneToFile(inputParameters->outputFilePath, inputParameters->bandHeight)) {
+      return -1;
+    }
+  } else {
+    std::cout << "Rendering scene..." << std::endl;
+    rayTracer.renderScene();
+  }
   std::cout << "Rendering scene finished" << std::endl; 
-  
-  std::cout << "Saving image to file '" << inputParameters->outputFilePath.toUtf8().constData() << "'" << std::endl; 
-  rayTracer.saveRenderedImageToFile(inputParameters->outputFilePath);
-  std::cout << "Image is saved" << std::endl;
+
+  const ShadowOccluderCache &occluderCache = rayTracer.getShadowOccluderCache();
+  std::cout << "Shadow occluder cache: " << occluderCache.getHitsCount() << " hits of " << occluderCache.getLookupsCount() 
+            << " shadow rays (" << occluderCache.getHitRate() * 100.f << "%)" << std::endl;
+  const IrradianceCache &irradianceCache = rayTracer.getIrradianceCache();
+  if (irradianceCache.isEnabled()) {
+    std::cout << "Irradiance cache: " << irradianceCache.getHitsCount() << " hits of " << irradianceCache.getLookupsCount() 
+              << " lookups (" << irradianceCache.getHitRate() * 100.f << "%), " << irradianceCache.getRecordsCount() << " records" 
+              << (irradianceCache.isFull() ? " (limit reached)" : "") << std::endl;
+  }
+  if (meshPageCache != NULL) {
+    const double megabyte = 1024.0 * 1024.0;
+    std::cout << "Mesh page cache: " << meshPageCache->getPageInsCount() << " page-ins of " << meshPageCache->getRequestsCount() 
+              << " page requests (" << meshPageCache->getPageInRate() * 100.f << "%), " << meshPageCache->getEvictionsCount() << " evictions, "
+              << meshPageCache->getReadBytesCount() / megabyte << " MB read, peak resident " << meshPageCache->getPeakResidentBytesCount() / megabyte 
+              << " MB of " << meshPageCache->getMemoryBudget() / megabyte << " MB budget" << std::endl;
+  }
+
+  if (!isImageStreamed) {
+    std::cout << "Saving image to file '" << inputParameters->outputFilePath.toUtf8().constData() << "'" << std::endl; 
+    rayTracer.saveRenderedImageToFile(inputParameters->outputFilePath);
+    std::cout << "Image is saved" << std::endl;
+  }
 
   return 0; 
 }
 
 void printUsage() {
-  std::cout << "Usage: ray-tracer.exe --scene=scene.xml --resolution_x=1280 --resolution_y=800 --output=image.png" << std::endl;
+  std::cout << "Usage: ray-tracer.exe --scene=scene.xml --resolution_x=1280 --resolution_y=800 --output=image.png [--band_height=64] [--lower_quadrics] [--reorder_meshes] [--lazy_meshes] [--memory_budget=512] [--light_samples=8] [--samples_per_pixel=16] [--irradiance_cache=0.1]" << std::endl;
+  std::cout << "       (irradiance cache is not used with --light_samples, which makes lighting a random estimation)" << std::endl;
+  std::cout << "       ray-tracer.exe --build_mesh_pages=model.obj [--reorder_meshes]" << std::endl;
+  std::cout << "       ray-tracer.exe --scene=scene.xml --compile_scene=scene.bin [--reorder_meshes]" << std::endl;
 }
\ No newline at end of file
@@ -9,12 +9,40 @@
 
 #include "types.h"
 
+//#define CALCULATE_FRENSEL_COEFFICIENT_BY_SHLICK
+
+// Shading features of material, each set of features is shaded by its own specialized path
+enum MaterialFeature {
+  MATERIAL_FEATURE_REFLECTIVE = 1,
+  MATERIAL_FEATURE_REFRACTIVE = 2,
+  // Fresnel coefficient is approximated by Schlick formula, only reflective and refractive materials need it
+  MATERIAL_FEATURE_SCHLICK_FRESNEL = 4
+};
+
+#define MATERIAL_FEATURES_OPAQUE 0
+
 struct Material;
 
 typedef QSharedPointer<Material> MaterialPointer;
 
 struct Material { 
-  Material() : specularPower(0), densityFactor(0), illuminationFactor(0), reflectionFactor(0), refractionFactor(0) {}
+  Material() : specularPower(0), densityFactor(0), illuminationFactor(0), reflectionFactor(0), refractionFactor(0), features(MATERIAL_FEATURES_OPAQUE) {}
+
+  // Classifies material by its factors, should be called after factors are set
+  void updateFeatures() {
+    features = MATERIAL_FEATURES_OPAQUE;
+    if (reflectionFactor > 0.f) {
+      features |= MATERIAL_FEATURE_REFLECTIVE;
+    }
+    if (refractionFactor > 0.f) {
+      features |= MATERIAL_FEATURE_REFRACTIVE;
+    }
+  #ifdef CALCULATE_FRENSEL_COEFFICIENT_BY_SHLICK
+    if (features != MATERIAL_FEATURES_OPAQUE) {
+      features |= MATERIAL_FEATURE_SCHLICK_FRESNEL;
+    }
+  #endif
+  }
 
   // Color properties as described by Phong model
   Color ambientColor;
@@ -29,4 +57,7 @@ struct Material {
   float	illuminationFactor;
   float	reflectionFactor;
   float	refractionFactor;
+
+  // Mask of MaterialFeature values
+  unsigned features;
 };
\ No newline at end of file
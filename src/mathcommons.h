@@ -1,8 +1,25 @@
 #pragma once
 
+#include <algorithm>
+
 #include "types.h"
 
 inline Vector componentwiseProduct(const Vector &vector, const Vector &other)
 {
-  return Vector(vector.x * other.x, vector.y * other.y, vector.z * other.z);
+  return vector * other;
+}
+
+inline Vector componentwiseMin(const Vector &vector, const Vector &other)
+{
+  return vector.minimum(other);
+}
+
+inline Vector componentwiseMax(const Vector &vector, const Vector &other)
+{
+  return vector.maximum(other);
+}
+
+inline float maxComponent(const Vector &vector)
+{
+  return std::max(vector.x, std::max(vector.y, vector.z));
 }
@@ -1,120 +1,72 @@
 #include "meshmodel.h"
+#include "lazymesh.h"
+#include "pagedmesh.h"
 #include "rayintersection.h"
 #include "types.h"
+#include "mathcommons.h"
 
-ModelTriangle::ModelTriangle(Vector vertex0, Vector vertex1, Vector vertex2,
-                             Vector normal0, Vector normal1, Vector normal2, 
-                             MaterialPointer material)
-  : Triangle(vertex0, vertex1, vertex2, material),
-    mNormal0(normal0),
-    mNormal1(normal1),
-    mNormal2(normal2) {
-}
-
-ModelTriangle::~ModelTriangle() {
-}
-
-Vector ModelTriangle::getNormal(const Ray &ray, float distance, float u, float v) const {
-  Vector normal = mNormal1 * u + mNormal2 * v + mNormal0 * (1 - u - v);
-  normal.normalize();
-  return normal;
-}
-
-RayIntersection ModelTriangle::intersectWithRay(const Ray &ray) const {
-  Vector rayOrigin	= ray.getOriginPosition();
-  Vector rayDirection = ray.getDirection();
-
-  Vector e1 = mVertex1 - mVertex0;
-  Vector e2 = mVertex2 - mVertex0;
-
-  Vector pvector = rayDirection.crossProduct(e2);
-  float	determinant = e1.dotProduct(pvector);
+// Moller-Trumbore ray triangle intersection, returns barycentric coordinates of intersection point
+static inline bool intersectRayWithTriangle(const Vector &rayOrigin, const Vector &rayDirection,
+                                            const Vector &vertex0, const Vector &edge1, const Vector &edge2,
+                                            float &distance, float &lambda, float &mue) {
+  Vector pvector = rayDirection.crossProduct(edge2);
+  float	determinant = edge1.dotProduct(pvector);
 
   if (fabs(determinant) < FLOAT_ZERO) {
-    return RayIntersection();
+    return false;
   }
 
   const float invertedDeterminant = 1.0 / determinant;
 
-  Vector tvec	= rayOrigin - mVertex0;
-  float	lambda = tvec.dotProduct(pvector);
+  Vector tvec	= rayOrigin - vertex0;
+  lambda = tvec.dotProduct(pvector);
 
   lambda *= invertedDeterminant;
 
   if (lambda < 0.0 || lambda > 1.0) {
-    return RayIntersection();
+    return false;
   }
 
-  Vector qvec = tvec.crossProduct(e1);
-  float	mue	= rayDirection.dotProduct(qvec);
+  Vector qvec = tvec.crossProduct(edge1);
+  mue	= rayDirection.dotProduct(qvec);
 
   mue *= invertedDeterminant;
 
   if (mue < 0.f || mue + lambda > 1.f) {
-    return RayIntersection();
+    return false;
   }
 
-  float f = e2.dotProduct(qvec);
-  f = f * invertedDeterminant - FLOAT_ZERO;
-
-  if (f < FLOAT_ZERO) {
-    return RayIntersection();
-  }
+  distance = edge2.dotProduct(qvec);
+  distance = distance * invertedDeterminant - FLOAT_ZERO;
 
-  std::vector<float> intersectionDistances;
-  intersectionDistances.push_back(f);
-  TrianglePointer pointer = TrianglePointer(new Triangle(*this));
-  return RayIntersection(true, pointer, f, getNormal(ray, f, lambda, mue), intersectionDistances);
+  return distance >= FLOAT_ZERO;
 }
 
+MeshModel::MeshModel(IndexedMeshPointer mesh, const Vector &translation, const Vector &scale, MaterialPointer material)
+  : Shape(material),
+    mMesh(mesh),
+    mTranslation(translation),
+    mScale(scale),
+    mInvertedScale(1.f / scale.x, 1.f / scale.y, 1.f / scale.z) {
+  initializeBoundingBox(mMesh->boundingBox);
+}
 
-bool BoundingBox::intersectsWithRay(const Ray &ray) const {
-  Vector rayOrigin    = ray.getOriginPosition();
-  Vector rayDirection = ray.getDirection();
-
-  float d0 = -MAX_DISTANCE_TO_INTERSECTON;
-  float d1 = MAX_DISTANCE_TO_INTERSECTON;
-
-  if (fabs(rayDirection.x) > FLOAT_ZERO) {
-    d0 = (min.x - rayOrigin.x) / rayDirection.x;
-    d1 = (max.x - rayOrigin.x) / rayDirection.x;
-    if(d1 < d0) {
-      std::swap(d0, d1);
-    }
-  }
-
-  if (fabs(rayDirection.y) > FLOAT_ZERO) {
-    float t0 = (min.y - rayOrigin.y) / rayDirection.y;
-    float t1 = (max.y - rayOrigin.y) / rayDirection.y;
-    
-    if(t1 < t0) {
-      std::swap(t0, t1);
-    }
-    d0 = std::max(d0, t0);
-    d1 = std::min(d1, t1);
-  }
-
-  if (fabs(rayDirection.z) > FLOAT_ZERO) {
-    float t0 = (min.z - rayOrigin.z) / rayDirection.z;
-    float t1 = (max.z - rayOrigin.z) / rayDirection.z;
-    if(t1 < t0) {
-      std::swap(t0, t1);
-    }
-    d0 = std::max(d0, t0);
-    d1 = std::min(d1, t1);
-  }
-
-  if (d1 < d0 || d0 == -MAX_DISTANCE_TO_INTERSECTON) {
-    return false;
-  } else {
-    return true;
-  }
+MeshModel::MeshModel(LazyMeshPointer lazyMesh, const Vector &translation, const Vector &scale, MaterialPointer material)
+  : Shape(material),
+    mLazyMesh(lazyMesh),
+    mTranslation(translation),
+    mScale(scale),
+    mInvertedScale(1.f / scale.x, 1.f / scale.y, 1.f / scale.z) {
+  initializeBoundingBox(mLazyMesh->getBoundingBox());
 }
 
-MeshModel::MeshModel(const std::vector<ModelTrianglePointer> &triangles, const BoundingBox &boundingBox, MaterialPointer material)
+MeshModel::MeshModel(PagedMeshPointer pagedMesh, const Vector &translation, const Vector &scale, MaterialPointer material)
   : Shape(material),
-    mTriangles(triangles),
-    mBoundingBox(boundingBox) {
+    mPagedMesh(pagedMesh),
+    mTranslation(translation),
+    mScale(scale),
+    mInvertedScale(1.f / scale.x, 1.f / scale.y, 1.f / scale.z) {
+  initializeBoundingBox(mPagedMesh->getBoundingBox());
 }
 
 MeshModel::~MeshModel() {
@@ -125,18 +77,41 @@ RayIntersection MeshModel::intersectWithRay(const Ray &ray) const {
     return RayIntersection();
   }
 
+  // Ray in object space
+  const Vector rayOrigin = componentwiseProduct(ray.getOriginPosition() - mTranslation, mInvertedScale);
+  const Vector rayDirection = componentwiseProduct(ray.getDirection(), mInvertedScale);
   RayIntersection closestIntersection;
-  for each (auto triangle in mTriangles) {
-    RayIntersection currentIntersection = triangle->intersectWithRay(ray);
-    if (currentIntersection.rayIntersectsWithShape) {
-      closestIntersection.intersectionDistances.push_back(currentIntersection.distanceFromRayOrigin);
-      if (currentIntersection.distanceFromRayOrigin < closestIntersection.distanceFromRayOrigin) {
-        closestIntersection.rayIntersectsWithShape = true;
-        closestIntersection.distanceFromRayOrigin = currentIntersection.distanceFromRayOrigin;
-        closestIntersection.shape	= MeshModelPointer(new MeshModel(*this));
-        closestIntersection.normalAtInresectionPoint = currentIntersection.normalAtInresectionPoint;
+
+  if (mPagedMesh != NULL) {
+    // Node bounds are tested with normalized copy of object space ray, which does not change the test result.
+    // All hit pages are intersected, as CSG needs all intersection distances, so nodes are visited in any order
+    const Ray objectSpaceRay(rayOrigin, rayDirection);
+    int nodesStack[PAGED_MESH_MAX_TREE_DEPTH + 1];
+    int stackSize = 0;
+    if (mPagedMesh->getPagesCount() > 0) {
+      nodesStack[stackSize++] = 0;
+    }
+    while (stackSize > 0) {
+      const int nodeIndex = nodesStack[--stackSize];
+      if (!mPagedMesh->getNodeBoundingBox(nodeIndex).intersectsWithRay(objectSpaceRay)) {
+        continue;
+      }
+      const PagedMeshNode &node = mPagedMesh->getNode(nodeIndex);
+      if (node.pageIndex >= 0) {
+        intersectWithMesh(*mPagedMesh->getPage(node.pageIndex), rayOrigin, rayDirection, closestIntersection);
+      } else {
+        nodesStack[stackSize++] = node.rightChildIndex;
+        nodesStack[stackSize++] = nodeIndex + 1;
       }
     }
+  } else {
+    // Lazy mesh is read here when the model bounds are hit for the first time
+    intersectWithMesh(mMesh != NULL ? *mMesh : *mLazyMesh->getMesh(), rayOrigin, rayDirection, closestIntersection);
+  }
+
+  // Shape is set only for the closest intersection
+  if (closestIntersection.rayIntersectsWithShape) {
+    closestIntersection.shape = this;
   }
 
   return closestIntersection;
@@ -146,3 +121,55 @@ Vector MeshModel::getNormal(const Ray &ray, float distance) const {
   // This method is actually never called
   return Vector();
 }
+
+void MeshModel::initializeBoundingBox(const BoundingBox &meshBoundingBox) {
+  // Negative scale swaps bounds
+  Vector transformedMin = componentwiseProduct(meshBoundingBox.min, mScale) + mTranslation;
+  Vector transformedMax = componentwiseProduct(meshBoundingBox.max, mScale) + mTranslation;
+  mBoundingBox.min = componentwiseMin(transformedMin, transformedMax);
+  mBoundingBox.max = componentwiseMax(transformedMin, transformedMax);
+}
+
+void MeshModel::intersectWithMesh(const IndexedMesh &mesh, const Vector &rayOrigin, const Vector &rayDirection, RayIntersection &closestIntersection) const {
+  const std::vector<Vector> &positions = mesh.positions;
+  const std::vector<unsigned> &indices = mesh.indices;
+  int closestTriangleIndex = -1;
+  float closestLambda = 0.f;
+  float closestMue = 0.f;
+
+  for (int idx = 0, count = indices.size(); idx < count; idx += 3) {
+    const Vector &vertex0 = positions[indices[idx]];
+    Vector edge1 = positions[indices[idx + 1]] - vertex0;
+    Vector edge2 = positions[indices[idx + 2]] - vertex0;
+
+    float distance, lambda, mue;
+    if (!intersectRayWithTriangle(rayOrigin, rayDirection, vertex0, edge1, edge2, distance, lambda, mue)) {
+      continue;
+    }
+
+    closestIntersection.intersectionDistances.push_back(distance);
+    if (distance < closestIntersection.distanceFromRayOrigin) {
+      closestIntersection.distanceFromRayOrigin = distance;
+      closestTriangleIndex = idx / 3;
+      closestLambda = lambda;
+      closestMue = mue;
+    }
+  }
+
+  // Normal is calculated only for the closest triangle
+  if (closestTriangleIndex >= 0) {
+    closestIntersection.rayIntersectsWithShape = true;
+    closestIntersection.normalAtInresectionPoint = getNormal(mesh, closestTriangleIndex, closestLambda, closestMue);
+  }
+}
+
+Vector MeshModel::getNormal(const IndexedMesh &mesh, int triangleIndex, float u, float v) const {
+  const std::vector<Vector> &normals = mesh.normals;
+  const unsigned *triangleIndices = &mesh.indices[triangleIndex * 3];
+
+  Vector normal = normals[triangleIndices[1]] * u + normals[triangleIndices[2]] * v + normals[triangleIndices[0]] * (1 - u - v);
+  // Normals are transformed to world space by inverse transpose of scale
+  normal = componentwiseProduct(normal, mInvertedScale);
+  normal.normalize();
+  return normal;
+}
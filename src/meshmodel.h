@@ -1,50 +1,78 @@
+/*!
+ *\file meshmodel.h
+ *\brief Contains IndexedMesh struct and MeshModel class declaration
+ */
+
 #pragma once
 
 #include <vector>
 
-#include "triangle.h"
+#include "shape.h"
+#include "boundingbox.h"
 
-class ModelTriangle;
+struct IndexedMesh;
 
-typedef QSharedPointer<ModelTriangle> ModelTrianglePointer;
+typedef QSharedPointer<IndexedMesh> IndexedMeshPointer;
 
-class ModelTriangle : public Triangle {
-  public:
-    ModelTriangle(Vector vertex0, Vector vertex1, Vector vertex2,
-                  Vector normal0, Vector normal1, Vector normal2,
-                  MaterialPointer material);
-    virtual ~ModelTriangle();
+/*!
+ * Triangle mesh with vertices shared by adjacent triangles.
+ */
+struct IndexedMesh {
+  // Vertex attributes
+  std::vector<Vector> positions;
+  std::vector<Vector> normals;
+  // Three vertex indices per triangle
+  std::vector<unsigned> indices;
+  BoundingBox boundingBox;
+};
 
-    virtual RayIntersection intersectWithRay(const Ray &ray) const;
-    Vector ModelTriangle::getNormal(const Ray &ray, float distance, float u, float v) const;
+class LazyMesh;
 
-  private:
-    Vector mNormal0;
-    Vector mNormal1;
-    Vector mNormal2;
-};
+typedef QSharedPointer<LazyMesh> LazyMeshPointer;
 
-struct BoundingBox {
-  
-  bool intersectsWithRay(const Ray &ray) const;
+class PagedMesh;
 
-  Vector min;
-  Vector max;
-};
+typedef QSharedPointer<PagedMesh> PagedMeshPointer;
 
 class MeshModel;
 
 typedef QSharedPointer<MeshModel> MeshModelPointer;
 
+/*!
+ * Mesh model shape, instance of indexed mesh scaled and translated to world space.
+ * Mesh is shared by models created from the same file and by copies of the model, so copying the model into ray intersection is cheap.
+ * Rays are transformed to mesh object space, direction is not normalized there, so intersection distances remain world space ones.
+ * Model of lazy mesh is bounded by bounds given in advance, the mesh is read when a ray hits them for the first time.
+ * Model of paged mesh intersects only pages whose bounds are hit by the ray, the pages are read on request.
+ */
 class MeshModel : public Shape {
   public:
-    MeshModel(const std::vector<ModelTrianglePointer> &triangles, const BoundingBox &boundingBox, MaterialPointer material);
+    MeshModel(IndexedMeshPointer mesh, const Vector &translation, const Vector &scale, MaterialPointer material);
+    MeshModel(LazyMeshPointer lazyMesh, const Vector &translation, const Vector &scale, MaterialPointer material);
+    MeshModel(PagedMeshPointer pagedMesh, const Vector &translation, const Vector &scale, MaterialPointer material);
     virtual ~MeshModel();
 
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const BoundingBox &getBoundingBox() const { return mBoundingBox; }
+
   private:
-    std::vector<ModelTrianglePointer> mTriangles;
+    // Calculates world space bounding box from object space one
+    void initializeBoundingBox(const BoundingBox &meshBoundingBox);
+    // Intersects object space ray with mesh triangles, updates intersection if a closer triangle is found
+    void intersectWithMesh(const IndexedMesh &mesh, const Vector &rayOrigin, const Vector &rayDirection, RayIntersection &closestIntersection) const;
+    // Interpolates vertex normals at barycentric coordinates (u, v) of triangle
+    Vector getNormal(const IndexedMesh &mesh, int triangleIndex, float u, float v) const;
+
+  private:
+    // One of mesh, lazy mesh and paged mesh is set
+    IndexedMeshPointer mMesh;
+    LazyMeshPointer mLazyMesh;
+    PagedMeshPointer mPagedMesh;
+    Vector mTranslation;
+    Vector mScale;
+    Vector mInvertedScale;
+    // World space bounding box
     BoundingBox mBoundingBox;
-};
\ No newline at end of file
+};
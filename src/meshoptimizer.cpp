@@ -0,0 +1,178 @@
+#include <math.h>
+#include <algorithm>
+
+#include "meshoptimizer.h"
+
+void MeshOptimizer::optimize(IndexedMesh &mesh) const {
+  optimizeTriangleOrder(mesh.indices, mesh.positions.size());
+  optimizeVertexOrder(mesh);
+}
+
+float MeshOptimizer::calculateAverageCacheMissRatio(const IndexedMesh &mesh) const {
+  if (mesh.indices.empty()) {
+    return 0.f;
+  }
+
+  // LRU cache simulation, the most recently used vertex is at the front
+  std::vector<unsigned> cache;
+  int missesCount = 0;
+  for (size_t i = 0; i < mesh.indices.size(); ++i) {
+    std::vector<unsigned>::iterator cached = std::find(cache.begin(), cache.end(), mesh.indices[i]);
+    if (cached == cache.end()) {
+      ++missesCount;
+      if (cache.size() == MESH_OPTIMIZER_CACHE_SIZE) {
+        cache.pop_back();
+      }
+    } else {
+      cache.erase(cached);
+    }
+    cache.insert(cache.begin(), mesh.indices[i]);
+  }
+
+  return static_cast<float>(missesCount) / (mesh.indices.size() / 3);
+}
+
+void MeshOptimizer::optimizeTriangleOrder(std::vector<unsigned> &indices, int verticesCount) const {
+  const int trianglesCount = indices.size() / 3;
+  if (trianglesCount == 0) {
+    return;
+  }
+
+  // Lists of triangles adjacent to each vertex, triangles are removed from lists when they are added to output
+  std::vector<int> remainingTrianglesCounts(verticesCount, 0);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    ++remainingTrianglesCounts[indices[i]];
+  }
+  std::vector<int> adjacencyOffsets(verticesCount, 0);
+  for (int vertex = 1; vertex < verticesCount; ++vertex) {
+    adjacencyOffsets[vertex] = adjacencyOffsets[vertex - 1] + remainingTrianglesCounts[vertex - 1];
+  }
+  std::vector<int> adjacentTriangles(indices.size());
+  std::vector<int> adjacencyEnds(adjacencyOffsets);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    adjacentTriangles[adjacencyEnds[indices[i]]++] = i / 3;
+  }
+
+  std::vector<int> cachePositions(verticesCount, -1);
+  std::vector<float> vertexScores(verticesCount);
+  for (int vertex = 0; vertex < verticesCount; ++vertex) {
+    vertexScores[vertex] = calculateVertexScore(-1, remainingTrianglesCounts[vertex]);
+  }
+
+  std::vector<float> triangleScores(trianglesCount);
+  std::vector<bool> isTriangleAdded(trianglesCount, false);
+  int bestTriangle = 0;
+  for (int triangle = 0; triangle < trianglesCount; ++triangle) {
+    triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+    if (triangleScores[triangle] > triangleScores[bestTriangle]) {
+      bestTriangle = triangle;
+    }
+  }
+
+  std::vector<unsigned> optimizedIndices;
+  optimizedIndices.reserve(indices.size());
+
+  // Cache may temporarily hold three vertices more than its size
+  unsigned cache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+  unsigned updatedCache[MESH_OPTIMIZER_CACHE_SIZE + 3];
+  int cacheSize = 0;
+  int nextNotAddedTriangle = 0;
+
+  for (int addedTrianglesCount = 0; addedTrianglesCount < trianglesCount; ++addedTrianglesCount) {
+    if (bestTriangle < 0) {
+      // No triangle is adjacent to cached vertices, continue with the first triangle not added yet
+      while (isTriangleAdded[nextNotAddedTriangle]) {
+        ++nextNotAddedTriangle;
+      }
+      bestTriangle = nextNotAddedTriangle;
+    }
+
+    isTriangleAdded[bestTriangle] = true;
+    const unsigned *triangleVertices = &indices[bestTriangle * 3];
+    int updatedCacheSize = 0;
+    for (int k = 0; k < 3; ++k) {
+      const unsigned vertex = triangleVertices[k];
+      optimizedIndices.push_back(vertex);
+      updatedCache[updatedCacheSize++] = vertex;
+
+      // Remove triangle from vertex adjacency list
+      int *adjacencyBegin = &adjacentTriangles[adjacencyOffsets[vertex]];
+      int *adjacencyEnd = adjacencyBegin + remainingTrianglesCounts[vertex];
+      std::iter_swap(std::find(adjacencyBegin, adjacencyEnd, bestTriangle), adjacencyEnd - 1);
+      --remainingTrianglesCounts[vertex];
+    }
+
+    // Triangle vertices are moved to the front of the cache
+    for (int i = 0; i < cacheSize; ++i) {
+      const unsigned vertex = cache[i];
+      if (vertex != triangleVertices[0] && vertex != triangleVertices[1] && vertex != triangleVertices[2]) {
+        updatedCache[updatedCacheSize++] = vertex;
+      }
+    }
+
+    // Scores of cached and evicted vertices and of their triangles are updated, the best triangle is chosen among them
+    bestTriangle = -1;
+    float bestTriangleScore = -1.f;
+    for (int i = 0; i < updatedCacheSize; ++i) {
+      const unsigned vertex = updatedCache[i];
+      cachePositions[vertex] = i < MESH_OPTIMIZER_CACHE_SIZE ? i : -1;
+      vertexScores[vertex] = calculateVertexScore(cachePositions[vertex], remainingTrianglesCounts[vertex]);
+    }
+    for (int i = 0; i < updatedCacheSize; ++i) {
+      const unsigned vertex = updatedCache[i];
+      for (int j = adjacencyOffsets[vertex], end = j + remainingTrianglesCounts[vertex]; j < end; ++j) {
+        const int triangle = adjacentTriangles[j];
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+        if (triangleScores[triangle] > bestTriangleScore) {
+          bestTriangleScore = triangleScores[triangle];
+          bestTriangle = triangle;
+        }
+      }
+    }
+
+    cacheSize = std::min(updatedCacheSize, MESH_OPTIMIZER_CACHE_SIZE);
+    std::copy(updatedCache, updatedCache + cacheSize, cache);
+  }
+
+  indices.swap(optimizedIndices);
+}
+
+void MeshOptimizer::optimizeVertexOrder(IndexedMesh &mesh) const {
+  std::vector<int> newVertexIndices(mesh.positions.size(), -1);
+  std::vector<Vector> positions;
+  std::vector<Vector> normals;
+  positions.reserve(mesh.positions.size());
+  normals.reserve(mesh.normals.size());
+
+  for (size_t i = 0; i < mesh.indices.size(); ++i) {
+    const unsigned vertex = mesh.indices[i];
+    if (newVertexIndices[vertex] < 0) {
+      newVertexIndices[vertex] = positions.size();
+      positions.push_back(mesh.positions[vertex]);
+      normals.push_back(mesh.normals[vertex]);
+    }
+    mesh.indices[i] = newVertexIndices[vertex];
+  }
+
+  // Vertices not used by any triangle are dropped
+  mesh.positions.swap(positions);
+  mesh.normals.swap(normals);
+}
+
+float MeshOptimizer::calculateVertexScore(int cachePosition, int remainingTrianglesCount) const {
+  if (remainingTrianglesCount == 0) {
+    // Vertex is not used by any remaining triangle
+    return -1.f;
+  }
+
+  float score = 0.f;
+  if (cachePosition >= 3) {
+    const float scaler = 1.f / (MESH_OPTIMIZER_CACHE_SIZE - 3);
+    score = powf(1.f - (cachePosition - 3) * scaler, MESH_OPTIMIZER_CACHE_DECAY_POWER);
+  } else if (cachePosition >= 0) {
+    // Vertices of the last triangle get fixed score, so that the next triangle does not always share an edge with it
+    score = MESH_OPTIMIZER_LAST_TRIANGLE_SCORE;
+  }
+
+  return score + MESH_OPTIMIZER_VALENCE_BOOST_SCALE * powf(static_cast<float>(remainingTrianglesCount), -MESH_OPTIMIZER_VALENCE_BOOST_POWER);
+}
@@ -0,0 +1,37 @@
+/*!
+ *\file meshoptimizer.h
+ *\brief Contains MeshOptimizer class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "meshmodel.h"
+
+// Size of simulated LRU vertex cache
+#define MESH_OPTIMIZER_CACHE_SIZE 32
+// Score of vertices used by the last added triangle
+#define MESH_OPTIMIZER_LAST_TRIANGLE_SCORE 0.75f
+#define MESH_OPTIMIZER_CACHE_DECAY_POWER 1.5f
+// Bonus of vertices with few remaining triangles, so that they are finished early
+#define MESH_OPTIMIZER_VALENCE_BOOST_SCALE 2.f
+#define MESH_OPTIMIZER_VALENCE_BOOST_POWER 0.5f
+
+/*!
+ * Reorders indexed mesh for memory locality.
+ * Triangles are sorted with Forsyth's linear-speed vertex cache optimization, so consecutive triangles share vertices.
+ * Vertices are then renumbered in order of their first use, so they are laid out in the order triangles are traversed.
+ */
+class MeshOptimizer {
+  public:
+    void optimize(IndexedMesh &mesh) const;
+
+    // Average number of simulated cache misses per triangle, used to measure optimization
+    float calculateAverageCacheMissRatio(const IndexedMesh &mesh) const;
+
+  private:
+    void optimizeTriangleOrder(std::vector<unsigned> &indices, int verticesCount) const;
+    void optimizeVertexOrder(IndexedMesh &mesh) const;
+    float calculateVertexScore(int cachePosition, int remainingTrianglesCount) const;
+};
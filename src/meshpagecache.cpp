@@ -0,0 +1,75 @@
+/*!
+ *\file meshpagecache.cpp
+ *\brief Contains MeshPageCache class definition
+ */
+
+#include <algorithm>
+#include <QMutexLocker>
+
+#include "meshpagecache.h"
+#include "pagedmesh.h"
+
+MeshPageCache::MeshPageCache(qint64 memoryBudget)
+  : mMemoryBudget(memoryBudget),
+    mMeshesCount(0),
+    mResidentBytesCount(0),
+    mRequestsCount(0),
+    mPageInsCount(0),
+    mEvictionsCount(0),
+    mReadBytesCount(0),
+    mPeakResidentBytesCount(0) {
+}
+
+int MeshPageCache::registerMesh() {
+  QMutexLocker locker(&mMutex);
+  return mMeshesCount++;
+}
+
+IndexedMeshPointer MeshPageCache::getPage(const PagedMesh &mesh, int meshId, int pageIndex) {
+  const quint64 key = (static_cast<quint64>(meshId) << 32) | static_cast<quint32>(pageIndex);
+
+  {
+    QMutexLocker locker(&mMutex);
+    ++mRequestsCount;
+    QHash<quint64, MeshPageCacheEntry>::const_iterator entry = mEntries.constFind(key);
+    if (entry != mEntries.constEnd()) {
+      mRecentlyUsedKeys.splice(mRecentlyUsedKeys.begin(), mRecentlyUsedKeys, entry.value().position);
+      return entry.value().page;
+    }
+  }
+
+  IndexedMeshPointer page = mesh.readPage(pageIndex);
+
+  QMutexLocker locker(&mMutex);
+  QHash<quint64, MeshPageCacheEntry>::const_iterator entry = mEntries.constFind(key);
+  if (entry != mEntries.constEnd()) {
+    // Page is read by another thread meanwhile
+    return entry.value().page;
+  }
+
+  MeshPageCacheEntry newEntry;
+  newEntry.page = page;
+  newEntry.size = mesh.getPageSize(pageIndex);
+  mRecentlyUsedKeys.push_front(key);
+  newEntry.position = mRecentlyUsedKeys.begin();
+  mEntries.insert(key, newEntry);
+
+  ++mPageInsCount;
+  mReadBytesCount += mesh.getPageFileSize(pageIndex);
+  mResidentBytesCount += newEntry.size;
+  evictPages();
+  mPeakResidentBytesCount = std::max(mPeakResidentBytesCount, mResidentBytesCount);
+
+  return page;
+}
+
+void MeshPageCache::evictPages() {
+  // The most recently used page is kept even if it alone exceeds the budget
+  while (mResidentBytesCount > mMemoryBudget && mRecentlyUsedKeys.size() > 1) {
+    const quint64 key = mRecentlyUsedKeys.back();
+    mResidentBytesCount -= mEntries.value(key).size;
+    mEntries.remove(key);
+    mRecentlyUsedKeys.pop_back();
+    ++mEvictionsCount;
+  }
+}
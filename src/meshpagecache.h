@@ -0,0 +1,70 @@
+/*!
+ *\file meshpagecache.h
+ *\brief Contains MeshPageCache class declaration
+ */
+
+#pragma once
+
+#include <list>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+
+#include "meshmodel.h"
+
+class PagedMesh;
+
+class MeshPageCache;
+
+typedef QSharedPointer<MeshPageCache> MeshPageCachePointer;
+
+struct MeshPageCacheEntry {
+  IndexedMeshPointer page;
+  qint64 size;
+  // Position in list of recently used pages
+  std::list<quint64>::iterator position;
+};
+
+/*!
+ * Resident pages of all paged meshes of scene, limited by memory budget.
+ * Pages are read from their files on request, least recently used pages are evicted when the budget is exceeded.
+ * Evicted page stays alive while a thread still intersects it. Cache may be used by several threads,
+ * pages are read without holding the lock, so threads requesting resident pages are not blocked by reading.
+ */
+class MeshPageCache {
+  public:
+    explicit MeshPageCache(qint64 memoryBudget);
+    virtual ~MeshPageCache() {}
+
+    // Returns identifier of mesh used in page keys
+    int registerMesh();
+    // Returns page, reads it from mesh file if it is not resident
+    IndexedMeshPointer getPage(const PagedMesh &mesh, int meshId, int pageIndex);
+
+    qint64 getMemoryBudget() const { return mMemoryBudget; }
+    qint64 getRequestsCount() const { return mRequestsCount; }
+    qint64 getPageInsCount() const { return mPageInsCount; }
+    qint64 getEvictionsCount() const { return mEvictionsCount; }
+    qint64 getReadBytesCount() const { return mReadBytesCount; }
+    qint64 getPeakResidentBytesCount() const { return mPeakResidentBytesCount; }
+    // Fraction of page requests which caused page reading
+    float getPageInRate() const { return mRequestsCount > 0 ? static_cast<float>(mPageInsCount) / mRequestsCount : 0.f; }
+
+  private:
+    void evictPages();
+
+  private:
+    qint64 mMemoryBudget;
+    QMutex mMutex;
+    int mMeshesCount;
+    QHash<quint64, MeshPageCacheEntry> mEntries;
+    // Keys of resident pages, the most recently used first
+    std::list<quint64> mRecentlyUsedKeys;
+    qint64 mResidentBytesCount;
+
+    qint64 mRequestsCount;
+    qint64 mPageInsCount;
+    qint64 mEvictionsCount;
+    qint64 mReadBytesCount;
+    qint64 mPeakResidentBytesCount;
+};
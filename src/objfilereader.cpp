@@ -1,167 +1,202 @@
-
+#include <string.h>
 #include <vector>
 #include <QFile>
-#include <QStringList>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrentMap>
 
 #include "objfilereader.h"
 #include "mathcommons.h"
+#include "meshoptimizer.h"
+
+/*!
+ * Part of OBJ file parsed by one task.
+ */
+struct ObjChunk {
+  const char *begin;
+  const char *end;
+  ObjParser parser;
+  bool isParsed;
+  // Numbers of elements in preceding chunks
+  int positionsOffset;
+  int normalsOffset;
+  int triangleVerticesOffset;
+  ObjMeshData *meshData;
+};
+
+static void parseObjChunk(ObjChunk &chunk) {
+  chunk.isParsed = chunk.parser.parseChunk(chunk.begin, chunk.end);
+}
 
-MeshModelPointer ObjFileReader::readMeshFromObjFile(const QString &fileName, const Vector &translation, const Vector &scale, MaterialPointer material) const {
+static void copyObjChunk(ObjChunk &chunk) {
+  chunk.parser.copyChunk(chunk.positionsOffset, chunk.normalsOffset, chunk.triangleVerticesOffset, *chunk.meshData);
+}
+
+IndexedMeshPointer ObjFileReader::readMeshFromObjFile(const QString &fileName) const {
   QFile meshFile(fileName);
 
   meshFile.open(QIODevice::ReadOnly);
   if (!meshFile.isOpen()) {
     std::cerr << "Scene parsing error: Unable to open file at path '" << fileName.toUtf8().constData() << "'" << std::endl;
-    return MeshModelPointer(NULL);
+    return IndexedMeshPointer(NULL);
   }
 
-  std::vector<Vector> positions;
-  std::vector<Vector> normals;
-
-  std::vector<Vertex>	  faceVertices;
-  std::vector<int> faceVerticesIndices;
-  std::vector<int> faceIndices;
+  QElapsedTimer timer;
+  timer.start();
 
-  // Triangle vertices
-  std::vector<Vertex>	vertices;
-  // Vertex indices for triangles
-  std::vector<int> indices;
+  const qint64 fileSize = meshFile.size();
+  const char *fileContents = NULL;
+  if (fileSize > 0) {
+    fileContents = reinterpret_cast<const char *>(meshFile.map(0, fileSize));
+    if (fileContents == NULL) {
+      std::cerr << "Scene parsing error: Unable to map file at path '" << fileName.toUtf8().constData() << "'" << std::endl;
+      return IndexedMeshPointer(NULL);
+    }
+  }
 
-  // Read lines, loop will be terminated by break
-  while (true) {
-    QString line = meshFile.readLine();
-    if (meshFile.atEnd()) {
-      break;
+  ObjMeshData parallelMeshData;
+  ObjParser parser;
+  const ObjMeshData *meshData = &parallelMeshData;
+  if (!parseInParallel(fileContents, fileContents + fileSize, parallelMeshData)) {
+    // Small files are parsed serially, so are files with errors to report the first malformed line
+    if (!parser.parse(fileContents, fileContents + fileSize)) {
+      std::cerr << "Scene parsing error: malformed line " << parser.getErrorLineNumber()
+                << " in file '" << fileName.toUtf8().constData() << "'" << std::endl;
+      return IndexedMeshPointer(NULL);
     }
+    meshData = &parser.getMeshData();
+  }
 
-    if (line.contains("#")) {
-      // Skip comment line
-    } else if (line.startsWith("v ")) {
-      // Vertex line
-      Vector position = readVector(line, "v");
-      // Apply scale and translation
-      Vector modelPosition = componentwiseProduct(position, scale) + translation;
-      positions.push_back(modelPosition);
-    } else if (line.startsWith("vt ")) {
-      // Texture coordinates line
-      // Skip
-    } else if (line.startsWith("vn ")) {
-      // Normal vector line
-      Vector normal = readVector(line, "vn");
-      normals.push_back(normal);
-    } else if (line.startsWith("f ")) {
-      faceVertices.clear();
-      faceVerticesIndices.clear();
-
-      QStringList indicesDescs = readIndicesDescriptor(line, "f");
-
-      foreach (const QString& index, indicesDescs) {
-        int position, texcoord, normal;
-        Vertex v;
-
-        readIndices(index, position, normal, texcoord);
-
-        // OBJ uses 1-based arrays
-        if (!positions.empty()) {
-          v.position  = positions[position - 1];
-        }
-        if (!normals.empty()) {
-          v.normal    = normals[normal - 1];
-        }
-        // Ignore text coords
+  IndexedMeshPointer mesh = createIndexedMesh(*meshData);
 
-        faceVertices.push_back(v);
-        faceVerticesIndices.push_back(position);
-      }
-      
-      const unsigned count = faceVertices.size();
-      faceIndices.resize(count);
-      for (unsigned idx = 0; idx < count; ++idx) {
-        // Triangle strip
-        if (idx > 2) {
-          indices.push_back( faceIndices[0] );
-          indices.push_back( faceIndices[idx - 1] );
-        }
+  const double elapsedSeconds = std::max(timer.nsecsElapsed(), (qint64)1) * 1e-9;
+  const double fileSizeMegabytes = fileSize / (1024.0 * 1024.0);
+  std::cout << "Mesh '" << fileName.toUtf8().constData() << "': " << mesh->indices.size() / 3 << " triangles, " << mesh->positions.size() << " vertices, "
+            << fileSizeMegabytes << " MB read in " << elapsedSeconds * 1000 << " ms (" << fileSizeMegabytes / elapsedSeconds << " MB/s)" << std::endl;
 
-        faceIndices[idx] = vertices.size();
-        vertices.push_back(faceVertices[idx]);
-        indices.push_back(faceIndices[idx]);
-      }
-    }
+  if (mIsMeshReorderingEnabled) {
+    MeshOptimizer meshOptimizer;
+    const float initialCacheMissRatio = meshOptimizer.calculateAverageCacheMissRatio(*mesh);
+    meshOptimizer.optimize(*mesh);
+    std::cout << "Mesh '" << fileName.toUtf8().constData() << "' is reordered, average vertex cache misses per triangle " 
+              << initialCacheMissRatio << " -> " << meshOptimizer.calculateAverageCacheMissRatio(*mesh) << std::endl;
   }
 
-  std::vector<ModelTrianglePointer> triangles;
-
-  // Create triangles
-  for (int idx = 0, count = indices.size(); idx < count; idx += 3)
-  {
-    Vertex a = vertices[indices[idx]];
-    Vertex b = vertices[indices[idx + 1]];
-    Vertex c = vertices[indices[idx + 2]];
+  mesh->boundingBox = calculateBoundingBox(*mesh);
+  return mesh;
+}
 
-    triangles.push_back(ModelTrianglePointer(new ModelTriangle(a.position,  b.position, c.position, 
-                                                               a.normal,	b.normal,	c.normal,
-                                                               MaterialPointer(NULL))));  // material is owned by model
+bool ObjFileReader::parseInParallel(const char *begin, const char *end, ObjMeshData &meshData) const {
+  const qint64 size = end - begin;
+  const int chunksCount = static_cast<int>(std::min(static_cast<qint64>(QThread::idealThreadCount() * OBJ_PARALLEL_PARSING_CHUNKS_PER_THREAD), 
+                                                    size / OBJ_PARALLEL_PARSING_MIN_CHUNK_SIZE));
+  if (chunksCount < 2) {
+    return false;
   }
 
-  // Construct bounding box
-  Vector boundingBoxMin;
-  Vector boundingBoxMax;
-  for each (auto position in positions) {
-    if (position.x < boundingBoxMin.x) {
-      boundingBoxMin.x = position.x;
-    }
-    if (position.y < boundingBoxMin.y) {
-      boundingBoxMin.y = position.y;
+  // Split file into chunks of whole lines
+  std::vector<ObjChunk> chunks;
+  const char *chunkBegin = begin;
+  for (int i = 1; i <= chunksCount && chunkBegin < end; ++i) {
+    const char *chunkEnd = end;
+    if (i < chunksCount) {
+      // Chunk is extended to the end of line containing split point, it is empty if previous chunk covers this line
+      const char *splitPoint = begin + size * i / chunksCount;
+      const char *lineEnd = static_cast<const char *>(memchr(splitPoint, '\n', end - splitPoint));
+      chunkEnd = lineEnd == NULL ? end : std::max(lineEnd + 1, chunkBegin);
     }
-    if (position.z < boundingBoxMin.z) {
-      boundingBoxMin.z = position.z;
+    if (chunkEnd > chunkBegin) {
+      ObjChunk chunk;
+      chunk.begin = chunkBegin;
+      chunk.end = chunkEnd;
+      chunk.isParsed = false;
+      chunk.meshData = &meshData;
+      chunks.push_back(chunk);
     }
+    chunkBegin = chunkEnd;
+  }
 
-    if (position.x > boundingBoxMax.x) {
-      boundingBoxMax.x = position.x;
-    }
-    if (position.y > boundingBoxMax.y) {
-      boundingBoxMax.y = position.y;
-    }
-    if (position.z > boundingBoxMax.z) {
-      boundingBoxMax.z = position.z;
+  QtConcurrent::blockingMap(chunks, parseObjChunk);
+
+  // Prefix sums of element counts give chunk offsets in merged arrays
+  int positionsCount = 0;
+  int normalsCount = 0;
+  int triangleVerticesCount = 0;
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    ObjChunk &chunk = chunks[i];
+    if (!chunk.isParsed || !chunk.parser.areChunkIndicesValid(positionsCount, normalsCount)) {
+      return false;
     }
+    chunk.positionsOffset = positionsCount;
+    chunk.normalsOffset = normalsCount;
+    chunk.triangleVerticesOffset = triangleVerticesCount;
+
+    const ObjMeshData &chunkMeshData = chunk.parser.getMeshData();
+    positionsCount += chunkMeshData.positions.size();
+    normalsCount += chunkMeshData.normals.size();
+    triangleVerticesCount += chunkMeshData.triangleVertices.size();
   }
 
-  BoundingBox meshBoundingBox;
-  meshBoundingBox.min = boundingBoxMin;
-  meshBoundingBox.max = boundingBoxMax;
-  
-  return MeshModelPointer(new MeshModel(triangles, meshBoundingBox, material));
-}
+  meshData.positions.resize(positionsCount);
+  meshData.normals.resize(normalsCount);
+  meshData.triangleVertices.resize(triangleVerticesCount);
+  QtConcurrent::blockingMap(chunks, copyObjChunk);
 
-Vector ObjFileReader::readVector(QString line, const QString& prefix) const {
-  QString	string = line.remove(prefix + " ").remove("\n").remove("\r");
-  QStringList coordinates = string.split(" ", QString::SkipEmptyParts);
-  coordinates.removeAll(" ");
-  coordinates.removeAll("");
-  coordinates.removeAll("\n");
-  
-  return Vector(coordinates[0].toFloat(), coordinates[1].toFloat(), coordinates[2].toFloat());
+  return true;
 }
 
-QStringList ObjFileReader::readIndicesDescriptor(QString line, const QString& prefix) const {
-  QString			 indicesString = line.remove(prefix + " ");
-  QStringList	 descs = indicesString.split(" ");
-  return descs;
+IndexedMeshPointer ObjFileReader::createIndexedMesh(const ObjMeshData &meshData) const {
+  const std::vector<ObjFaceVertex> &triangleVertices = meshData.triangleVertices;
+  IndexedMeshPointer mesh = IndexedMeshPointer(new IndexedMesh());
+  mesh->indices.reserve(triangleVertices.size());
+
+  // Face vertices with the same position and normal indices share mesh vertex
+  QHash<quint64, unsigned> vertexIndices;
+  vertexIndices.reserve(triangleVertices.size());
+
+  for (size_t i = 0; i + 2 < triangleVertices.size(); i += 3) {
+    const ObjFaceVertex *faceVertices = &triangleVertices[i];
+
+    // Vertices without normals get geometric normal of the face and are not shared
+    Vector faceNormal;
+    if (faceVertices[0].normal < 0 || faceVertices[1].normal < 0 || faceVertices[2].normal < 0) {
+      const Vector &positionA = meshData.positions[faceVertices[0].position];
+      faceNormal = (meshData.positions[faceVertices[1].position] - positionA).crossProduct(meshData.positions[faceVertices[2].position] - positionA);
+      faceNormal.normalize();
+    }
+
+    for (int k = 0; k < 3; ++k) {
+      const ObjFaceVertex &faceVertex = faceVertices[k];
+      const unsigned newVertexIndex = mesh->positions.size();
+      if (faceVertex.normal >= 0) {
+        const quint64 key = (static_cast<quint64>(faceVertex.position) << 32) | static_cast<unsigned>(faceVertex.normal);
+        QHash<quint64, unsigned>::const_iterator vertexIndex = vertexIndices.constFind(key);
+        if (vertexIndex != vertexIndices.constEnd()) {
+          mesh->indices.push_back(vertexIndex.value());
+          continue;
+        }
+        vertexIndices.insert(key, newVertexIndex);
+      }
+
+      mesh->positions.push_back(meshData.positions[faceVertex.position]);
+      mesh->normals.push_back(faceVertex.normal >= 0 ? meshData.normals[faceVertex.normal] : faceNormal);
+      mesh->indices.push_back(newVertexIndex);
+    }
+  }
+
+  return mesh;
 }
 
-void ObjFileReader::readIndices(const QString& line, int &position, int &normal, int &textureCoordinates) const {
-  QStringList indices = line.split("/");
-  
-  position = indices[0].toUInt();
-
-  if (indices.size() > 1) {
-    textureCoordinates = indices[1].toInt();
-    normal   = indices[2].toInt();
-  } else {
-    textureCoordinates = -1;
-    normal = -1;
+BoundingBox ObjFileReader::calculateBoundingBox(const IndexedMesh &mesh) const {
+  BoundingBox boundingBox;
+  if (!mesh.positions.empty()) {
+    boundingBox.min = mesh.positions[0];
+    boundingBox.max = mesh.positions[0];
+  }
+  for each (auto position in mesh.positions) {
+    boundingBox.min = componentwiseMin(boundingBox.min, position);
+    boundingBox.max = componentwiseMax(boundingBox.max, position);
   }
+  return boundingBox;
 }
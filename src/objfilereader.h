@@ -1,18 +1,39 @@
+/*!
+ *\file objfilereader.h
+ *\brief Contains ObjFileReader class declaration
+ */
+
 #pragma once
 
 #include "types.h"
 #include "meshmodel.h"
+#include "objparser.h"
 
-struct Vertex {
-  Vector position;
-  Vector normal;
-};
+// Files smaller than two chunks of this size are parsed serially
+#define OBJ_PARALLEL_PARSING_MIN_CHUNK_SIZE (1 << 20)
+#define OBJ_PARALLEL_PARSING_CHUNKS_PER_THREAD 4
 
+/*!
+ * Reads mesh model from Wavefront OBJ file.
+ * File is memory-mapped and parsed in place by ObjParser, reading throughput is reported to standard output.
+ * Large files are split into chunks of whole lines parsed in parallel, chunks are then merged in parallel
+ * at offsets given by prefix sums of their element counts. Result is identical to serial parsing.
+ * Face vertices with equal position and normal indices are merged into one vertex of indexed mesh.
+ */
 class ObjFileReader {
   public:
-    MeshModelPointer readMeshFromObjFile(const QString &fileName, const Vector &translation, const Vector &scale, MaterialPointer material) const;
+    ObjFileReader() : mIsMeshReorderingEnabled(false) {}
+
+    // Enables reordering of mesh triangles and vertices for memory locality
+    void setMeshReorderingEnabled(bool isEnabled) { mIsMeshReorderingEnabled = isEnabled; }
+
+    // Reads mesh in its object space
+    IndexedMeshPointer readMeshFromObjFile(const QString &fileName) const;
   private:
-    Vector readVector(QString line, const QString& prefix) const;
-    QStringList readIndicesDescriptor(QString line, const QString& prefix) const;
-    void readIndices(const QString& line, int &position, int &normal, int &textureCoordinates) const;
-};
\ No newline at end of file
+    bool parseInParallel(const char *begin, const char *end, ObjMeshData &meshData) const;
+    IndexedMeshPointer createIndexedMesh(const ObjMeshData &meshData) const;
+    BoundingBox calculateBoundingBox(const IndexedMesh &mesh) const;
+
+  private:
+    bool mIsMeshReorderingEnabled;
+};
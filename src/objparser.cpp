@@ -0,0 +1,345 @@
+/*!
+ *\file objparser.cpp
+ *\brief Contains ObjParser class definition
+ */
+
+#include <limits.h>
+#include <math.h>
+#include <algorithm>
+
+#include "objparser.h"
+
+#define MAX_EXACT_POWER_OF_TEN 22
+#define MAX_MANTISSA_DIGITS_COUNT 19
+// Integers with more significant digits are rejected, so that they can not overflow int
+#define MAX_INTEGER_DIGITS_COUNT 9
+
+// Flags of face vertex indices given relative to the end of elements read so far
+#define RELATIVE_POSITION_INDEX 1
+#define RELATIVE_NORMAL_INDEX 2
+
+static const double powersOfTen[MAX_EXACT_POWER_OF_TEN + 1] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+ObjParser::ObjParser()
+  : mErrorLineNumber(0),
+    mIsChunkParsed(false),
+    mMaxPositionIndexExcess(INT_MIN),
+    mMaxNormalIndexExcess(INT_MIN),
+    mMinRelativePositionIndex(INT_MAX),
+    mMinRelativeNormalIndex(INT_MAX) {
+}
+
+ObjParser::~ObjParser() {
+}
+
+bool ObjParser::parse(const char *begin, const char *end) {
+  const char *cursor = begin;
+  int lineNumber = 1;
+
+  while (cursor < end) {
+    cursor = skipSpaces(cursor, end);
+
+    bool isLineValid = true;
+    bool isStatementParsed = true;
+    if (cursor + 1 < end && cursor[0] == 'v' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+      // Vertex line
+      cursor += 2;
+      Vector position;
+      isLineValid = parseVector(cursor, end, position);
+      mMeshData.positions.push_back(position);
+    } else if (cursor + 2 < end && cursor[0] == 'v' && cursor[1] == 'n' && (cursor[2] == ' ' || cursor[2] == '\t')) {
+      // Normal vector line
+      cursor += 3;
+      Vector normal;
+      isLineValid = parseVector(cursor, end, normal);
+      mMeshData.normals.push_back(normal);
+    } else if (cursor + 1 < end && cursor[0] == 'f' && (cursor[1] == ' ' || cursor[1] == '\t')) {
+      // Face line
+      cursor += 2;
+      isLineValid = parseFace(cursor, end);
+    } else {
+      // Comments, texture coordinates, groups and other statements are skipped
+      isStatementParsed = false;
+    }
+
+    // Parsed statement should not be followed by anything but comment
+    if (isLineValid && isStatementParsed) {
+      isLineValid = isLineEnd(skipSpaces(cursor, end), end);
+    }
+    if (!isLineValid) {
+      mErrorLineNumber = lineNumber;
+      return false;
+    }
+
+    cursor = skipLine(cursor, end);
+    ++lineNumber;
+  }
+
+  return true;
+}
+
+bool ObjParser::parseChunk(const char *begin, const char *end) {
+  mIsChunkParsed = true;
+  return parse(begin, end);
+}
+
+bool ObjParser::areChunkIndicesValid(int positionsOffset, int normalsOffset) const {
+  // Absolute indices should not refer to elements defined after them and relative ones should not go before the first element
+  return mMaxPositionIndexExcess < positionsOffset && mMaxNormalIndexExcess < normalsOffset &&
+         (mMinRelativePositionIndex == INT_MAX || mMinRelativePositionIndex + positionsOffset >= 0) &&
+         (mMinRelativeNormalIndex == INT_MAX || mMinRelativeNormalIndex + normalsOffset >= 0);
+}
+
+void ObjParser::copyChunk(int positionsOffset, int normalsOffset, int triangleVerticesOffset, ObjMeshData &meshData) const {
+  std::copy(mMeshData.positions.begin(), mMeshData.positions.end(), meshData.positions.begin() + positionsOffset);
+  std::copy(mMeshData.normals.begin(), mMeshData.normals.end(), meshData.normals.begin() + normalsOffset);
+
+  std::vector<ObjFaceVertex>::iterator triangleVertices = meshData.triangleVertices.begin() + triangleVerticesOffset;
+  std::copy(mMeshData.triangleVertices.begin(), mMeshData.triangleVertices.end(), triangleVertices);
+  for (size_t i = 0; i < mRelativePositionCorners.size(); ++i) {
+    triangleVertices[mRelativePositionCorners[i]].position += positionsOffset;
+  }
+  for (size_t i = 0; i < mRelativeNormalCorners.size(); ++i) {
+    triangleVertices[mRelativeNormalCorners[i]].normal += normalsOffset;
+  }
+}
+
+const ObjMeshData &ObjParser::getMeshData() const {
+  return mMeshData;
+}
+
+int ObjParser::getErrorLineNumber() const {
+  return mErrorLineNumber;
+}
+
+bool ObjParser::parseVector(const char *&cursor, const char *end, Vector &vector) const {
+  float x, y, z;
+  if (!parseFloat(cursor, end, x) || !parseFloat(cursor, end, y) || !parseFloat(cursor, end, z)) {
+    return false;
+  }
+  vector = Vector(x, y, z);
+
+  // Optional w component is ignored
+  cursor = skipSpaces(cursor, end);
+  if (!isLineEnd(cursor, end)) {
+    float w;
+    return parseFloat(cursor, end, w);
+  }
+  return true;
+}
+
+bool ObjParser::parseFace(const char *&cursor, const char *end) {
+  // Polygon is triangulated as fan around its first vertex
+  ObjFaceVertex firstVertex;
+  ObjFaceVertex previousVertex;
+  int firstVertexRelativeIndicesMask = 0;
+  int previousVertexRelativeIndicesMask = 0;
+  int verticesCount = 0;
+
+  while (true) {
+    cursor = skipSpaces(cursor, end);
+    if (isLineEnd(cursor, end)) {
+      break;
+    }
+
+    ObjFaceVertex vertex;
+    int relativeIndicesMask = 0;
+    if (!parseFaceVertex(cursor, end, vertex, relativeIndicesMask)) {
+      return false;
+    }
+
+    if (verticesCount == 0) {
+      firstVertex = vertex;
+      firstVertexRelativeIndicesMask = relativeIndicesMask;
+    } else if (verticesCount >= 2) {
+      addTriangleVertex(firstVertex, firstVertexRelativeIndicesMask);
+      addTriangleVertex(previousVertex, previousVertexRelativeIndicesMask);
+      addTriangleVertex(vertex, relativeIndicesMask);
+    }
+    previousVertex = vertex;
+    previousVertexRelativeIndicesMask = relativeIndicesMask;
+    ++verticesCount;
+  }
+
+  return verticesCount >= 3;
+}
+
+bool ObjParser::parseFaceVertex(const char *&cursor, const char *end, ObjFaceVertex &faceVertex, int &relativeIndicesMask) {
+  // Vertex is one of v, v/vt, v//vn or v/vt/vn
+  int index;
+  if (!parseInt(cursor, end, index) || 
+      !resolveIndex(index, mMeshData.positions.size(), faceVertex.position, mMaxPositionIndexExcess, mMinRelativePositionIndex)) {
+    return false;
+  }
+  if (index < 0) {
+    relativeIndicesMask |= RELATIVE_POSITION_INDEX;
+  }
+  faceVertex.normal = -1;
+
+  if (cursor == end || *cursor != '/') {
+    return true;
+  }
+  ++cursor;
+  if (cursor != end && *cursor != '/') {
+    // Texture coordinates index is not used
+    if (!parseInt(cursor, end, index)) {
+      return false;
+    }
+  }
+
+  if (cursor == end || *cursor != '/') {
+    return true;
+  }
+  ++cursor;
+  if (!parseInt(cursor, end, index) ||
+      !resolveIndex(index, mMeshData.normals.size(), faceVertex.normal, mMaxNormalIndexExcess, mMinRelativeNormalIndex)) {
+    return false;
+  }
+  if (index < 0) {
+    relativeIndicesMask |= RELATIVE_NORMAL_INDEX;
+  }
+  return true;
+}
+
+bool ObjParser::resolveIndex(int index, int count, int &resolvedIndex, int &maxIndexExcess, int &minRelativeIndex) {
+  // OBJ uses 1-based indices, negative indices are relative to the end of elements read so far
+  resolvedIndex = index > 0 ? index - 1 : count + index;
+  if (index == 0) {
+    return false;
+  }
+  if (!mIsChunkParsed) {
+    return resolvedIndex >= 0 && resolvedIndex < count;
+  }
+
+  // Chunk does not know how many elements precede it, indices are checked by areChunkIndicesValid
+  if (index > 0) {
+    maxIndexExcess = std::max(maxIndexExcess, resolvedIndex - count);
+  } else {
+    minRelativeIndex = std::min(minRelativeIndex, resolvedIndex);
+  }
+  return true;
+}
+
+void ObjParser::addTriangleVertex(const ObjFaceVertex &faceVertex, int relativeIndicesMask) {
+  if (relativeIndicesMask & RELATIVE_POSITION_INDEX) {
+    mRelativePositionCorners.push_back(mMeshData.triangleVertices.size());
+  }
+  if (relativeIndicesMask & RELATIVE_NORMAL_INDEX) {
+    mRelativeNormalCorners.push_back(mMeshData.triangleVertices.size());
+  }
+  mMeshData.triangleVertices.push_back(faceVertex);
+}
+
+bool ObjParser::parseFloat(const char *&cursor, const char *end, float &value) {
+  const char *current = skipSpaces(cursor, end);
+
+  bool isNegative = false;
+  if (current != end && (*current == '-' || *current == '+')) {
+    isNegative = *current == '-';
+    ++current;
+  }
+
+  // Decimal digits are accumulated in integer mantissa, digits beyond its precision only shift exponent
+  unsigned long long mantissa = 0;
+  int mantissaDigitsCount = 0;
+  int exponent = 0;
+  bool hasDigits = false;
+
+  for (; current != end && *current >= '0' && *current <= '9'; ++current) {
+    hasDigits = true;
+    if (mantissaDigitsCount < MAX_MANTISSA_DIGITS_COUNT) {
+      mantissa = mantissa * 10 + (*current - '0');
+      if (mantissa != 0) {
+        ++mantissaDigitsCount;
+      }
+    } else {
+      ++exponent;
+    }
+  }
+  if (current != end && *current == '.') {
+    ++current;
+    for (; current != end && *current >= '0' && *current <= '9'; ++current) {
+      hasDigits = true;
+      if (mantissaDigitsCount < MAX_MANTISSA_DIGITS_COUNT) {
+        mantissa = mantissa * 10 + (*current - '0');
+        if (mantissa != 0) {
+          ++mantissaDigitsCount;
+        }
+        --exponent;
+      }
+    }
+  }
+  if (!hasDigits) {
+    return false;
+  }
+
+  if (current != end && (*current == 'e' || *current == 'E')) {
+    ++current;
+    int exponentValue;
+    if (!parseInt(current, end, exponentValue)) {
+      return false;
+    }
+    exponent += exponentValue;
+  }
+
+  // Mantissa and power of ten are exact in double for usual mesh data, so result is rounded once
+  double result = (double)mantissa;
+  if (exponent < 0) {
+    result = -exponent <= MAX_EXACT_POWER_OF_TEN ? result / powersOfTen[-exponent] : result * pow(10.0, exponent);
+  } else if (exponent > 0) {
+    result = exponent <= MAX_EXACT_POWER_OF_TEN ? result * powersOfTen[exponent] : result * pow(10.0, exponent);
+  }
+  value = (float)(isNegative ? -result : result);
+
+  cursor = current;
+  return true;
+}
+
+bool ObjParser::parseInt(const char *&cursor, const char *end, int &value) {
+  const char *current = cursor;
+
+  bool isNegative = false;
+  if (current != end && (*current == '-' || *current == '+')) {
+    isNegative = *current == '-';
+    ++current;
+  }
+
+  const char *digitsBegin = current;
+  int result = 0;
+  int digitsCount = 0;
+  for (; current != end && *current >= '0' && *current <= '9'; ++current) {
+    // Leading zeros are not counted
+    if ((result != 0 || *current != '0') && ++digitsCount > MAX_INTEGER_DIGITS_COUNT) {
+      return false;
+    }
+    result = result * 10 + (*current - '0');
+  }
+  if (current == digitsBegin) {
+    return false;
+  }
+
+  value = isNegative ? -result : result;
+  cursor = current;
+  return true;
+}
+
+const char *ObjParser::skipSpaces(const char *cursor, const char *end) {
+  while (cursor != end && (*cursor == ' ' || *cursor == '\t')) {
+    ++cursor;
+  }
+  return cursor;
+}
+
+const char *ObjParser::skipLine(const char *cursor, const char *end) {
+  while (cursor != end && *cursor != '\n') {
+    ++cursor;
+  }
+  return cursor == end ? end : cursor + 1;
+}
+
+bool ObjParser::isLineEnd(const char *cursor, const char *end) {
+  return cursor == end || *cursor == '\n' || *cursor == '\r' || *cursor == '#';
+}
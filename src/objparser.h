@@ -0,0 +1,85 @@
+/*!
+ *\file objparser.h
+ *\brief Contains ObjParser class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "types.h"
+
+/*!
+ * Triangle corner of parsed OBJ face.
+ * Indices are zero-based, normal index is negative if face vertex has no normal.
+ */
+struct ObjFaceVertex {
+  int position;
+  int normal;
+};
+
+/*!
+ * Elements of parsed OBJ file.
+ */
+struct ObjMeshData {
+  std::vector<Vector> positions;
+  std::vector<Vector> normals;
+  // Three vertices per triangle
+  std::vector<ObjFaceVertex> triangleVertices;
+};
+
+/*!
+ * Wavefront OBJ parser working over raw bytes of file contents (typically memory-mapped).
+ * Numbers are parsed in place without creating strings, the only allocations are growth of output arrays.
+ * Supports v, vn and f statements, faces may be triangles, quads or n-gons (fan-triangulated),
+ * have negative (relative) indices and omit texture coordinates and normals. Other statements are skipped.
+ * File can also be split into chunks of whole lines parsed independently, relative indices of chunk
+ * are resolved when it is copied to mesh data after numbers of elements in preceding chunks are known.
+ */
+class ObjParser {
+  public:
+    ObjParser();
+    ~ObjParser();
+
+    // Parses text in range [begin, end), returns false on malformed line
+    bool parse(const char *begin, const char *end);
+    // Parses chunk of text made of whole lines, indices are checked and resolved by chunk methods below
+    bool parseChunk(const char *begin, const char *end);
+    // Checks that chunk indices refer to elements defined before them, offsets are numbers of elements in preceding chunks
+    bool areChunkIndicesValid(int positionsOffset, int normalsOffset) const;
+    // Copies chunk elements to mesh data at given offsets and resolves relative indices
+    void copyChunk(int positionsOffset, int normalsOffset, int triangleVerticesOffset, ObjMeshData &meshData) const;
+
+    const ObjMeshData &getMeshData() const;
+    // One-based number of malformed line, zero if parsing succeeded
+    int getErrorLineNumber() const;
+
+  private:
+    bool parseVector(const char *&cursor, const char *end, Vector &vector) const;
+    bool parseFace(const char *&cursor, const char *end);
+    bool parseFaceVertex(const char *&cursor, const char *end, ObjFaceVertex &faceVertex, int &relativeIndicesMask);
+    bool resolveIndex(int index, int count, int &resolvedIndex, int &maxIndexExcess, int &minRelativeIndex);
+    void addTriangleVertex(const ObjFaceVertex &faceVertex, int relativeIndicesMask);
+
+    static bool parseFloat(const char *&cursor, const char *end, float &value);
+    static bool parseInt(const char *&cursor, const char *end, int &value);
+    static const char *skipSpaces(const char *cursor, const char *end);
+    static const char *skipLine(const char *cursor, const char *end);
+    static bool isLineEnd(const char *cursor, const char *end);
+
+  private:
+    ObjMeshData mMeshData;
+    int mErrorLineNumber;
+
+    // Chunk is parsed, relative indices are counted from its beginning and range checks are postponed
+    bool mIsChunkParsed;
+    // Triangle vertices having relative position and normal indices
+    std::vector<int> mRelativePositionCorners;
+    std::vector<int> mRelativeNormalCorners;
+    // Largest amount by which absolute index exceeds number of chunk elements read before it
+    int mMaxPositionIndexExcess;
+    int mMaxNormalIndexExcess;
+    // Smallest relative index counted from chunk beginning
+    int mMinRelativePositionIndex;
+    int mMinRelativeNormalIndex;
+};
@@ -0,0 +1,350 @@
+/*!
+ *\file pagedmesh.cpp
+ *\brief Contains PagedMesh class definition
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string.h>
+#include <QMutexLocker>
+
+#include "pagedmesh.h"
+#include "mathcommons.h"
+
+struct TriangleRange {
+  TriangleRange(int rangeBegin, int rangeEnd) : begin(rangeBegin), end(rangeEnd) {}
+
+  int begin;
+  int end;
+};
+
+// Compares triangles by centroid coordinate along axis
+struct TriangleCentroidComparator {
+  TriangleCentroidComparator(const std::vector<Vector> &triangleCentroids, int splitAxis) : centroids(triangleCentroids), axis(splitAxis) {}
+
+  bool operator()(int first, int second) const {
+    return (&centroids[first].x)[axis] < (&centroids[second].x)[axis];
+  }
+
+  const std::vector<Vector> &centroids;
+  int axis;
+};
+
+static void writeBoundingBox(const BoundingBox &boundingBox, float *values) {
+  const float boundingBoxValues[6] = { boundingBox.min.x, boundingBox.min.y, boundingBox.min.z, boundingBox.max.x, boundingBox.max.y, boundingBox.max.z };
+  memcpy(values, boundingBoxValues, sizeof(boundingBoxValues));
+}
+
+static BoundingBox readBoundingBox(const float *values) {
+  return BoundingBox(Vector(values[0], values[1], values[2]), Vector(values[3], values[4], values[5]));
+}
+
+// Splits range of triangles into pages of at most PAGED_MESH_PAGE_MAX_TRIANGLES_COUNT triangles by median of centroids 
+// along the longest axis, appends nodes of the split tree in depth-first order. Node bounds are set when pages are written
+static void buildPageTree(const std::vector<Vector> &centroids, std::vector<int> &triangles, const TriangleRange &range, 
+                          std::vector<TriangleRange> &pages, std::vector<PagedMeshNode> &nodes) {
+  const int nodeIndex = nodes.size();
+  nodes.push_back(PagedMeshNode());
+  memset(&nodes.back(), 0, sizeof(PagedMeshNode));
+
+  if (range.end - range.begin <= PAGED_MESH_PAGE_MAX_TRIANGLES_COUNT) {
+    nodes[nodeIndex].pageIndex = pages.size();
+    pages.push_back(range);
+    return;
+  }
+
+  Vector minCentroid = centroids[triangles[range.begin]];
+  Vector maxCentroid = minCentroid;
+  for (int i = range.begin + 1; i < range.end; ++i) {
+    minCentroid = componentwiseMin(minCentroid, centroids[triangles[i]]);
+    maxCentroid = componentwiseMax(maxCentroid, centroids[triangles[i]]);
+  }
+  const Vector extent = maxCentroid - minCentroid;
+  const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+  const int middle = (range.begin + range.end) / 2;
+  std::nth_element(triangles.begin() + range.begin, triangles.begin() + middle, triangles.begin() + range.end, TriangleCentroidComparator(centroids, axis));
+
+  nodes[nodeIndex].pageIndex = -1;
+  buildPageTree(centroids, triangles, TriangleRange(range.begin, middle), pages, nodes);
+  nodes[nodeIndex].rightChildIndex = nodes.size();
+  buildPageTree(centroids, triangles, TriangleRange(middle, range.end), pages, nodes);
+}
+
+PagedMesh::PagedMesh(MeshPageCachePointer pageCache)
+  : mPageCache(pageCache),
+    mMeshId(pageCache->registerMesh()) {
+}
+
+bool PagedMesh::writePageFile(const IndexedMesh &mesh, const QString &filePath) {
+  const int trianglesCount = mesh.indices.size() / 3;
+  std::vector<Vector> centroids(trianglesCount);
+  std::vector<int> triangles(trianglesCount);
+  for (int triangle = 0; triangle < trianglesCount; ++triangle) {
+    const unsigned *triangleVertices = &mesh.indices[triangle * 3];
+    centroids[triangle] = (mesh.positions[triangleVertices[0]] + mesh.positions[triangleVertices[1]] + mesh.positions[triangleVertices[2]]) * (1.f / 3.f);
+    triangles[triangle] = triangle;
+  }
+  std::vector<TriangleRange> pageRanges;
+  std::vector<PagedMeshNode> nodes;
+  if (trianglesCount > 0) {
+    buildPageTree(centroids, triangles, TriangleRange(0, trianglesCount), pageRanges, nodes);
+  }
+
+  // File is written under temporary name and renamed when complete, so a partially written file is never taken for a page file
+  const QString temporaryFilePath = filePath + PAGED_MESH_TEMPORARY_FILE_SUFFIX;
+  QFile pageFile(temporaryFilePath);
+  if (!pageFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    std::cerr << "Unable to open file at path '" << temporaryFilePath.toUtf8().constData() << "' for writing" << std::endl;
+    return false;
+  }
+
+  PagedMeshFileHeader header;
+  memset(&header, 0, sizeof(header));
+  strcpy(header.magic, PAGED_MESH_FILE_MAGIC);
+  header.version = PAGED_MESH_FILE_VERSION;
+  header.pagesCount = pageRanges.size();
+  header.nodesCount = nodes.size();
+  writeBoundingBox(mesh.boundingBox, header.boundingBox);
+
+  // Page and node tables are written after pages, when page offsets and bounds are known
+  std::vector<PagedMeshPageInfo> pages(pageRanges.size());
+  const qint64 tableOffset = sizeof(header);
+  const qint64 tablesSize = pages.size() * sizeof(PagedMeshPageInfo) + nodes.size() * sizeof(PagedMeshNode);
+  bool isWritten = pageFile.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header) &&
+                   pageFile.seek(tableOffset + tablesSize);
+
+  std::vector<int> localVertexIndices(mesh.positions.size(), -1);
+  std::vector<unsigned> pageVertices;
+  std::vector<float> pageData;
+  qint64 offset = tableOffset + tablesSize;
+
+  for (size_t page = 0; page < pageRanges.size() && isWritten; ++page) {
+    std::vector<unsigned> pageIndices;
+    for (int i = pageRanges[page].begin; i < pageRanges[page].end; ++i) {
+      for (int k = 0; k < 3; ++k) {
+        const unsigned vertex = mesh.indices[triangles[i] * 3 + k];
+        if (localVertexIndices[vertex] < 0) {
+          localVertexIndices[vertex] = pageVertices.size();
+          pageVertices.push_back(vertex);
+        }
+        pageIndices.push_back(localVertexIndices[vertex]);
+      }
+    }
+
+    BoundingBox pageBoundingBox(mesh.positions[pageVertices[0]], mesh.positions[pageVertices[0]]);
+    pageData.clear();
+    for (size_t i = 0; i < pageVertices.size(); ++i) {
+      const Vector &position = mesh.positions[pageVertices[i]];
+      pageBoundingBox.min = componentwiseMin(pageBoundingBox.min, position);
+      pageBoundingBox.max = componentwiseMax(pageBoundingBox.max, position);
+      pageData.push_back(position.x);
+      pageData.push_back(position.y);
+      pageData.push_back(position.z);
+    }
+    for (size_t i = 0; i < pageVertices.size(); ++i) {
+      const Vector &normal = mesh.normals[pageVertices[i]];
+      pageData.push_back(normal.x);
+      pageData.push_back(normal.y);
+      pageData.push_back(normal.z);
+      localVertexIndices[pageVertices[i]] = -1;
+    }
+
+    pages[page].offset = offset;
+    pages[page].verticesCount = pageVertices.size();
+    pages[page].trianglesCount = pageIndices.size() / 3;
+    writeBoundingBox(pageBoundingBox, pages[page].boundingBox);
+    pageVertices.clear();
+
+    const qint64 verticesDataSize = pageData.size() * sizeof(float);
+    const qint64 indicesDataSize = pageIndices.size() * sizeof(unsigned);
+    isWritten = pageFile.write(reinterpret_cast<const char *>(&pageData[0]), verticesDataSize) == verticesDataSize &&
+                pageFile.write(reinterpret_cast<const char *>(&pageIndices[0]), indicesDataSize) == indicesDataSize;
+    offset += verticesDataSize + indicesDataSize;
+  }
+
+  // Children follow their parent, so node bounds are merged from the last node to the root
+  for (int node = static_cast<int>(nodes.size()) - 1; node >= 0; --node) {
+    if (nodes[node].pageIndex >= 0) {
+      memcpy(nodes[node].boundingBox, pages[nodes[node].pageIndex].boundingBox, sizeof(nodes[node].boundingBox));
+    } else {
+      const BoundingBox leftBoundingBox = readBoundingBox(nodes[node + 1].boundingBox);
+      const BoundingBox rightBoundingBox = readBoundingBox(nodes[nodes[node].rightChildIndex].boundingBox);
+      writeBoundingBox(BoundingBox(componentwiseMin(leftBoundingBox.min, rightBoundingBox.min), 
+                                   componentwiseMax(leftBoundingBox.max, rightBoundingBox.max)), nodes[node].boundingBox);
+    }
+  }
+
+  if (isWritten && !pages.empty()) {
+    const qint64 pagesTableSize = pages.size() * sizeof(PagedMeshPageInfo);
+    const qint64 nodesTableSize = nodes.size() * sizeof(PagedMeshNode);
+    isWritten = pageFile.seek(tableOffset) && 
+                pageFile.write(reinterpret_cast<const char *>(&pages[0]), pagesTableSize) == pagesTableSize &&
+                pageFile.write(reinterpret_cast<const char *>(&nodes[0]), nodesTableSize) == nodesTableSize;
+  }
+  if (!isWritten) {
+    std::cerr << "Unable to write mesh pages to file at path '" << temporaryFilePath.toUtf8().constData() << "'" << std::endl;
+    pageFile.remove();
+    return false;
+  }
+
+  pageFile.close();
+  // Rename does not overwrite existing file
+  if (QFile::exists(filePath) && !QFile::remove(filePath)) {
+    std::cerr << "Unable to replace file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+    QFile::remove(temporaryFilePath);
+    return false;
+  }
+  if (!QFile::rename(temporaryFilePath, filePath)) {
+    std::cerr << "Unable to rename file '" << temporaryFilePath.toUtf8().constData() << "' to '" << filePath.toUtf8().constData() << "'" << std::endl;
+    QFile::remove(temporaryFilePath);
+    return false;
+  }
+
+  std::cout << "Mesh page file '" << filePath.toUtf8().constData() << "': " << trianglesCount << " triangles in " << pages.size() << " pages" << std::endl;
+  return true;
+}
+
+bool PagedMesh::open(const QString &filePath) {
+  mFile.setFileName(filePath);
+  if (!mFile.open(QIODevice::ReadOnly)) {
+    std::cerr << "Unable to open file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+
+  PagedMeshFileHeader header;
+  if (mFile.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header) ||
+      memcmp(header.magic, PAGED_MESH_FILE_MAGIC, sizeof(PAGED_MESH_FILE_MAGIC)) != 0 ||
+      header.version != PAGED_MESH_FILE_VERSION) {
+    std::cerr << "Mesh page file '" << filePath.toUtf8().constData() << "' is not a page file of version " << PAGED_MESH_FILE_VERSION << std::endl;
+    return false;
+  }
+
+  // Tables are checked against file size before they are allocated
+  const quint64 fileSize = mFile.size();
+  const quint64 dataOffset = sizeof(header) + static_cast<quint64>(header.pagesCount) * sizeof(PagedMeshPageInfo) + 
+                             static_cast<quint64>(header.nodesCount) * sizeof(PagedMeshNode);
+  if (dataOffset > fileSize) {
+    std::cerr << "Mesh page file '" << filePath.toUtf8().constData() << "' is truncated" << std::endl;
+    return false;
+  }
+
+  mBoundingBox = readBoundingBox(header.boundingBox);
+  mPages.resize(header.pagesCount);
+  const qint64 tableSize = mPages.size() * sizeof(PagedMeshPageInfo);
+  if (!mPages.empty() && mFile.read(reinterpret_cast<char *>(&mPages[0]), tableSize) != tableSize) {
+    std::cerr << "Mesh page file '" << filePath.toUtf8().constData() << "' is truncated" << std::endl;
+    return false;
+  }
+
+  mNodes.resize(header.nodesCount);
+  const qint64 nodesTableSize = mNodes.size() * sizeof(PagedMeshNode);
+  if (!mNodes.empty() && mFile.read(reinterpret_cast<char *>(&mNodes[0]), nodesTableSize) != nodesTableSize) {
+    std::cerr << "Mesh page file '" << filePath.toUtf8().constData() << "' is truncated" << std::endl;
+    return false;
+  }
+  for (size_t page = 0; page < mPages.size(); ++page) {
+    // Pages are never empty, so reading of a valid page never gets empty buffers
+    if (mPages[page].trianglesCount == 0 || mPages[page].trianglesCount > PAGED_MESH_PAGE_MAX_TRIANGLES_COUNT ||
+        mPages[page].verticesCount == 0 || mPages[page].verticesCount > mPages[page].trianglesCount * 3 || mPages[page].offset < dataOffset ||
+        mPages[page].offset > fileSize || static_cast<quint64>(getPageFileSize(page)) > fileSize - mPages[page].offset) {
+      std::cerr << "Mesh page file '" << filePath.toUtf8().constData() << "' has corrupted page " << page << std::endl;
+      return false;
+    }
+  }
+  if (!isTreeValid()) {
+    std::cerr << "Mesh page file '" << filePath.toUtf8().constData() << "' has corrupted page tree" << std::endl;
+    return false;
+  }
+
+  mPageBoundingBoxes.resize(mPages.size());
+  for (size_t page = 0; page < mPages.size(); ++page) {
+    mPageBoundingBoxes[page] = readBoundingBox(mPages[page].boundingBox);
+  }
+  mNodeBoundingBoxes.resize(mNodes.size());
+  for (size_t node = 0; node < mNodes.size(); ++node) {
+    mNodeBoundingBoxes[node] = readBoundingBox(mNodes[node].boundingBox);
+  }
+  return true;
+}
+
+/*
+* private:
+*/
+bool PagedMesh::isTreeValid() const {
+  // Tree of pages has pages count - 1 inner nodes
+  if (mNodes.size() != (mPages.empty() ? 0 : mPages.size() * 2 - 1)) {
+    return false;
+  }
+
+  // Children follow their parents, so depths are known when nodes are reached
+  std::vector<int> depths(mNodes.size(), 0);
+  for (size_t node = 0; node < mNodes.size(); ++node) {
+    if (depths[node] >= PAGED_MESH_MAX_TREE_DEPTH) {
+      return false;
+    }
+    const qint32 pageIndex = mNodes[node].pageIndex;
+    if (pageIndex >= 0) {
+      if (pageIndex >= static_cast<qint32>(mPages.size())) {
+        return false;
+      }
+      continue;
+    }
+
+    const quint32 rightChildIndex = mNodes[node].rightChildIndex;
+    if (pageIndex != -1 || rightChildIndex <= node + 1 || rightChildIndex >= mNodes.size()) {
+      return false;
+    }
+    depths[node + 1] = std::max(depths[node + 1], depths[node] + 1);
+    depths[rightChildIndex] = std::max(depths[rightChildIndex], depths[node] + 1);
+  }
+  return true;
+}
+
+IndexedMeshPointer PagedMesh::readPage(int pageIndex) const {
+  const PagedMeshPageInfo &pageInfo = mPages[pageIndex];
+  const int verticesCount = pageInfo.verticesCount;
+  const int indicesCount = pageInfo.trianglesCount * 3;
+  std::vector<float> verticesData(verticesCount * 6);
+  IndexedMeshPointer page = IndexedMeshPointer(new IndexedMesh());
+  page->indices.resize(indicesCount);
+
+  {
+    QMutexLocker locker(&mFileMutex);
+    const qint64 verticesDataSize = verticesData.size() * sizeof(float);
+    const qint64 indicesDataSize = indicesCount * sizeof(unsigned);
+    if (!mFile.seek(pageInfo.offset) ||
+        mFile.read(reinterpret_cast<char *>(&verticesData[0]), verticesDataSize) != verticesDataSize ||
+        mFile.read(reinterpret_cast<char *>(&page->indices[0]), indicesDataSize) != indicesDataSize) {
+      std::cerr << "Unable to read page " << pageIndex << " of mesh page file '" << mFile.fileName().toUtf8().constData() << "', page is not rendered" << std::endl;
+      return IndexedMeshPointer(new IndexedMesh());
+    }
+  }
+  for (int i = 0; i < indicesCount; ++i) {
+    if (page->indices[i] >= static_cast<unsigned>(verticesCount)) {
+      std::cerr << "Page " << pageIndex << " of mesh page file '" << mFile.fileName().toUtf8().constData() << "' is corrupted, page is not rendered" << std::endl;
+      return IndexedMeshPointer(new IndexedMesh());
+    }
+  }
+
+  page->positions.resize(verticesCount);
+  page->normals.resize(verticesCount);
+  const float *normalsData = &verticesData[verticesCount * 3];
+  for (int i = 0; i < verticesCount; ++i) {
+    page->positions[i] = Vector(verticesData[i * 3], verticesData[i * 3 + 1], verticesData[i * 3 + 2]);
+    page->normals[i] = Vector(normalsData[i * 3], normalsData[i * 3 + 1], normalsData[i * 3 + 2]);
+  }
+  page->boundingBox = mPageBoundingBoxes[pageIndex];
+
+  return page;
+}
+
+qint64 PagedMesh::getPageSize(int pageIndex) const {
+  const PagedMeshPageInfo &pageInfo = mPages[pageIndex];
+  return sizeof(IndexedMesh) + static_cast<qint64>(pageInfo.verticesCount) * 2 * sizeof(Vector) + static_cast<qint64>(pageInfo.trianglesCount) * 3 * sizeof(unsigned);
+}
+
+qint64 PagedMesh::getPageFileSize(int pageIndex) const {
+  const PagedMeshPageInfo &pageInfo = mPages[pageIndex];
+  return static_cast<qint64>(pageInfo.verticesCount) * 6 * sizeof(float) + static_cast<qint64>(pageInfo.trianglesCount) * 3 * sizeof(unsigned);
+}
@@ -0,0 +1,109 @@
+/*!
+ *\file pagedmesh.h
+ *\brief Contains PagedMesh class declaration
+ */
+
+#pragma once
+
+#include <vector>
+#include <QFile>
+#include <QMutex>
+#include <QString>
+
+#include "meshmodel.h"
+#include "meshpagecache.h"
+
+#define PAGED_MESH_FILE_MAGIC "RTPAGES"
+// Should be incremented whenever file layout changes
+#define PAGED_MESH_FILE_VERSION 2
+// Page file is written next to OBJ file with this suffix appended
+#define PAGED_MESH_FILE_SUFFIX ".pages"
+#define PAGED_MESH_TEMPORARY_FILE_SUFFIX ".tmp"
+#define PAGED_MESH_PAGE_MAX_TRIANGLES_COUNT 4096
+// Median splits halve triangles, so the depth is far below this limit, deeper trees in corrupted files are rejected
+#define PAGED_MESH_MAX_TREE_DEPTH 64
+
+/*!
+ * Header of page file, followed by table of pages, table of tree nodes and by pages data.
+ */
+struct PagedMeshFileHeader {
+  char magic[8];
+  quint32 version;
+  quint32 pagesCount;
+  quint32 nodesCount;
+  float boundingBox[6];
+};
+
+/*!
+ * Entry of page table. Page data are vertex positions and normals as three floats each, followed by three vertex indices per triangle.
+ */
+struct PagedMeshPageInfo {
+  quint64 offset;
+  quint32 verticesCount;
+  quint32 trianglesCount;
+  float boundingBox[6];
+};
+
+/*!
+ * Node of tree of median splits stored in depth-first order, so the left child of inner node follows it.
+ * Leaf node refers to one page.
+ */
+struct PagedMeshNode {
+  float boundingBox[6];
+  // Page of leaf node, -1 for inner node
+  qint32 pageIndex;
+  quint32 rightChildIndex;
+};
+
+class PagedMesh;
+
+typedef QSharedPointer<PagedMesh> PagedMeshPointer;
+
+/*!
+ * Mesh stored in page file and read page by page on request.
+ * Triangles are split into pages of spatially close triangles by median splits along the longest axis,
+ * each page is a small indexed mesh with its own vertices. The tree of splits with node bounds is stored in the file,
+ * so rays find hit pages by walking it from the root. Only the tree and page table are kept in memory,
+ * pages are kept by page cache shared by meshes of scene within its memory budget.
+ */
+class PagedMesh {
+  public:
+    explicit PagedMesh(MeshPageCachePointer pageCache);
+    virtual ~PagedMesh() {}
+
+    // Splits mesh into pages and writes page file
+    static bool writePageFile(const IndexedMesh &mesh, const QString &filePath);
+
+    // Reads page table of page file, pages are read on request
+    bool open(const QString &filePath);
+
+    const BoundingBox &getBoundingBox() const { return mBoundingBox; }
+    int getPagesCount() const { return mPages.size(); }
+    // Root node has index 0
+    const PagedMeshNode &getNode(int nodeIndex) const { return mNodes[nodeIndex]; }
+    const BoundingBox &getNodeBoundingBox(int nodeIndex) const { return mNodeBoundingBoxes[nodeIndex]; }
+    // Returns page from page cache, the page is read if it is not resident
+    IndexedMeshPointer getPage(int pageIndex) const { return mPageCache->getPage(*this, mMeshId, pageIndex); }
+
+    // Reads page from file, page without triangles is returned if reading fails
+    IndexedMeshPointer readPage(int pageIndex) const;
+    // Size of page in memory
+    qint64 getPageSize(int pageIndex) const;
+    qint64 getPageFileSize(int pageIndex) const;
+
+  private:
+    // Checks that child and page links of nodes are in range and the tree depth is within the limit
+    bool isTreeValid() const;
+
+  private:
+    MeshPageCachePointer mPageCache;
+    int mMeshId;
+    // Page reading moves file position, so it is serialized
+    mutable QFile mFile;
+    mutable QMutex mFileMutex;
+    BoundingBox mBoundingBox;
+    std::vector<PagedMeshPageInfo> mPages;
+    std::vector<BoundingBox> mPageBoundingBoxes;
+    std::vector<PagedMeshNode> mNodes;
+    std::vector<BoundingBox> mNodeBoundingBoxes;
+};
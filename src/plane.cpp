@@ -24,10 +24,9 @@ RayIntersection Plane::intersectWithRay(const Ray &ray) const {
   float distance = -(ray.getOriginPosition().dotProduct(mNormal) + mDistance) / cosineRayNormal;
   if (distance > 0.0)
   {    
-    PlanePointer pointer = PlanePointer(new Plane(*this));
     std::vector<float> intersectionDistances;
     intersectionDistances.push_back(distance);
-    return RayIntersection(true, pointer, distance, getNormal(ray, distance), intersectionDistances);
+    return RayIntersection(true, this, distance, getNormal(ray, distance), intersectionDistances);
   }
 
   return RayIntersection();
@@ -1,6 +1,5 @@
 #include "pointlight.h"
 #include "mathcommons.h"
-#include "scene.h"
 
 PointLight::PointLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, Vector position, 
                        float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient) 
@@ -8,56 +7,92 @@ PointLight::PointLight(Color ambientIntensity, Color diffuseIntensity, Color spe
     mPosition(position),
     mConstantAttenutaionCoefficient(constantAttenutaionCoefficient),
     mLinearAttenutaionCoefficient(linearAttenutaionCoefficient),
-    mQuadraticAttenutaionCoefficient(quadraticAttenutaionCoefficient) {
+    mQuadraticAttenutaionCoefficient(quadraticAttenutaionCoefficient),
+    mInfluenceRadius(MAX_DISTANCE_TO_INTERSECTON) {
 }
 
 PointLight::~PointLight() {
 }
 
-Color PointLight::calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const {
+void PointLight::setContributionThreshold(float threshold) {
+  mInfluenceRadius = calculateInfluenceRadius(mConstantAttenutaionCoefficient, mLinearAttenutaionCoefficient, 
+                                              mQuadraticAttenutaionCoefficient, threshold);
+}
+
+bool PointLight::getInfluenceSphere(Vector &center, float &radius) const {
+  if (mInfluenceRadius == MAX_DISTANCE_TO_INTERSECTON) {
+    return false;
+  }
+  center = mPosition;
+  radius = mInfluenceRadius;
+  return true;
+}
+
+bool PointLight::getAttenuation(Vector &position, float &constantAttenutaionCoefficient, float &linearAttenutaionCoefficient, 
+                                float &quadraticAttenutaionCoefficient) const {
+  position = mPosition;
+  constantAttenutaionCoefficient = mConstantAttenutaionCoefficient;
+  linearAttenutaionCoefficient = mLinearAttenutaionCoefficient;
+  quadraticAttenutaionCoefficient = mQuadraticAttenutaionCoefficient;
+  return true;
+}
+
+float PointLight::estimateContribution(const Vector &point, const Vector &normal) const {
+  Vector lightDirection = mPosition - point;
+  float distanceToLight = lightDirection.length();
+  if (distanceToLight > mInfluenceRadius) {
+    return 0.f;
+  }
+
+  float attenuation = 1 / (mConstantAttenutaionCoefficient + mLinearAttenutaionCoefficient * distanceToLight + mQuadraticAttenutaionCoefficient * distanceToLight * distanceToLight);
+  return estimateAttenuatedContribution(attenuation, lightDirection.dotProduct(normal) > 0.f);
+}
+
+bool PointLight::calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const {
   Vector point = ray.getPointAt(distance);
+  Vector shadowRayDirection = mPosition - point;
+  float	distanceToLight	= shadowRayDirection.length();
+  shadowRayDirection.normalize(); 
+
+  // If the point is not illuminated
+  if (shadowRayDirection.dotProduct(normal) <= 0.0) {
+    return false;
+  }
 
-  Color ambientComponent;
-  Color diffuseComponent;
-  Color specularComponent;
+  shadowRay = Ray(point + shadowRayDirection * EPS_FOR_SHADOW_RAYS, shadowRayDirection, 0.f, distanceToLight);
+  return true;
+}
 
-  ambientComponent = componentwiseProduct(material->ambientColor, mAmbientIntensity);
-  Color result = ambientComponent;
+LightIrradiance PointLight::calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const {
+  Vector point = ray.getPointAt(distance);
 
   Vector shadowRayDirection = mPosition - point;
   float	distanceToLight	= shadowRayDirection.length();
   float	attenuation	= 1 / (mConstantAttenutaionCoefficient + mLinearAttenutaionCoefficient * distanceToLight + mQuadraticAttenutaionCoefficient * distanceToLight * distanceToLight);
-  result *= attenuation;
+
+  LightIrradiance irradiance;
+  irradiance.ambient = mAmbientIntensity * attenuation;
 
   shadowRayDirection.normalize(); 
   float	shadowRayDotNormal = shadowRayDirection.dotProduct(normal);
 
   // If the point is not illuminated
   if (shadowRayDotNormal <= 0.0) {
-    return result;
+    return irradiance;
   }
 
-  Ray shadowRay(point + shadowRayDirection * EPS_FOR_SHADOW_RAYS, shadowRayDirection);	
-  RayIntersection shadowRayIntersection = scene.calculateNearestIntersection(shadowRay);
-  
-  // If object is not in shadow
-  if (!shadowRayIntersection.rayIntersectsWithShape || shadowRayIntersection.distanceFromRayOrigin > distanceToLight) {
-    Color diffuseColor = material->diffuseColor;
-    diffuseComponent  = componentwiseProduct(diffuseColor, mDiffuseIntensity * attenuation * shadowRayDotNormal);
-
-    Vector lightReflect = shadowRayDirection - normal * 2 * shadowRayDirection.dotProduct(normal);
-    lightReflect.normalize();
-
-    Vector cameraDirection = ray.getOriginPosition() - point;
-    cameraDirection.normalize();
-
-    float	cosLightReflect = cameraDirection.dotProduct(lightReflect);
-    if (cosLightReflect > 0.0) {
-      Color specularColor = material->specularColor; 
-      specularComponent	= componentwiseProduct(specularColor, mSpecularIntensity * powf(cosLightReflect, material->specularPower) * attenuation);
-    }				
-  }
+  irradiance.diffuse = mDiffuseIntensity * attenuation * shadowRayDotNormal;
+
+  Vector lightReflect = shadowRayDirection - normal * 2 * shadowRayDirection.dotProduct(normal);
+  lightReflect.normalize();
+
+  Vector cameraDirection = ray.getOriginPosition() - point;
+  cameraDirection.normalize();
+
+  float	cosLightReflect = cameraDirection.dotProduct(lightReflect);
+  if (cosLightReflect > 0.0) {
+    irradiance.specular = mSpecularIntensity * powf(cosLightReflect, specularPower) * attenuation;
+  }				
 
-  result += (diffuseComponent + specularComponent);
-  return result;
+  return irradiance;
 }
\ No newline at end of file
@@ -12,9 +12,17 @@ class PointLight : public LightSource {
                float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient);
     ~PointLight();
 
-    virtual Color calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const;
+    virtual bool calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const;
+    virtual LightIrradiance calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const;
+    virtual bool getInfluenceSphere(Vector &center, float &radius) const;
+    virtual bool getAttenuation(Vector &position, float &constantAttenutaionCoefficient, float &linearAttenutaionCoefficient, 
+                                float &quadraticAttenutaionCoefficient) const;
+    virtual float estimateContribution(const Vector &point, const Vector &normal) const;
 
-  private:
+    // Light source is ignored at points where its contribution is below threshold, zero threshold disables culling
+    void setContributionThreshold(float threshold);
+
+  protected:
     // Light position
     Vector mPosition;
 
@@ -22,4 +30,7 @@ class PointLight : public LightSource {
     float	mConstantAttenutaionCoefficient;
     float mLinearAttenutaionCoefficient;
     float mQuadraticAttenutaionCoefficient;
+
+    // Distance at which contribution drops below threshold
+    float mInfluenceRadius;
 };
\ No newline at end of file
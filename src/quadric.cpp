@@ -0,0 +1,208 @@
+/*!
+ *\file quadric.cpp
+ *\brief Contains Quadric class definition
+ */
+
+#include "quadric.h"
+#include "rayintersection.h"
+
+Quadric::Quadric(const QuadricMatrix &matrix, const ClippingPlane *planes, int planesCount, MaterialPointer material)
+  : Shape(material),
+    mMatrix(matrix) {
+  Vector extent(MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON);
+  mBoundingBox = BoundingBox(-extent, extent);
+  for (int idx = 0; idx < planesCount && idx < MAX_CLIPPING_PLANES_COUNT; ++idx) {
+    mPlanes[idx] = planes[idx];
+  }
+}
+
+Quadric::~Quadric() {
+}
+
+QuadricPointer Quadric::createSphere(const Vector &center, float radius, MaterialPointer material) {
+  // |p - center|^2 - radius^2 = 0
+  QuadricMatrix matrix = createAxialMatrix(center, Vector(0.f, 0.f, 1.f), 0.f, radius * radius);
+  QuadricPointer quadric(new Quadric(matrix, NULL, 0, material));
+  quadric->mBoundingBox = calculateCapsBounds(center, center, radius);
+  return quadric;
+}
+
+QuadricPointer Quadric::createCylinder(const Vector &topCenter, const Vector &bottomCenter, float radius, MaterialPointer material) {
+  Vector axis = topCenter - bottomCenter;
+  axis.normalize();
+  // Distance to axis is equal to radius, cylinder is clipped by bottom and top planes
+  QuadricMatrix matrix = createAxialMatrix(bottomCenter, axis, 1.f, radius * radius);
+  ClippingPlane planes[2] = {ClippingPlane(-axis, axis.dotProduct(bottomCenter)),
+                             ClippingPlane(axis, -axis.dotProduct(topCenter))};
+  QuadricPointer quadric(new Quadric(matrix, planes, 2, material));
+  quadric->mBoundingBox = calculateCapsBounds(topCenter, bottomCenter, radius);
+  return quadric;
+}
+
+QuadricPointer Quadric::createCone(const Vector &top, const Vector &bottomCenter, float radius, MaterialPointer material) {
+  Vector axis = bottomCenter - top;
+  float height = axis.length();
+  axis.normalize();
+  // Distance to axis is proportional to height over top, cone is clipped by plane through top and bottom plane
+  float radiusPerHeight = radius / height;
+  QuadricMatrix matrix = createAxialMatrix(top, axis, 1.f + radiusPerHeight * radiusPerHeight, 0.f);
+  ClippingPlane planes[2] = {ClippingPlane(-axis, axis.dotProduct(top)),
+                             ClippingPlane(axis, -axis.dotProduct(bottomCenter))};
+  QuadricPointer quadric(new Quadric(matrix, planes, 2, material));
+  quadric->mBoundingBox = calculateCapsBounds(top, bottomCenter, radius);
+  return quadric;
+}
+
+BoundingBox Quadric::calculateCapsBounds(const Vector &firstCenter, const Vector &secondCenter, float radius) {
+  Vector extent(radius, radius, radius);
+  return BoundingBox(componentwiseMin(firstCenter, secondCenter) - extent, componentwiseMax(firstCenter, secondCenter) + extent);
+}
+
+QuadricMatrix Quadric::createAxialMatrix(const Vector &origin, const Vector &axis, float axisFactor, float constant) {
+  // Quadric is (p - o)^T * A * (p - o) - constant, where A = I - axisFactor * axis * axis^T
+  QuadricMatrix matrix;
+  matrix.m00 = 1.f - axisFactor * axis.x * axis.x;
+  matrix.m11 = 1.f - axisFactor * axis.y * axis.y;
+  matrix.m22 = 1.f - axisFactor * axis.z * axis.z;
+  matrix.m01 = -axisFactor * axis.x * axis.y;
+  matrix.m02 = -axisFactor * axis.x * axis.z;
+  matrix.m12 = -axisFactor * axis.y * axis.z;
+
+  Vector transformedOrigin(matrix.m00 * origin.x + matrix.m01 * origin.y + matrix.m02 * origin.z,
+                           matrix.m01 * origin.x + matrix.m11 * origin.y + matrix.m12 * origin.z,
+                           matrix.m02 * origin.x + matrix.m12 * origin.y + matrix.m22 * origin.z);
+  matrix.m03 = -transformedOrigin.x;
+  matrix.m13 = -transformedOrigin.y;
+  matrix.m23 = -transformedOrigin.z;
+  matrix.m33 = origin.dotProduct(transformedOrigin) - constant;
+  return matrix;
+}
+
+RayIntersection Quadric::intersectWithRay(const Ray &ray) const {
+  const Vector &rayOrigin = ray.getOriginPosition();
+  const Vector &rayDirection = ray.getDirection();
+  const QuadricMatrix &m = mMatrix;
+
+  // Substitute ray into quadric equation, solve square equation a * x^2 + 2 * b * x + c = 0
+  Vector transformedDirection(m.m00 * rayDirection.x + m.m01 * rayDirection.y + m.m02 * rayDirection.z,
+                              m.m01 * rayDirection.x + m.m11 * rayDirection.y + m.m12 * rayDirection.z,
+                              m.m02 * rayDirection.x + m.m12 * rayDirection.y + m.m22 * rayDirection.z);
+  Vector transformedOrigin(m.m00 * rayOrigin.x + m.m01 * rayOrigin.y + m.m02 * rayOrigin.z + m.m03,
+                           m.m01 * rayOrigin.x + m.m11 * rayOrigin.y + m.m12 * rayOrigin.z + m.m13,
+                           m.m02 * rayOrigin.x + m.m12 * rayOrigin.y + m.m22 * rayOrigin.z + m.m23);
+  float transformedOriginW = m.m03 * rayOrigin.x + m.m13 * rayOrigin.y + m.m23 * rayOrigin.z + m.m33;
+
+  float a = rayDirection.dotProduct(transformedDirection);
+  float b = rayDirection.dotProduct(transformedOrigin);
+  float c = rayOrigin.dotProduct(transformedOrigin) + transformedOriginW;
+
+  // Ray parts lying inside quadric, there are two of them when ray crosses both sheets of a cone
+  float enterDistances[2] = {MAX_DISTANCE_TO_INTERSECTON, MAX_DISTANCE_TO_INTERSECTON};
+  float exitDistances[2] = {-MAX_DISTANCE_TO_INTERSECTON, -MAX_DISTANCE_TO_INTERSECTON};
+  if (fabs(a) > FLOAT_ZERO) {
+    float discriminant = b * b - a * c;
+    if (discriminant >= 0.f) {
+      discriminant = sqrtf(discriminant);
+      float firstRoot = (-b - discriminant) / a;
+      float secondRoot = (-b + discriminant) / a;
+      float closestRoot = std::min(firstRoot, secondRoot);
+      float farthestRoot = std::max(firstRoot, secondRoot);
+      if (a > 0.f) {
+        enterDistances[0] = closestRoot;
+        exitDistances[0] = farthestRoot;
+      } else {
+        enterDistances[0] = -MAX_DISTANCE_TO_INTERSECTON;
+        exitDistances[0] = closestRoot;
+        enterDistances[1] = farthestRoot;
+        exitDistances[1] = MAX_DISTANCE_TO_INTERSECTON;
+      }
+    } else if (a < 0.f) {
+      enterDistances[0] = -MAX_DISTANCE_TO_INTERSECTON;
+      exitDistances[0] = MAX_DISTANCE_TO_INTERSECTON;
+    }
+  } else if (fabs(b) > FLOAT_ZERO) {
+    // Equation is linear
+    float root = -c / (2.f * b);
+    enterDistances[0] = b > 0.f ? -MAX_DISTANCE_TO_INTERSECTON : root;
+    exitDistances[0] = b > 0.f ? root : MAX_DISTANCE_TO_INTERSECTON;
+  } else if (c <= 0.f) {
+    // Whole ray is inside quadric
+    enterDistances[0] = -MAX_DISTANCE_TO_INTERSECTON;
+    exitDistances[0] = MAX_DISTANCE_TO_INTERSECTON;
+  }
+
+  // Clip ray by planes
+  float nearDistance = -MAX_DISTANCE_TO_INTERSECTON;
+  float farDistance = MAX_DISTANCE_TO_INTERSECTON;
+  for (int idx = 0; idx < MAX_CLIPPING_PLANES_COUNT; ++idx) {
+    float denominator = mPlanes[idx].normal.dotProduct(rayDirection);
+    float numerator = mPlanes[idx].normal.dotProduct(rayOrigin) + mPlanes[idx].distance;
+    if (denominator > FLOAT_ZERO) {
+      farDistance = std::min(farDistance, -numerator / denominator);
+    } else if (denominator < -FLOAT_ZERO) {
+      nearDistance = std::max(nearDistance, -numerator / denominator);
+    } else if (numerator > 0.f) {
+      // Ray is parallel to plane and lies outside
+      return RayIntersection();
+    }
+  }
+
+  // Take the first ray part which is not empty after clipping and lies in front of ray origin
+  for (int idx = 0; idx < 2; ++idx) {
+    float enterDistance = std::max(enterDistances[idx], nearDistance);
+    float exitDistance = std::min(exitDistances[idx], farDistance);
+    if (enterDistance > exitDistance || exitDistance <= 0.f) {
+      continue;
+    }
+
+    std::vector<float> intersectionDistances;
+    // Ray origin is inside quadric
+    intersectionDistances.push_back(std::max(enterDistance, 0.f));
+    intersectionDistances.push_back(exitDistance);
+
+    float closestRoot = enterDistance > 0.f ? enterDistance : exitDistance;
+    return RayIntersection(true, this, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
+  }
+
+  return RayIntersection();
+}
+
+Vector Quadric::getNormal(const Ray &ray, float distance) const {
+  Vector point = ray.getPointAt(distance);
+
+  // Choose the surface which is the closest to intersection point,
+  // distance to quadric surface is estimated by its value divided by gradient length
+  Vector gradient;
+  float value = evaluate(point, gradient);
+  float gradientLength = gradient.length();
+  float distanceToQuadric = gradientLength > FLOAT_ZERO ? fabs(value) / gradientLength : MAX_DISTANCE_TO_INTERSECTON;
+
+  int closestPlaneIndex = -1;
+  float distanceToClosestPlane = distanceToQuadric;
+  for (int idx = 0; idx < MAX_CLIPPING_PLANES_COUNT; ++idx) {
+    float normalLength = mPlanes[idx].normal.length();
+    if (normalLength <= FLOAT_ZERO) {
+      continue;
+    }
+    float distanceToPlane = fabs(mPlanes[idx].normal.dotProduct(point) + mPlanes[idx].distance) / normalLength;
+    if (distanceToPlane < distanceToClosestPlane) {
+      distanceToClosestPlane = distanceToPlane;
+      closestPlaneIndex = idx;
+    }
+  }
+
+  Vector normal = closestPlaneIndex >= 0 ? mPlanes[closestPlaneIndex].normal : gradient;
+  normal.normalize();
+  return normal;
+}
+
+float Quadric::evaluate(const Vector &point, Vector &gradient) const {
+  const QuadricMatrix &m = mMatrix;
+  // Q * p, gradient is equal to its doubled xyz part
+  Vector transformedPoint(m.m00 * point.x + m.m01 * point.y + m.m02 * point.z + m.m03,
+                          m.m01 * point.x + m.m11 * point.y + m.m12 * point.z + m.m13,
+                          m.m02 * point.x + m.m12 * point.y + m.m22 * point.z + m.m23);
+  float transformedPointW = m.m03 * point.x + m.m13 * point.y + m.m23 * point.z + m.m33;
+  gradient = transformedPoint * 2.f;
+  return point.dotProduct(transformedPoint) + transformedPointW;
+}
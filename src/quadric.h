@@ -0,0 +1,86 @@
+/*!
+ *\file quadric.h
+ *\brief Contains Quadric class declaration
+ */
+
+#pragma once
+
+#include "shape.h"
+#include "boundingbox.h"
+
+#define MAX_CLIPPING_PLANES_COUNT 2
+
+class Quadric;
+
+typedef QSharedPointer<Quadric> QuadricPointer;
+
+/*!
+ * Symmetric 4x4 matrix Q of quadric surface p^T * Q * p = 0, where p = (x, y, z, 1).
+ * Only upper triangle is stored.
+ */
+struct QuadricMatrix {
+  QuadricMatrix()
+    : m00(0.f), m01(0.f), m02(0.f), m03(0.f),
+      m11(0.f), m12(0.f), m13(0.f),
+      m22(0.f), m23(0.f),
+      m33(0.f) {}
+
+  float m00, m01, m02, m03;
+  float m11, m12, m13;
+  float m22, m23;
+  float m33;
+};
+
+/*!
+ * Half-space normal * p + distance <= 0 the quadric is clipped by.
+ * Plane with zero normal and negative distance does not clip anything.
+ */
+struct ClippingPlane {
+  ClippingPlane()
+    : distance(-1.f) {}
+  ClippingPlane(const Vector &planeNormal, float planeDistance)
+    : normal(planeNormal),
+      distance(planeDistance) {}
+
+  Vector normal;
+  float distance;
+};
+
+/*!
+ * Solid bounded by quadric surface (points where p^T * Q * p <= 0) and clipped by up to
+ * MAX_CLIPPING_PLANES_COUNT half-spaces, parts of clipping planes lying inside the quadric are its caps.
+ * Sphere, cylinder and cone can be lowered to this representation, so that they
+ * are intersected by the same code (see QuadricGroup). Quadrics created by these factories have finite bounding box,
+ * bounding box of quadric given by arbitrary matrix is infinite.
+ */
+class Quadric : public Shape {
+  public:
+    Quadric(const QuadricMatrix &matrix, const ClippingPlane *planes, int planesCount, MaterialPointer material);
+    virtual ~Quadric();
+
+    static QuadricPointer createSphere(const Vector &center, float radius, MaterialPointer material);
+    static QuadricPointer createCylinder(const Vector &topCenter, const Vector &bottomCenter, float radius, MaterialPointer material);
+    static QuadricPointer createCone(const Vector &top, const Vector &bottomCenter, float radius, MaterialPointer material);
+
+    virtual RayIntersection intersectWithRay(const Ray &ray) const;
+    virtual Vector getNormal(const Ray &ray, float distance) const;
+
+    const QuadricMatrix &getMatrix() const { return mMatrix; }
+    // Returns clipping plane, unused planes do not clip anything
+    const ClippingPlane &getClippingPlane(int index) const { return mPlanes[index]; }
+    const BoundingBox &getBoundingBox() const { return mBoundingBox; }
+
+  private:
+    // Bounds of points closer than radius to segment between centers, they contain sphere, cylinder and cone
+    static BoundingBox calculateCapsBounds(const Vector &firstCenter, const Vector &secondCenter, float radius);
+    // Builds quadric |p - origin|^2 - axisFactor * ((p - origin) * axis)^2 - constant = 0
+    static QuadricMatrix createAxialMatrix(const Vector &origin, const Vector &axis, float axisFactor, float constant);
+
+    // Calculates quadric function p^T * Q * p and its gradient, which is directed outwards
+    float evaluate(const Vector &point, Vector &gradient) const;
+
+  private:
+    QuadricMatrix mMatrix;
+    ClippingPlane mPlanes[MAX_CLIPPING_PLANES_COUNT];
+    BoundingBox mBoundingBox;
+};
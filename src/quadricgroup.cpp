@@ -0,0 +1,197 @@
+/*!
+ *\file quadricgroup.cpp
+ *\brief Contains QuadricGroup class definition
+ */
+
+#include "quadricgroup.h"
+#include "rayintersection.h"
+#include "simdpacket.h"
+
+QuadricGroup::QuadricGroup(const std::vector<QuadricPointer> &quadrics)
+  : Shape(MaterialPointer(NULL)),  // materials are owned by quadrics
+    mQuadrics(quadrics) {
+  int paddedSize = (quadrics.size() + PACKET_SIZE - 1) / PACKET_SIZE * PACKET_SIZE;
+  // Padding quadrics have positive function everywhere (m33 = 1), so they are never intersected
+  for (int coefficient = 0; coefficient < QUADRIC_COEFFICIENTS_COUNT; ++coefficient) {
+    mCoefficients[coefficient].resize(paddedSize, coefficient == QUADRIC_COEFFICIENTS_COUNT - 1 ? 1.f : 0.f);
+  }
+  for (int plane = 0; plane < MAX_CLIPPING_PLANES_COUNT; ++plane) {
+    mPlaneNormalsX[plane].resize(paddedSize, 0.f);
+    mPlaneNormalsY[plane].resize(paddedSize, 0.f);
+    mPlaneNormalsZ[plane].resize(paddedSize, 0.f);
+    mPlaneDistances[plane].resize(paddedSize, -1.f);
+  }
+
+  for (int idx = 0, count = quadrics.size(); idx < count; ++idx) {
+    const QuadricMatrix &matrix = quadrics[idx]->getMatrix();
+    float coefficients[QUADRIC_COEFFICIENTS_COUNT] = {matrix.m00, matrix.m01, matrix.m02, matrix.m03,
+                                                      matrix.m11, matrix.m12, matrix.m13,
+                                                      matrix.m22, matrix.m23,
+                                                      matrix.m33};
+    for (int coefficient = 0; coefficient < QUADRIC_COEFFICIENTS_COUNT; ++coefficient) {
+      mCoefficients[coefficient][idx] = coefficients[coefficient];
+    }
+    for (int plane = 0; plane < MAX_CLIPPING_PLANES_COUNT; ++plane) {
+      const ClippingPlane &clippingPlane = quadrics[idx]->getClippingPlane(plane);
+      mPlaneNormalsX[plane][idx] = clippingPlane.normal.x;
+      mPlaneNormalsY[plane][idx] = clippingPlane.normal.y;
+      mPlaneNormalsZ[plane][idx] = clippingPlane.normal.z;
+      mPlaneDistances[plane][idx] = clippingPlane.distance;
+    }
+  }
+}
+
+QuadricGroup::~QuadricGroup() {
+}
+
+RayIntersection QuadricGroup::intersectWithRay(const Ray &ray) const {
+  const Vector &rayOrigin = ray.getOriginPosition();
+  const Vector &rayDirection = ray.getDirection();
+
+  Packet originX = packetSet(rayOrigin.x);
+  Packet originY = packetSet(rayOrigin.y);
+  Packet originZ = packetSet(rayOrigin.z);
+  Packet directionX = packetSet(rayDirection.x);
+  Packet directionY = packetSet(rayDirection.y);
+  Packet directionZ = packetSet(rayDirection.z);
+  Packet zero = packetSet(0.f);
+  Packet two = packetSet(2.f);
+  Packet epsilon = packetSet(FLOAT_ZERO);
+  Packet negativeEpsilon = packetSet(-FLOAT_ZERO);
+  Packet infinity = packetSet(MAX_DISTANCE_TO_INTERSECTON);
+  Packet negativeInfinity = packetSet(-MAX_DISTANCE_TO_INTERSECTON);
+
+  float closestDistance = MAX_DISTANCE_TO_INTERSECTON;
+  int closestQuadricIndex = -1;
+  float distances[PACKET_SIZE];
+
+  for (int first = 0, count = mCoefficients[0].size(); first < count; first += PACKET_SIZE) {
+    Packet m00 = packetLoad(&mCoefficients[0][first]);
+    Packet m01 = packetLoad(&mCoefficients[1][first]);
+    Packet m02 = packetLoad(&mCoefficients[2][first]);
+    Packet m03 = packetLoad(&mCoefficients[3][first]);
+    Packet m11 = packetLoad(&mCoefficients[4][first]);
+    Packet m12 = packetLoad(&mCoefficients[5][first]);
+    Packet m13 = packetLoad(&mCoefficients[6][first]);
+    Packet m22 = packetLoad(&mCoefficients[7][first]);
+    Packet m23 = packetLoad(&mCoefficients[8][first]);
+    Packet m33 = packetLoad(&mCoefficients[9][first]);
+
+    // Substitute ray into quadric equations, get square equations a * x^2 + 2 * b * x + c = 0
+    Packet transformedDirectionX = packetAdd(packetAdd(packetMul(m00, directionX), packetMul(m01, directionY)), packetMul(m02, directionZ));
+    Packet transformedDirectionY = packetAdd(packetAdd(packetMul(m01, directionX), packetMul(m11, directionY)), packetMul(m12, directionZ));
+    Packet transformedDirectionZ = packetAdd(packetAdd(packetMul(m02, directionX), packetMul(m12, directionY)), packetMul(m22, directionZ));
+    Packet transformedOriginX = packetAdd(packetAdd(packetAdd(packetMul(m00, originX), packetMul(m01, originY)), packetMul(m02, originZ)), m03);
+    Packet transformedOriginY = packetAdd(packetAdd(packetAdd(packetMul(m01, originX), packetMul(m11, originY)), packetMul(m12, originZ)), m13);
+    Packet transformedOriginZ = packetAdd(packetAdd(packetAdd(packetMul(m02, originX), packetMul(m12, originY)), packetMul(m22, originZ)), m23);
+    Packet transformedOriginW = packetAdd(packetAdd(packetAdd(packetMul(m03, originX), packetMul(m13, originY)), packetMul(m23, originZ)), m33);
+
+    Packet a = packetAdd(packetAdd(packetMul(directionX, transformedDirectionX),
+                                   packetMul(directionY, transformedDirectionY)),
+                                   packetMul(directionZ, transformedDirectionZ));
+    Packet b = packetAdd(packetAdd(packetMul(directionX, transformedOriginX),
+                                   packetMul(directionY, transformedOriginY)),
+                                   packetMul(directionZ, transformedOriginZ));
+    Packet c = packetAdd(packetAdd(packetAdd(packetMul(originX, transformedOriginX),
+                                             packetMul(originY, transformedOriginY)),
+                                             packetMul(originZ, transformedOriginZ)),
+                         transformedOriginW);
+
+    // Ray parts lying inside quadrics, empty parts have enter distance greater than exit distance
+    Packet firstEnter = infinity;
+    Packet firstExit = negativeInfinity;
+    Packet secondEnter = infinity;
+    Packet secondExit = negativeInfinity;
+
+    Packet discriminant = packetSub(packetMul(b, b), packetMul(a, c));
+    Packet hasRoots = packetLessOrEqual(zero, discriminant);
+    Packet discriminantRoot = packetSqrt(packetMax(discriminant, zero));
+    Packet minusB = packetSub(zero, b);
+    Packet firstRoot = packetDiv(packetSub(minusB, discriminantRoot), a);
+    Packet secondRoot = packetDiv(packetAdd(minusB, discriminantRoot), a);
+    Packet closestRoot = packetMin(firstRoot, secondRoot);
+    Packet farthestRoot = packetMax(firstRoot, secondRoot);
+
+    // Positive a: ray is inside between roots
+    Packet isPositiveA = packetGreater(a, epsilon);
+    Packet mask = packetAnd(isPositiveA, hasRoots);
+    firstEnter = packetSelect(firstEnter, closestRoot, mask);
+    firstExit = packetSelect(firstExit, farthestRoot, mask);
+
+    // Negative a: ray is inside before the closest root and after the farthest one, or everywhere if there are no roots
+    Packet isNegativeA = packetLess(a, negativeEpsilon);
+    mask = packetAnd(isNegativeA, hasRoots);
+    firstEnter = packetSelect(firstEnter, negativeInfinity, isNegativeA);
+    firstExit = packetSelect(packetSelect(firstExit, infinity, isNegativeA), closestRoot, mask);
+    secondEnter = packetSelect(secondEnter, farthestRoot, mask);
+    secondExit = packetSelect(secondExit, infinity, mask);
+
+    // Zero a: equation is linear
+    Packet isLinear = packetAnd(packetLessOrEqual(a, epsilon), packetLessOrEqual(negativeEpsilon, a));
+    Packet linearRoot = packetDiv(packetSub(zero, c), packetMul(two, b));
+    Packet isPositiveB = packetAnd(isLinear, packetGreater(b, epsilon));
+    Packet isNegativeB = packetAnd(isLinear, packetLess(b, negativeEpsilon));
+    Packet isInsideEverywhere = packetAnd(packetAnd(isLinear, packetLessOrEqual(b, epsilon)),
+                                          packetAnd(packetLessOrEqual(negativeEpsilon, b), packetLessOrEqual(c, zero)));
+    firstEnter = packetSelect(firstEnter, negativeInfinity, packetOr(isPositiveB, isInsideEverywhere));
+    firstEnter = packetSelect(firstEnter, linearRoot, isNegativeB);
+    firstExit = packetSelect(firstExit, infinity, packetOr(isNegativeB, isInsideEverywhere));
+    firstExit = packetSelect(firstExit, linearRoot, isPositiveB);
+
+    // Clip rays by planes
+    Packet nearDistance = negativeInfinity;
+    Packet farDistance = infinity;
+    Packet isOutsidePlane = packetLess(zero, zero);
+    for (int plane = 0; plane < MAX_CLIPPING_PLANES_COUNT; ++plane) {
+      Packet normalX = packetLoad(&mPlaneNormalsX[plane][first]);
+      Packet normalY = packetLoad(&mPlaneNormalsY[plane][first]);
+      Packet normalZ = packetLoad(&mPlaneNormalsZ[plane][first]);
+      Packet denominator = packetAdd(packetAdd(packetMul(normalX, directionX), packetMul(normalY, directionY)), packetMul(normalZ, directionZ));
+      Packet numerator = packetAdd(packetAdd(packetAdd(packetMul(normalX, originX), packetMul(normalY, originY)), packetMul(normalZ, originZ)),
+                                   packetLoad(&mPlaneDistances[plane][first]));
+      Packet distance = packetDiv(packetSub(zero, numerator), denominator);
+
+      farDistance = packetSelect(farDistance, packetMin(distance, farDistance), packetGreater(denominator, epsilon));
+      nearDistance = packetSelect(nearDistance, packetMax(distance, nearDistance), packetLess(denominator, negativeEpsilon));
+      // Ray is parallel to plane and lies outside
+      Packet isParallel = packetAnd(packetLessOrEqual(denominator, epsilon), packetLessOrEqual(negativeEpsilon, denominator));
+      isOutsidePlane = packetOr(isOutsidePlane, packetAnd(isParallel, packetGreater(numerator, zero)));
+    }
+
+    // Take the first ray part which is not empty after clipping and lies in front of ray origin
+    firstEnter = packetMax(firstEnter, nearDistance);
+    firstExit = packetMin(firstExit, farDistance);
+    secondEnter = packetMax(secondEnter, nearDistance);
+    secondExit = packetMin(secondExit, farDistance);
+    Packet isFirstHit = packetAnd(packetLessOrEqual(firstEnter, firstExit), packetGreater(firstExit, zero));
+    Packet isSecondHit = packetAnd(packetLessOrEqual(secondEnter, secondExit), packetGreater(secondExit, zero));
+    Packet firstDistance = packetSelect(firstExit, firstEnter, packetGreater(firstEnter, zero));
+    Packet secondDistance = packetSelect(secondExit, secondEnter, packetGreater(secondEnter, zero));
+
+    Packet hitDistances = packetSelect(packetSelect(infinity, secondDistance, isSecondHit), firstDistance, isFirstHit);
+    hitDistances = packetSelect(hitDistances, infinity, isOutsidePlane);
+    if (packetMask(packetLess(hitDistances, packetSet(closestDistance))) == 0) {
+      continue;
+    }
+
+    packetStore(distances, hitDistances);
+    for (int lane = 0; lane < PACKET_SIZE; ++lane) {
+      if (distances[lane] < closestDistance) {
+        closestDistance = distances[lane];
+        closestQuadricIndex = first + lane;
+      }
+    }
+  }
+
+  if (closestQuadricIndex < 0) {
+    return RayIntersection();
+  }
+
+  // Calculate complete intersection data for the closest quadric only
+  return mQuadrics[closestQuadricIndex]->Quadric::intersectWithRay(ray);
+}
+
+Vector QuadricGroup::getNormal(const Ray &ray, float distance) const {
+  // This method is actually never called
+  return Vector();
+}
@@ -0,0 +1,44 @@
+/*!
+ *\file quadricgroup.h
+ *\brief Contains QuadricGroup class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "shape.h"
+#include "quadric.h"
+
+#define QUADRIC_COEFFICIENTS_COUNT 10
+
+class QuadricGroup;
+
+typedef QSharedPointer<QuadricGroup> QuadricGroupPointer;
+
+/*!
+ * Group of clipped quadrics stored as structure of arrays.
+ * Quadrics of different kinds (lowered spheres, cylinders and cones) are tested against ray
+ * PACKET_SIZE at once by the same kernel, full intersection data is calculated only for the nearest hit quadric.
+ */
+class QuadricGroup : public Shape {
+  public:
+    QuadricGroup(const std::vector<QuadricPointer> &quadrics);
+    virtual ~QuadricGroup();
+
+    virtual RayIntersection intersectWithRay(const Ray &ray) const;
+    virtual Vector getNormal(const Ray &ray, float distance) const;
+
+    const std::vector<QuadricPointer> &getQuadrics() const { return mQuadrics; }
+
+  private:
+    std::vector<QuadricPointer> mQuadrics;
+
+    // Quadric matrices upper triangles (m00, m01, m02, m03, m11, m12, m13, m22, m23, m33)
+    // and clipping planes, padded to packet size
+    std::vector<float> mCoefficients[QUADRIC_COEFFICIENTS_COUNT];
+    std::vector<float> mPlaneNormalsX[MAX_CLIPPING_PLANES_COUNT];
+    std::vector<float> mPlaneNormalsY[MAX_CLIPPING_PLANES_COUNT];
+    std::vector<float> mPlaneNormalsZ[MAX_CLIPPING_PLANES_COUNT];
+    std::vector<float> mPlaneDistances[MAX_CLIPPING_PLANES_COUNT];
+};
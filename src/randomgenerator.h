@@ -0,0 +1,34 @@
+/*!
+ *\file randomgenerator.h
+ *\brief Contains RandomGenerator class declaration and definition
+ */
+
+#pragma once
+
+#define RANDOM_GENERATOR_DEFAULT_SEED 2463534242u
+
+/*!
+ * Xorshift pseudo random number generator.
+ * Generator state is not synchronized, each rendering thread should own its own generator.
+ */
+class RandomGenerator {
+  public:
+    RandomGenerator(unsigned seed = RANDOM_GENERATOR_DEFAULT_SEED) : mState(seed != 0 ? seed : RANDOM_GENERATOR_DEFAULT_SEED) {}
+
+    unsigned generate() {
+      mState ^= mState << 13;
+      mState ^= mState >> 17;
+      mState ^= mState << 5;
+      return mState;
+    }
+
+    // Generates number uniformly distributed in [0, 1) range, upper 24 bits are used so that result is exactly representable
+    float generateFloat() {
+      return (generate() >> 8) * (1.f / 16777216.f);
+    }
+
+    void setSeed(unsigned seed) { mState = seed != 0 ? seed : RANDOM_GENERATOR_DEFAULT_SEED; }
+
+  private:
+    unsigned mState;
+};
@@ -5,23 +5,21 @@
 
 #include "ray.h"
 
-Ray::Ray(const Vector &originPosition, const Vector &direction) 
-  : mOriginPosition(originPosition), 
-    mDirection(direction) {
-  mDirection.normalize();
-}
-
-Ray::~Ray() {
-}
-
-Vector Ray::getPointAt(float distance) const {
-  return mOriginPosition + mDirection * distance;
-}
-
-Vector Ray::getOriginPosition() const {
-  return mOriginPosition;
+Ray::Ray()
+  : mMinDistance(0.f),
+    mMaxDistance(MAX_DISTANCE_TO_INTERSECTON) {
+  mDirectionSigns[0] = mDirectionSigns[1] = mDirectionSigns[2] = 0;
 }
 
-Vector Ray::getDirection() const {
-  return mDirection;
+Ray::Ray(const Vector &originPosition, const Vector &direction, float minDistance, float maxDistance) 
+  : mOriginPosition(originPosition), 
+    mDirection(direction),
+    mMinDistance(minDistance),
+    mMaxDistance(maxDistance) {
+  mDirection.normalize();
+  // Division by zero component gives infinity, which is handled by slab tests
+  mInvertedDirection = Vector(1.f / mDirection.x, 1.f / mDirection.y, 1.f / mDirection.z);
+  mDirectionSigns[0] = mInvertedDirection.x < 0.f;
+  mDirectionSigns[1] = mInvertedDirection.y < 0.f;
+  mDirectionSigns[2] = mInvertedDirection.z < 0.f;
 }
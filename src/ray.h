@@ -7,17 +7,35 @@
 
 #include "types.h"
 
+/*!
+ * Ray is a trivially copyable value type.
+ * Besides origin and normalized direction it carries values precalculated for slab tests
+ * (inverted direction and direction sign per axis) and [min, max] distance interval
+ * along the ray where intersections are of interest.
+ */
 class Ray {
   public:
-    Ray(const Vector &originPosition, const Vector &direction);
-    virtual ~Ray();
+    Ray();
+    Ray(const Vector &originPosition, const Vector &direction, 
+        float minDistance = 0.f, float maxDistance = MAX_DISTANCE_TO_INTERSECTON);
+
+    Vector getPointAt(float distance) const { return mOriginPosition + mDirection * distance; }
 
-    Vector getPointAt(float distance) const;
+    const Vector &getOriginPosition() const { return mOriginPosition; }
+    const Vector &getDirection() const { return mDirection; }
+    const Vector &getInvertedDirection() const { return mInvertedDirection; }
+    // Returns 1 if direction component along given axis is negative, 0 otherwise
+    int getDirectionSign(int axis) const { return mDirectionSigns[axis]; }
 
-    Vector getOriginPosition() const;
-    Vector getDirection() const;
+    float getMinDistance() const { return mMinDistance; }
+    float getMaxDistance() const { return mMaxDistance; }
+    void setMaxDistance(float distance) { mMaxDistance = distance; }
 
   private:
     Vector mOriginPosition;
     Vector mDirection;
-};
\ No newline at end of file
+    Vector mInvertedDirection;
+    int mDirectionSigns[3];
+    float mMinDistance;
+    float mMaxDistance;
+};
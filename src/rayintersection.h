@@ -15,7 +15,7 @@ struct RayIntersection {
     : rayIntersectsWithShape(false), 
       shape(NULL), 
       distanceFromRayOrigin(MAX_DISTANCE_TO_INTERSECTON) {}
-  RayIntersection(bool intersectsWithShape, ShapePointer intersectsWith, float distance, Vector normal, std::vector<float> distances)
+  RayIntersection(bool intersectsWithShape, const Shape *intersectsWith, float distance, Vector normal, std::vector<float> distances)
     : rayIntersectsWithShape(intersectsWithShape), 
       shape(intersectsWith), 
       distanceFromRayOrigin(distance), 
@@ -23,8 +23,8 @@ struct RayIntersection {
       intersectionDistances(distances) {}
   // Does intersection exist
   bool rayIntersectsWithShape;
-  // Shape the ray intersects with
-  ShapePointer shape;
+  // Shape the ray intersects with, it is owned by the scene
+  const Shape *shape;
   // Distance from ray origin to intersection point
   float distanceFromRayOrigin;
   // Normal at intersection point
@@ -3,19 +3,23 @@
  *\brief Contains RayTracer class definition
  */
 
+#include <iostream>
+#include <QImage>
+
 #include "raytracer.h"
 #include "mathcommons.h"
+#include "tonemapping.h"
 
 #define MAX_TRACER_RECURSION_DEPTH 10
-#define RGBA(r, g, b, a) ((a & 0xff) << 24) | ((r & 0xff) << 16) | ((g & 0xff) << 8) | (b & 0xff);
-
-//#define CALCULATE_FRENSEL_COEFFICIENT_BY_SHLICK
+// Number of rendered bands waiting for writing, rendering waits when writing falls behind
+#define OUTPUT_QUEUE_BANDS_COUNT 2
 
 /*
 * public:
 */
 RayTracer::RayTracer() 
-  : mScene(NULL) {
+  : mScene(NULL),
+    mSamplesPerPixel(1) {
 }
 
 RayTracer::~RayTracer() {
@@ -29,42 +33,100 @@ void RayTracer::setImageResolution(int width, int height) {
   mScene->getCamera()->setImageResolution(width, height);
 }
 
+void RayTracer::setSamplesPerPixel(int samplesCount) {
+  mSamplesPerPixel = std::max(samplesCount, 1);
+}
+
+void RayTracer::setIrradianceCacheSpacing(float spacing) {
+  mIrradianceCache.setSpacing(spacing);
+}
+
 void RayTracer::renderScene() {
-  mRenderedImage = QImage(mScene->getCamera()->getImageWidth(), mScene->getCamera()->getImageHeight(), QImage::Format_RGB32);
-  render();
+  int imageWidth = mScene->getCamera()->getImageWidth();
+  int imageHeight = mScene->getCamera()->getImageHeight();
+  mRenderedColors.resize(imageWidth * imageHeight * 3);
+  prepareRendering();
+  renderBand(0, imageHeight, &mRenderedColors[0]);
 }
 
 void RayTracer::saveRenderedImageToFile(const QString& filePath) {
-  mRenderedImage.save(filePath);
+  int imageWidth = mScene->getCamera()->getImageWidth();
+  int imageHeight = mScene->getCamera()->getImageHeight();
+
+  if (StreamingImageWriter::isHighDynamicRangeFile(filePath) || StreamingImageWriter::isStandardOutput(filePath)) {
+    StreamingImageWriter imageWriter;
+    if (imageWriter.open(filePath, imageWidth, imageHeight)) {
+      imageWriter.writeBand(&mRenderedColors[0], imageHeight);
+      imageWriter.close();
+    }
+    return;
+  }
+
+  // Tone mapping is done as a separate pass over the whole image
+  QImage renderedImage(imageWidth, imageHeight, QImage::Format_RGB32);
+  quantizeColors(&mRenderedColors[0], imageWidth * imageHeight, reinterpret_cast< unsigned* >(renderedImage.bits()));
+  if (!renderedImage.save(filePath)) {
+    std::cerr << "Unable to save image to file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+  }
+}
+
+bool RayTracer::renderSceneToFile(const QString &filePath, int bandHeight) {
+  int imageWidth = mScene->getCamera()->getImageWidth();
+  int imageHeight = mScene->getCamera()->getImageHeight();
+  AsyncImageWriter imageWriter(OUTPUT_QUEUE_BANDS_COUNT);
+  if (!imageWriter.open(filePath, imageWidth, imageHeight)) {
+    return false;
+  }
+
+  // Only rendered band and queued ones are kept in memory, rows are rendered in the same order as for the whole image
+  bandHeight = std::min(bandHeight, imageHeight);
+  std::vector<float> bandColors;
+  prepareRendering();
+  for (int firstRow = 0; firstRow < imageHeight; firstRow += bandHeight) {
+    const int rowsCount = std::min(bandHeight, imageHeight - firstRow);
+    // Writer gives back buffer of a written band, which is empty until the first band is written
+    bandColors.resize(imageWidth * bandHeight * 3);
+    renderBand(firstRow, rowsCount, &bandColors[0]);
+    if (!imageWriter.writeBand(bandColors, rowsCount)) {
+      return false;
+    }
+  }
+
+  return imageWriter.close();
 }
 
 /*
 * private:
 */
-void RayTracer::render() {
+void RayTracer::prepareRendering() {
+  mShadowOccluderCache.clear();
+  mRandomGenerator.setSeed(RANDOM_GENERATOR_DEFAULT_SEED);
+}
+
+void RayTracer::renderBand(int firstRow, int rowsCount, float *colors) {
   int imageWidth = mScene->getCamera()->getImageWidth();
-  int imageHeight = mScene->getCamera()->getImageHeight();
   CameraPointer camera = mScene->getCamera();
-  unsigned *renderedImageData = reinterpret_cast< unsigned* >(mRenderedImage.bits());
 
-  for (int y = 0; y < imageHeight; ++y) {
+  for (int y = firstRow; y < firstRow + rowsCount; ++y) {
     for (int x = 0; x < imageWidth; ++x) {
-      RayIntersection intersection;
-
       Ray ray = camera->emitRay(x, y);
-      Color pixelColor = traceRay(ray, 
-                                  0,      // initial recursion depth is 0
-                                  false,  // ray emitted from camera is not reflected
-                                  1.0,    // air refraction coefficient
-                                  1.0,    // initial reflection
-                                  intersection);
+      Color pixelColor;
+      for (int sample = 0; sample < mSamplesPerPixel; ++sample) {
+        RayIntersection intersection;
+        pixelColor += traceRay(ray, 
+                               0,      // initial recursion depth is 0
+                               false,  // ray emitted from camera is not reflected
+                               1.0,    // air refraction coefficient
+                               1.0,    // initial reflection
+                               intersection);
+      }
+      pixelColor *= 1.f / mSamplesPerPixel;
       
-      unsigned char redComponent   = static_cast<unsigned char>(std::min<unsigned>(pixelColor.r * 255, 255));
-      unsigned char greenComponent = static_cast<unsigned char>(std::min<unsigned>(pixelColor.g * 255, 255)); 
-      unsigned char blueComponent  = static_cast<unsigned char>(std::min<unsigned>(pixelColor.b * 255, 255));
-
-      int index = y * imageWidth + x;
-      *(renderedImageData + index) = RGBA(redComponent, greenComponent, blueComponent, 255);
+      // Colors are stored unclamped, tone mapping is done when image is written
+      int index = ((y - firstRow) * imageWidth + x) * 3;
+      colors[index]     = pixelColor.r;
+      colors[index + 1] = pixelColor.g;
+      colors[index + 2] = pixelColor.b;
     }
   }
 }
@@ -86,13 +148,44 @@ Color RayTracer::traceRay(const Ray &ray, int currentRecursionDepth, bool isRayR
   }
 
   Vector intersectionPoint = ray.getPointAt(intersection.distanceFromRayOrigin);
-  ShapePointer shape = intersection.shape;
+  const Shape *shape = intersection.shape;
   MaterialPointer shapeMaterial = shape->getMaterial();
   Vector normal = intersection.normalAtInresectionPoint;
 
-  Color pixelColor = mScene->calculateIlluminationColor(ray, intersection.distanceFromRayOrigin, normal, shapeMaterial);
+  Color pixelColor = mScene->calculateIlluminationColor(ray, intersection.distanceFromRayOrigin, normal, shapeMaterial, 
+                                                        mShadowOccluderCache, mRandomGenerator, mIrradianceCache.isEnabled() ? &mIrradianceCache : NULL);
+
+  // Opaque materials need neither Fresnel coefficient nor secondary rays
+  switch (shapeMaterial->features) {
+    case MATERIAL_FEATURES_OPAQUE:
+      return pixelColor;
+    case MATERIAL_FEATURE_REFLECTIVE:
+      return pixelColor + traceSecondaryRays<MATERIAL_FEATURE_REFLECTIVE>(ray, intersectionPoint, normal, shapeMaterial, 
+                                                                           currentRecursionDepth, environmentDensity, reflectionIntensity);
+    case MATERIAL_FEATURE_REFRACTIVE:
+      return pixelColor + traceSecondaryRays<MATERIAL_FEATURE_REFRACTIVE>(ray, intersectionPoint, normal, shapeMaterial, 
+                                                                           currentRecursionDepth, environmentDensity, reflectionIntensity);
+    case MATERIAL_FEATURE_REFLECTIVE | MATERIAL_FEATURE_REFRACTIVE:
+      return pixelColor + traceSecondaryRays<MATERIAL_FEATURE_REFLECTIVE | MATERIAL_FEATURE_REFRACTIVE>(ray, intersectionPoint, normal, shapeMaterial, 
+                                                                                                         currentRecursionDepth, environmentDensity, reflectionIntensity);
+    case MATERIAL_FEATURE_REFLECTIVE | MATERIAL_FEATURE_SCHLICK_FRESNEL:
+      return pixelColor + traceSecondaryRays<MATERIAL_FEATURE_REFLECTIVE | MATERIAL_FEATURE_SCHLICK_FRESNEL>(ray, intersectionPoint, normal, shapeMaterial, 
+                                                                                                              currentRecursionDepth, environmentDensity, reflectionIntensity);
+    case MATERIAL_FEATURE_REFRACTIVE | MATERIAL_FEATURE_SCHLICK_FRESNEL:
+      return pixelColor + traceSecondaryRays<MATERIAL_FEATURE_REFRACTIVE | MATERIAL_FEATURE_SCHLICK_FRESNEL>(ray, intersectionPoint, normal, shapeMaterial, 
+                                                                                                              currentRecursionDepth, environmentDensity, reflectionIntensity);
+    case MATERIAL_FEATURE_REFLECTIVE | MATERIAL_FEATURE_REFRACTIVE | MATERIAL_FEATURE_SCHLICK_FRESNEL:
+      return pixelColor + traceSecondaryRays<MATERIAL_FEATURE_REFLECTIVE | MATERIAL_FEATURE_REFRACTIVE | MATERIAL_FEATURE_SCHLICK_FRESNEL>(ray, intersectionPoint, normal, shapeMaterial, 
+                                                                                                                                            currentRecursionDepth, environmentDensity, reflectionIntensity);
+  }
 
-  /* Process reflection and refraction */
+  return pixelColor;
+}
+
+template <unsigned materialFeatures>
+Color RayTracer::traceSecondaryRays(const Ray &ray, const Vector &intersectionPoint, const Vector &normal, MaterialPointer shapeMaterial,
+                                    int currentRecursionDepth, float environmentDensity, float reflectionIntensity) {
+  Color secondaryColor;
 
   Vector rayDirection = ray.getDirection();
   float viewProjection = rayDirection.dotProduct(normal);
@@ -104,10 +197,11 @@ Color RayTracer::traceRay(const Ray &ray, int currentRecursionDepth, bool isRayR
 
   // Calculate fresnel factor
   bool isTotalInternalReflection = false;
-  float fresnel = calculateFrenselCoefficient(rayDirection, environmentDensity, shapeMaterial->densityFactor, outNormal, isTotalInternalReflection);
+  float fresnel = calculateFrenselCoefficient<(materialFeatures & MATERIAL_FEATURE_SCHLICK_FRESNEL) != 0>(rayDirection, environmentDensity, shapeMaterial->densityFactor, 
+                                                                                                          outNormal, isTotalInternalReflection);
 
   // Calculate reflection
-  if (shapeMaterial->reflectionFactor > 0.0 && reflectionIntensity > EPS_FOR_REFLECTION_RAYS) {
+  if ((materialFeatures & MATERIAL_FEATURE_REFLECTIVE) && reflectionIntensity > EPS_FOR_REFLECTION_RAYS) {
     // Reflect ray	
     Vector reflectedRayDirection = rayDirection - outNormal * 2.0 * rayDirection.dotProduct(outNormal);
     RayIntersection reflectedRayIntersection;
@@ -118,11 +212,11 @@ Color RayTracer::traceRay(const Ray &ray, int currentRecursionDepth, bool isRayR
                                      reflectionIntensity * shapeMaterial->reflectionFactor,      
                                      reflectedRayIntersection);
     reflectedColor *=  reflectionIntensity * shapeMaterial->reflectionFactor * fresnel;
-    pixelColor += componentwiseProduct(reflectedColor, shapeMaterial->diffuseColor);
+    secondaryColor += componentwiseProduct(reflectedColor, shapeMaterial->diffuseColor);
   }
 
   // Calculate refraction
-  if (shapeMaterial->refractionFactor > 0.0) {
+  if (materialFeatures & MATERIAL_FEATURE_REFRACTIVE) {
     float shapeDensity	= shapeMaterial->densityFactor;
     Vector reflectedRayDirection = claculateRefractedRayDirection(rayDirection, outNormal, environmentDensity, shapeDensity, isTotalInternalReflection);
     if (!isTotalInternalReflection) {
@@ -137,14 +231,15 @@ Color RayTracer::traceRay(const Ray &ray, int currentRecursionDepth, bool isRayR
       if (refractedRayIntersection.rayIntersectsWithShape) {
         Color absorbance   = (shapeMaterial->diffuseColor) * 0.15f * (-refractedRayIntersection.distanceFromRayOrigin);
         Color transparency = Color(expf(absorbance.r), expf(absorbance.g), expf(absorbance.b));
-        pixelColor += componentwiseProduct(refracted,  transparency) * (1.0 - fresnel);
+        secondaryColor += componentwiseProduct(refracted,  transparency) * (1.0 - fresnel);
       }
     }
   }
 
-  return pixelColor;
+  return secondaryColor;
 }
 
+template <bool isSchlickApproximationUsed>
 float RayTracer::calculateFrenselCoefficient(const Vector &sourceDirection, 
                                              float sourceEnvironmentDensity, float targetEnvironmentDensity,
                                              const Vector &outNormal, bool &isTotalInternalReflection) const {
@@ -158,11 +253,10 @@ float RayTracer::calculateFrenselCoefficient(const Vector &sourceDirection,
 	}
   isTotalInternalReflection = false;
 
-  #ifdef CALCULATE_FRENSEL_COEFFICIENT_BY_SHLICK
+  if (isSchlickApproximationUsed) {
     return calculateFrenselCoefficientByShlick(sourceDirection, outNormal, sourceEnvironmentDensity, targetEnvironmentDensity);
-  #else
-    return calculateFrenselCoefficientByFrnsel(sourceEnvironmentDensity, targetEnvironmentDensity, cosThetaTSquared, cosThetaS);
-  #endif
+  }
+  return calculateFrenselCoefficientByFrnsel(sourceEnvironmentDensity, targetEnvironmentDensity, cosThetaTSquared, cosThetaS);
 }
 
 float RayTracer::calculateFrenselCoefficientByFrnsel(float sourceEnvironmentDensity, float targetEnvironmentDensity,
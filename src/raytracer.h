@@ -4,10 +4,14 @@
  */
 #pragma once
 
+#include <vector>
 #include <QString>
-#include <QImage>
   
 #include "scene.h"
+#include "shadowoccludercache.h"
+#include "randomgenerator.h"
+#include "irradiancecache.h"
+#include "asyncimagewriter.h"
 
 class RayTracer {
   public:
@@ -16,15 +20,33 @@ class RayTracer {
 
     void setScene(ScenePointer scene);
     void setImageResolution(int width, int height);
+    // Pixel color is averaged over samples, so that stochastic light sampling converges
+    void setSamplesPerPixel(int samplesCount);
+    // Enables cache of view independent irradiance with records placed at given spacing, the cache is kept between renders
+    void setIrradianceCacheSpacing(float spacing);
     void renderScene();
+    // Image is tone mapped to 8 bits unless it is saved to PFM file, "-" path writes PPM to standard output
     void saveRenderedImageToFile(const QString &filePath);
+    // Renders scene in bands of given height, each band is written to PPM or PFM file on writing thread 
+    // while the next one is rendered, so that memory does not grow with image size
+    bool renderSceneToFile(const QString &filePath, int bandHeight);
+
+    const ShadowOccluderCache &getShadowOccluderCache() const { return mShadowOccluderCache; }
+    const IrradianceCache &getIrradianceCache() const { return mIrradianceCache; }
 
   private:
-    void render();
+    void prepareRendering();
+    // Renders rows of image into colors without clamping, three floats per pixel
+    void renderBand(int firstRow, int rowsCount, float *colors);
     Color traceRay(const Ray &ray, int currentRecursionDepth, bool isRayReflected,
                    float environmentDensity, float reflectionIntencity, 
                    RayIntersection &intersection);
+    // Shading path specialized for set of material features, traces reflected and refracted rays
+    template <unsigned materialFeatures>
+    Color traceSecondaryRays(const Ray &ray, const Vector &intersectionPoint, const Vector &normal, MaterialPointer shapeMaterial,
+                             int currentRecursionDepth, float environmentDensity, float reflectionIntensity);
 
+    template <bool isSchlickApproximationUsed>
     float calculateFrenselCoefficient(const Vector &sourceDirection, 
                                       float sourceEnvironmentDensity, float targetEnvironmentDensity,
                                       const Vector &outNormal, bool &isTotalInternalReflection) const;
@@ -39,6 +61,12 @@ class RayTracer {
 
   private:
     ScenePointer mScene;
-    QImage mRenderedImage;
+    // High dynamic range colors of rendered image, three floats per pixel
+    std::vector<float> mRenderedColors;
+    int mSamplesPerPixel;
+    // Caches and random generator of rendering thread
+    ShadowOccluderCache mShadowOccluderCache;
+    IrradianceCache mIrradianceCache;
+    RandomGenerator mRandomGenerator;
 };
 
@@ -0,0 +1,22 @@
+/*!
+ *\file rectanglelight.cpp
+ *\brief Contains RectangleLight class definition
+ */
+
+#include "rectanglelight.h"
+
+RectangleLight::RectangleLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, 
+                               Vector position, Vector firstEdge, Vector secondEdge, 
+                               float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient)
+  : AreaLight(ambientIntensity, diffuseIntensity, specularIntensity, position, 
+              constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient),
+    mFirstEdge(firstEdge),
+    mSecondEdge(secondEdge) {
+}
+
+RectangleLight::~RectangleLight() {
+}
+
+Vector RectangleLight::sampleSurface(const Vector &point, float u, float v) const {
+  return mPosition + mFirstEdge * (u - 0.5f) + mSecondEdge * (v - 0.5f);
+}
@@ -0,0 +1,28 @@
+/*!
+ *\file rectanglelight.h
+ *\brief Contains RectangleLight class declaration
+ */
+
+#pragma once
+
+#include "arealight.h"
+
+class RectangleLight;
+
+typedef QSharedPointer<RectangleLight> RectangleLightPointer;
+
+class RectangleLight : public AreaLight {
+  public:
+    // Rectangle is spanned by edges centered at light position
+    RectangleLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, 
+                   Vector position, Vector firstEdge, Vector secondEdge, 
+                   float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient);
+    virtual ~RectangleLight();
+
+  protected:
+    virtual Vector sampleSurface(const Vector &point, float u, float v) const;
+
+  private:
+    Vector mFirstEdge;
+    Vector mSecondEdge;
+};
@@ -4,10 +4,15 @@
  */
 
 #include "scene.h"
+#include "mathcommons.h"
 
 Scene::Scene() 
   : mBackgroundMaterial(NULL),
-    mCamera(NULL) {
+    mCamera(NULL),
+    mCompiledScene(NULL),
+    mLightHierarchy(NULL),
+    mLightTree(NULL),
+    mLightSamplesCount(0) {
 }
 
 Scene::~Scene() {
@@ -19,16 +24,32 @@ void Scene::setCamera(CameraPointer camera) {
 
 void Scene::addLightSource(LightSourcePointer lightSource) {
   mLightSources.push_back(lightSource);
+  mAreaLights.push_back(lightSource.dynamicCast<AreaLight>().data());
+  // Light hierarchy and tree are outdated
+  mLightHierarchy = LightHierarchyPointer(NULL);
+  mLightTree = LightTreePointer(NULL);
 }
 
 void Scene::addShape(ShapePointer shape) {
   mShapes.push_back(shape);
+  // Compiled scene is outdated
+  mCompiledScene = CompiledScenePointer(NULL);
 }
 
 void Scene::setBackgroundMaterial(MaterialPointer material) {
   mBackgroundMaterial = material;
 }
 
+void Scene::setLightSamplesCount(int count) {
+  mLightSamplesCount = count;
+}
+
+void Scene::compile() {
+  mCompiledScene = CompiledScenePointer(new CompiledScene(mShapes));
+  mLightHierarchy = LightHierarchyPointer(new LightHierarchy(mLightSources));
+  mLightTree = LightTreePointer(new LightTree(mLightSources));
+}
+
 CameraPointer Scene::getCamera() const {
   return mCamera;
 }
@@ -38,6 +59,10 @@ MaterialPointer Scene::getBackgroundMaterial() const {
 }
 
 RayIntersection Scene::calculateNearestIntersection(const Ray &ray) const {
+  if (mCompiledScene != NULL) {
+    return mCompiledScene->calculateNearestIntersection(ray);
+  }
+
   RayIntersection nearestIntersection;
 
   for each (auto shape in mShapes) {
@@ -55,6 +80,10 @@ RayIntersection Scene::calculateNearestIntersection(const Ray &ray) const {
 }
 
 RayIntersection Scene::calculateFirstIntersection(const Ray &ray) const {
+  if (mCompiledScene != NULL) {
+    return mCompiledScene->calculateFirstIntersection(ray);
+  }
+
   for each (auto shape in mShapes) {
     RayIntersection intersection = shape->intersectWithRay(ray);
     if (intersection.rayIntersectsWithShape) {
@@ -65,12 +94,237 @@ RayIntersection Scene::calculateFirstIntersection(const Ray &ray) const {
   return RayIntersection();
 }
 
-Color Scene::calculateIlluminationColor(const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const {
-  Color illuminationColor;
+unsigned Scene::calculateVisibility(const Ray *rays, int raysCount, ShadowOccluder *occluders) const {
+  if (mCompiledScene != NULL) {
+    return mCompiledScene->calculateVisibility(rays, raysCount, occluders);
+  }
+
+  unsigned visibilityMask = 0;
+  for (int idx = 0; idx < raysCount; ++idx) {
+    bool isOccluded = false;
+    for each (auto shape in mShapes) {
+      RayIntersection intersection = shape->intersectWithRay(rays[idx]);
+      if (intersection.rayIntersectsWithShape && intersection.distanceFromRayOrigin < rays[idx].getMaxDistance()) {
+        if (occluders != NULL) {
+          occluders[idx] = ShadowOccluder(shape.data(), getShapeType(shape.data()));
+        }
+        isOccluded = true;
+        break;
+      }
+    }
+    if (!isOccluded) {
+      visibilityMask |= 1u << idx;
+    }
+  }
+  return visibilityMask;
+}
+
+void Scene::collectLightSources(const Vector &point, std::vector<int> &lightIndices) const {
+  if (mLightHierarchy != NULL) {
+    mLightHierarchy->collectLightSources(point, lightIndices);
+    return;
+  }
+
+  lightIndices.clear();
+  for (int idx = 0, count = mLightSources.size(); idx < count; ++idx) {
+    Vector center;
+    float radius;
+    if (!mLightSources[idx]->getInfluenceSphere(center, radius) || (point - center).lengthSq() <= radius * radius) {
+      lightIndices.push_back(idx);
+    }
+  }
+}
+
+void Scene::sampleLightSources(const Vector &point, const Vector &normal, RandomGenerator &randomGenerator,
+                               std::vector<int> &lightIndices, std::vector<float> &lightWeights) const {
+  lightIndices = mLightTree->getUnpositionedLightIndices();
+  lightWeights.assign(lightIndices.size(), 1.f);
+
+  for (int sample = 0; sample < mLightSamplesCount; ++sample) {
+    float probability;
+    int lightIndex = mLightTree->sampleLightSource(point, normal, randomGenerator.generateFloat(), probability);
+    if (lightIndex < 0) {
+      // Sample reached light sources not affecting the point, it is counted as a sample with zero contribution
+      continue;
+    }
+    lightIndices.push_back(lightIndex);
+    lightWeights.push_back(1.f / (probability * mLightSamplesCount));
+  }
+}
+
+int Scene::traceAreaLightShadowRays(const Ray &ray, float distance, const Vector &normal, const AreaLight &areaLight,
+                                    const int *initialStrata, bool isInitialPass, RandomGenerator &randomGenerator) const {
+  int strataCount = areaLight.getStrataCount();
+  int blockSize = strataCount / AREA_LIGHT_INITIAL_STRATA_COUNT;
+
+  Ray shadowRays[SHADOW_RAYS_BATCH_SIZE];
+  int visibleRaysCount = 0;
+  int shadowRaysCount = 0;
+  for (int stratum = 0, count = strataCount * strataCount; stratum < count; ++stratum) {
+    int stratumX = stratum % strataCount;
+    int stratumY = stratum / strataCount;
+    int block = stratumY / blockSize * AREA_LIGHT_INITIAL_STRATA_COUNT + stratumX / blockSize;
+    bool isTraced = (stratum == initialStrata[block]) == isInitialPass;
+
+    // Surface points below the point horizon are counted as occluded
+    if (isTraced && areaLight.calculateShadowRay(ray, distance, normal, stratumX, stratumY, strataCount,
+                                                 randomGenerator.generateFloat(), randomGenerator.generateFloat(), shadowRays[shadowRaysCount])) {
+      ++shadowRaysCount;
+    }
+
+    if (shadowRaysCount == SHADOW_RAYS_BATCH_SIZE || (stratum == count - 1 && shadowRaysCount > 0)) {
+      for (unsigned visibilityMask = calculateVisibility(shadowRays, shadowRaysCount, NULL); visibilityMask != 0; visibilityMask &= visibilityMask - 1) {
+        ++visibleRaysCount;
+      }
+      shadowRaysCount = 0;
+    }
+  }
+  return visibleRaysCount;
+}
+
+float Scene::calculateAreaLightVisibility(const Ray &ray, float distance, const Vector &normal, const AreaLight &areaLight,
+                                          RandomGenerator &randomGenerator) const {
+  // Diffuse and specular components are shaded from the light center, they are zero if the center is not visible
+  Ray centerShadowRay;
+  if (!areaLight.calculateShadowRay(ray, distance, normal, centerShadowRay)) {
+    return 0.f;
+  }
+
+  // Initial ray of each initial stratum is traced to a random stratum of its block, which is a random point of initial stratum.
+  // The block strata have one ray each then, so the initial rays are counted as part of the full set
+  int strataCount = areaLight.getStrataCount();
+  int blockSize = strataCount / AREA_LIGHT_INITIAL_STRATA_COUNT;
+  int initialStrata[AREA_LIGHT_INITIAL_STRATA_COUNT * AREA_LIGHT_INITIAL_STRATA_COUNT];
+  for (int block = 0; block < AREA_LIGHT_INITIAL_STRATA_COUNT * AREA_LIGHT_INITIAL_STRATA_COUNT; ++block) {
+    int stratumX = block % AREA_LIGHT_INITIAL_STRATA_COUNT * blockSize + std::min(static_cast<int>(randomGenerator.generateFloat() * blockSize), blockSize - 1);
+    int stratumY = block / AREA_LIGHT_INITIAL_STRATA_COUNT * blockSize + std::min(static_cast<int>(randomGenerator.generateFloat() * blockSize), blockSize - 1);
+    initialStrata[block] = stratumY * strataCount + stratumX;
+  }
+
+  int initialRaysCount = AREA_LIGHT_INITIAL_STRATA_COUNT * AREA_LIGHT_INITIAL_STRATA_COUNT;
+  int visibleRaysCount = traceAreaLightShadowRays(ray, distance, normal, areaLight, initialStrata, true, randomGenerator);
+  // Point is fully lit or fully shadowed
+  if (visibleRaysCount == 0 || visibleRaysCount == initialRaysCount) {
+    return static_cast<float>(visibleRaysCount) / initialRaysCount;
+  }
+
+  visibleRaysCount += traceAreaLightShadowRays(ray, distance, normal, areaLight, initialStrata, false, randomGenerator);
+  return static_cast<float>(visibleRaysCount) / (strataCount * strataCount);
+}
+
+Color Scene::calculateIlluminationColor(const Ray &ray, float distance, const Vector &normal, MaterialPointer material, 
+                                        ShadowOccluderCache &occluderCache, RandomGenerator &randomGenerator, IrradianceCache *irradianceCache) const {
+  bool isStochastic;
+  // Light sampling makes every irradiance a random estimation, it can not be cached
+  if (irradianceCache == NULL || isLightSamplingEnabled()) {
+    return calculateIrradiance(ray, distance, normal, material, false, occluderCache, randomGenerator, isStochastic).calculateColor(*material);
+  }
 
-  for each (auto lightSource in mLightSources) {
-    illuminationColor += lightSource->calculateColor(*this, ray, distance, normal, material);
+  // View independent irradiance is interpolated from cache, specular component is always calculated
+  Vector point = ray.getPointAt(distance);
+  LightIrradiance cachedIrradiance;
+  if (irradianceCache->lookup(point, normal, cachedIrradiance.ambient, cachedIrradiance.diffuse)) {
+    if (maxComponent(material->specularColor) > 0.f) {
+      cachedIrradiance.specular = calculateIrradiance(ray, distance, normal, material, true, occluderCache, randomGenerator, isStochastic).specular;
+    }
+    return cachedIrradiance.calculateColor(*material);
   }
 
-  return illuminationColor;
-}
\ No newline at end of file
+  LightIrradiance irradiance = calculateIrradiance(ray, distance, normal, material, false, occluderCache, randomGenerator, isStochastic);
+  // Reused random estimation would freeze its noise into blotches
+  if (isStochastic) {
+    irradianceCache->insertUncacheable(point, normal);
+  } else {
+    irradianceCache->insert(point, normal, irradiance.ambient, irradiance.diffuse);
+  }
+  return irradiance.calculateColor(*material);
+}
+
+LightIrradiance Scene::calculateIrradiance(const Ray &ray, float distance, const Vector &normal, MaterialPointer material, bool isSpecularOnly,
+                                           ShadowOccluderCache &occluderCache, RandomGenerator &randomGenerator, bool &isStochastic) const {
+  LightIrradiance irradiance;
+  LightIrradiance lightIrradiances[SHADOW_RAYS_BATCH_SIZE];
+  Ray shadowRays[SHADOW_RAYS_BATCH_SIZE];
+  ShadowOccluder occluders[SHADOW_RAYS_BATCH_SIZE];
+  // Index of light source shadow ray in batch, -1 if no shadow ray is needed or the ray is occluded by cached occluder
+  int shadowRayIndices[SHADOW_RAYS_BATCH_SIZE];
+
+  // Light sources whose contribution at the point is below their threshold are skipped
+  std::vector<int> lightIndices;
+  std::vector<float> lightWeights;
+  isStochastic = isLightSamplingEnabled();
+  if (isStochastic) {
+    sampleLightSources(ray.getPointAt(distance), normal, randomGenerator, lightIndices, lightWeights);
+  } else {
+    collectLightSources(ray.getPointAt(distance), lightIndices);
+    lightWeights.assign(lightIndices.size(), 1.f);
+  }
+
+  for (int first = 0, count = lightIndices.size(); first < count; first += SHADOW_RAYS_BATCH_SIZE) {
+    int batchSize = std::min(count - first, SHADOW_RAYS_BATCH_SIZE);
+
+    // Gather shadow rays of all light sources and trace them together
+    int shadowRaysCount = 0;
+    for (int idx = 0; idx < batchSize; ++idx) {
+      int lightIndex = lightIndices[first + idx];
+      shadowRayIndices[idx] = -1;
+      lightIrradiances[idx] = mLightSources[lightIndex]->calculateIrradiance(ray, distance, normal, material->specularPower);
+      // Shadow rays are not needed if there is no specular highlight
+      if (isSpecularOnly && maxComponent(lightIrradiances[idx].specular) <= 0.f) {
+        lightIrradiances[idx] = LightIrradiance();
+        continue;
+      }
+
+      Ray &shadowRay = shadowRays[shadowRaysCount];
+      // Area lights trace their own sets of shadow rays
+      if (mAreaLights[lightIndex] != NULL || !mLightSources[lightIndex]->calculateShadowRay(ray, distance, normal, shadowRay)) {
+        continue;
+      }
+
+      // Test the last occluder of the light source first
+      const ShadowOccluder &occluder = occluderCache.getOccluder(lightIndex);
+      bool isOccluded = false;
+      if (occluder.shape != NULL) {
+        RayIntersection intersection = intersectShape(occluder.type, occluder.shape, shadowRay);
+        isOccluded = intersection.rayIntersectsWithShape && intersection.distanceFromRayOrigin < shadowRay.getMaxDistance();
+      }
+      occluderCache.registerLookup(isOccluded);
+
+      if (!isOccluded) {
+        shadowRayIndices[idx] = shadowRaysCount++;
+      }
+    }
+    unsigned visibilityMask = calculateVisibility(shadowRays, shadowRaysCount, occluders);
+
+    for (int idx = 0; idx < batchSize; ++idx) {
+      int lightIndex = lightIndices[first + idx];
+      const LightIrradiance &lightIrradiance = lightIrradiances[idx];
+      float visibility = 0.f;
+      if (mAreaLights[lightIndex] != NULL) {
+        if (!isSpecularOnly || maxComponent(lightIrradiance.specular) > 0.f) {
+          visibility = calculateAreaLightVisibility(ray, distance, normal, *mAreaLights[lightIndex], randomGenerator);
+          // Visibility of point in penumbra is estimated by random shadow rays
+          if (visibility > 0.f && visibility < 1.f) {
+            isStochastic = true;
+          }
+        }
+      } else {
+        int shadowRayIndex = shadowRayIndices[idx];
+        bool isIlluminated = shadowRayIndex >= 0 && (visibilityMask & (1u << shadowRayIndex)) != 0;
+        if (shadowRayIndex >= 0 && !isIlluminated) {
+          occluderCache.setOccluder(lightIndex, occluders[shadowRayIndex]);
+        }
+        visibility = isIlluminated ? 1.f : 0.f;
+      }
+
+      float weight = lightWeights[first + idx];
+      if (!isSpecularOnly) {
+        irradiance.ambient += lightIrradiance.ambient * weight;
+        irradiance.diffuse += lightIrradiance.diffuse * (weight * visibility);
+      }
+      irradiance.specular += lightIrradiance.specular * (weight * visibility);
+    }
+  }
+
+  return irradiance;
+}
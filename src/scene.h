@@ -10,9 +10,15 @@
 
 #include "shape.h"
 #include "lightsource.h"
+#include "arealight.h"
 #include "material.h"
 #include "camera.h"
 #include "rayintersection.h"
+#include "compiledscene.h"
+#include "lighthierarchy.h"
+#include "lighttree.h"
+#include "randomgenerator.h"
+#include "irradiancecache.h"
 
 class Scene;
 
@@ -27,17 +33,58 @@ class Scene {
     void addLightSource(LightSourcePointer lightSource);
     void addShape(ShapePointer shape);
     void setBackgroundMaterial(MaterialPointer material);
+    // Number of light sources sampled by importance per shading point, zero means that all light sources are evaluated
+    void setLightSamplesCount(int count);
+    // Builds compiled representation of scene shapes and light hierarchy used for tracing,
+    // should be called after all shapes and light sources are added
+    void compile();
 
     CameraPointer getCamera() const;
     MaterialPointer getBackgroundMaterial() const;
 
     RayIntersection calculateNearestIntersection(const Ray &ray) const;
     RayIntersection calculateFirstIntersection(const Ray &ray) const;
-    Color calculateIlluminationColor(const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const;
+    // Traces batch of at most SHADOW_RAYS_BATCH_SIZE shadow rays, returns mask of rays which are not occluded.
+    // If occluders array is not NULL, it receives the shape which occluded each ray
+    unsigned calculateVisibility(const Ray *rays, int raysCount, ShadowOccluder *occluders) const;
+    // Only light sources which can affect the point are visited, if light sampling is enabled the result is an unbiased estimation.
+    // If irradiance cache is not NULL, view independent irradiance is interpolated from it when possible,
+    // irradiance estimated by light sampling or random area light shadow rays is not cached.
+    // Caches and random generator should be owned by the calling thread
+    Color calculateIlluminationColor(const Ray &ray, float distance, const Vector &normal, MaterialPointer material,
+                                     ShadowOccluderCache &occluderCache, RandomGenerator &randomGenerator, IrradianceCache *irradianceCache) const;
+
+  private:
+    // Sums irradiance of light sources at the point, shadow rays are traced only for light sources with specular highlight if isSpecularOnly is set.
+    // isStochastic is set if the result is a random estimation, i.e. light sources are sampled or the point is in area light penumbra
+    LightIrradiance calculateIrradiance(const Ray &ray, float distance, const Vector &normal, MaterialPointer material, bool isSpecularOnly,
+                                        ShadowOccluderCache &occluderCache, RandomGenerator &randomGenerator, bool &isStochastic) const;
+    bool isLightSamplingEnabled() const { return mLightSamplesCount > 0 && mLightTree != NULL && !mLightTree->isEmpty(); }
+    // Replaces content of lightIndices with indices of light sources which can affect the point
+    void collectLightSources(const Vector &point, std::vector<int> &lightIndices) const;
+    // Replaces content of lightIndices with light sources sampled by importance and lights without position,
+    // weights are inverted probabilities of samples divided by samples count
+    void sampleLightSources(const Vector &point, const Vector &normal, RandomGenerator &randomGenerator,
+                            std::vector<int> &lightIndices, std::vector<float> &lightWeights) const;
+    // Calculates fraction of area light surface visible from the point. A few stratified shadow rays are traced first,
+    // the rest of full stratified set is traced only if they disagree, i.e. the point lies in penumbra
+    float calculateAreaLightVisibility(const Ray &ray, float distance, const Vector &normal, const AreaLight &areaLight,
+                                       RandomGenerator &randomGenerator) const;
+    // Traces shadow rays to strata of area light grid, the grid is divided into blocks covering initial strata.
+    // Only initial stratum of each block given by initialStrata is traced in initial pass, all other strata are traced otherwise.
+    // Returns the number of unoccluded rays
+    int traceAreaLightShadowRays(const Ray &ray, float distance, const Vector &normal, const AreaLight &areaLight,
+                                 const int *initialStrata, bool isInitialPass, RandomGenerator &randomGenerator) const;
 
   private:
     CameraPointer mCamera;
     std::vector<LightSourcePointer> mLightSources;
+    // Area light of each light source or NULL if light source has no surface
+    std::vector<const AreaLight *> mAreaLights;
     std::vector<ShapePointer> mShapes;
+    CompiledScenePointer mCompiledScene;
+    LightHierarchyPointer mLightHierarchy;
+    LightTreePointer mLightTree;
+    int mLightSamplesCount;
     MaterialPointer mBackgroundMaterial;
 };
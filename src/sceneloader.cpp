@@ -4,7 +4,11 @@
  */
 
 #include <iostream>
+#include <limits.h>
+#include <string.h>
 #include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
 
 #include "sceneloader.h"
 #include "objfilereader.h"
@@ -12,10 +16,35 @@
 #include "csgintersectionoperation.h"
 #include "csgdifferenceoperation.h"
 
+// Minimal number of consecutive spheres, boxes or quadrics to be intersected as a group
+#define MIN_SHAPE_GROUP_SIZE 4
+
 /*
 * public:
 */
 ScenePointer SceneLoader::loadScene(const QString &filePath) const {
+  if (SceneSnapshotReader::isSnapshotFile(filePath)) {
+    if (mSnapshotWriter != NULL) {
+      std::cerr << "Scene at path '" << filePath.toUtf8().constData() << "' is compiled already, XML scene is expected" << std::endl;
+      return ScenePointer(NULL);
+    }
+
+    SceneSnapshotReader reader;
+    if (!reader.open(filePath)) {
+      return ScenePointer(NULL);
+    }
+
+    ScenePointer scene = readSceneSnapshot(reader);
+    if (scene == NULL) {
+      std::cerr << "Failed scene snapshot loading, scene should be compiled again" << std::endl;
+    }
+    return scene;
+  }
+
+  mMeshCache.clear();
+  mLazyMeshCache.clear();
+  mPagedMeshCache.clear();
+
   QFile sceneFile(filePath);
 
   sceneFile.open(QIODevice::ReadOnly);
@@ -24,17 +53,16 @@ ScenePointer SceneLoader::loadScene(const QString &filePath) const {
     return ScenePointer(NULL);
   }
 
-  QDomDocument document;
-  QString errorMessge;
-  int errorLine, errorColumn;
+  QXmlStreamReader reader(&sceneFile);
+  ScenePointer scene = readScene(reader);
+  mMeshCache.clear();
+  mLazyMeshCache.clear();
+  mPagedMeshCache.clear();
 
-  if (!document.setContent(&sceneFile, &errorMessge, &errorLine, &errorColumn)) {
-    std::cerr << "XML parsing error at line " << errorLine << ", column " << errorColumn << ": " << errorMessge.toUtf8().constData() << std::endl;
-    return ScenePointer(NULL);    
+  if (reader.hasError()) {
+    std::cerr << "XML parsing error at line " << reader.lineNumber() << ", column " << reader.columnNumber() << ": " << reader.errorString().toUtf8().constData() << std::endl;
+    return ScenePointer(NULL);
   }
-
-  QDomElement rootElement = document.documentElement();
-  ScenePointer scene = readScene(rootElement);
   if (scene == NULL) {
     std::cerr << "Failed scene file parsing, check scene format" << std::endl;
   }
@@ -45,90 +73,324 @@ ScenePointer SceneLoader::loadScene(const QString &filePath) const {
 /*
 * private:
 */
-ScenePointer SceneLoader::readScene(const QDomNode &rootNode) const {
-  if (rootNode.toElement().tagName() != "scene") {
+ScenePointer SceneLoader::readScene(QXmlStreamReader &reader) const {
+  if (!reader.readNextStartElement()) {
+    return ScenePointer(NULL);
+  }
+  if (reader.name().toString() != "scene") {
     std::cerr << "Scene parsing error: invalid root tag name, 'scene' expected" << std::endl;
     return ScenePointer(NULL);
   }
 
   ScenePointer scene = ScenePointer(new Scene());
+  SceneReadingState state;
 
-  bool isCameraIntialized = false;
-  bool isBackgroundMaterialInitialized = false;
+  // Each child element of the root is read to small DOM tree, which is released as soon as the element is added to scene
+  QDomDocument document;
+  while (reader.readNextStartElement()) {
+    QDomElement element = readElement(reader, document);
+    if (reader.hasError() || !readSceneElement(element, scene, state)) {
+      return ScenePointer(NULL);
+    }
+  }
 
-  QDomElement element = rootNode.firstChildElement();
-  while (!element.isNull()) {
-    QString elementTagName = element.tagName();        
-    
-    if (elementTagName == "camera") {
-      if (isCameraIntialized) {
-        std::cerr << "Scene parsing error: 'camera' tag occurred twice, only one camera is allowed" << std::endl;
-        return ScenePointer(NULL);
-      }            
-      
-      CameraPointer camera = readCamera(element);           
-      if (camera == NULL) {
-        std::cerr << "Scene parsing error: failed camera parameters reading" << std::endl;
+  // Rest of the file is checked to be well-formed
+  while (!reader.atEnd()) {
+    reader.readNext();
+  }
+  if (reader.hasError()) {
+    return ScenePointer(NULL);
+  }
+
+  addSphereGroupToScene(scene, state.spheres);
+  addBoxGroupToScene(scene, state.boxes);
+  addQuadricGroupToScene(scene, state.quadrics);
+  
+  if (!state.isCameraInitialized) {
+    std::cerr << "Scene parsing error: camera parameters are not specified" << std::endl;
+    return ScenePointer(NULL);
+  }
+  if (!state.isBackgroundMaterialInitialized) {
+    std::cerr << "Scene parsing error: background material parameters are not specified" << std::endl;
+    return ScenePointer(NULL);
+  }
+
+  scene->compile();
+  return scene;
+}
+
+ScenePointer SceneLoader::readSceneSnapshot(SceneSnapshotReader &reader) const {
+  ScenePointer scene = ScenePointer(new Scene());
+  SceneReadingState state;
+  std::vector<MaterialPointer> materials;
+  std::vector<IndexedMeshPointer> meshes;
+  // Objects built by records and not taken by their parents yet
+  std::vector<ShapePointer> shapes;
+  std::vector<CSGNodePointer> csgNodes;
+
+  while (reader.readNextRecord()) {
+    SceneSnapshotRecordType recordType = reader.getRecordType();
+
+    if (recordType == SCENE_SNAPSHOT_CAMERA) {
+      Vector position = reader.readVector();
+      Vector up = reader.readVector();
+      Vector lookAt = reader.readVector();
+      float fov = reader.readFloat();
+      float nearPlaneDistance = reader.readFloat();
+      scene->setCamera(CameraPointer(new Camera(position, up, lookAt, fov, nearPlaneDistance)));
+      state.isCameraInitialized = true;
+    } else if (recordType == SCENE_SNAPSHOT_BACKGROUND) {
+      const int materialIndex = reader.readInt();
+      if (materialIndex < 0 || materialIndex >= static_cast<int>(materials.size())) {
+        std::cerr << "Scene snapshot error: invalid material index " << materialIndex << std::endl;
         return ScenePointer(NULL);
       }
-      
-      scene->setCamera(camera);
-      isCameraIntialized = true;
-    } else if (elementTagName == "light") {
-      LightSourcePointer lightSource = readLightSource(element);
-      if (lightSource == NULL) {
-        std::cerr << "Scene parsing error: failed light source parameters reading" << std::endl;
+      scene->setBackgroundMaterial(materials[materialIndex]);
+      state.isBackgroundMaterialInitialized = true;
+    } else if (recordType == SCENE_SNAPSHOT_MATERIAL) {
+      materials.push_back(readSnapshotMaterial(reader));
+    } else if (recordType == SCENE_SNAPSHOT_MESH) {
+      IndexedMeshPointer mesh = readSnapshotMesh(reader);
+      if (mesh == NULL) {
         return ScenePointer(NULL);
       }
-      scene->addLightSource(lightSource);
-    } else if (elementTagName == "object") {
-      ShapePointer shape = readShape(element);
+      meshes.push_back(mesh);
+    } else if (recordType >= SCENE_SNAPSHOT_DIRECTED_LIGHT && recordType <= SCENE_SNAPSHOT_SPHERE_LIGHT) {
+      scene->addLightSource(readSnapshotLightSource(reader));
+    } else if (recordType >= SCENE_SNAPSHOT_PLANE && recordType <= SCENE_SNAPSHOT_MESH_MODEL) {
+      ShapePointer shape = readSnapshotShape(reader, materials, meshes);
       if (shape == NULL) {
-        std::cerr << "Scene parsing error: failed shape parameters reading" << std::endl;
         return ScenePointer(NULL);
       }
-      scene->addShape(shape);
-    } else if (elementTagName == "csg") {
-      CSGTreePointer csgTree = readCSGTree(element);
-      if (csgTree == NULL) {
-        std::cerr << "Scene parsing error: failed CSG tree parameters reading" << std::endl;
+      shapes.push_back(shape);
+    } else if (recordType == SCENE_SNAPSHOT_CSG_SHAPE_NODE && !shapes.empty()) {
+      csgNodes.push_back(CSGShapeNodePointer(new CSGShapeNode(shapes.back())));
+      shapes.pop_back();
+    } else if (recordType == SCENE_SNAPSHOT_CSG_OPERATION && csgNodes.size() >= 2) {
+      CSGNodePointer rightArgument = csgNodes.back();
+      csgNodes.pop_back();
+      CSGNodePointer leftArgument = csgNodes.back();
+      csgNodes.pop_back();
+
+      const int operation = reader.readInt();
+      if (operation == SCENE_SNAPSHOT_CSG_UNION) {
+        csgNodes.push_back(CSGUnionOperationPointer(new CSGUnionOperation(leftArgument, rightArgument)));
+      } else if (operation == SCENE_SNAPSHOT_CSG_INTERSECTION) {
+        csgNodes.push_back(CSGIntersectionOperationPointer(new CSGIntersectionOperation(leftArgument, rightArgument)));
+      } else if (operation == SCENE_SNAPSHOT_CSG_DIFFERENCE) {
+        csgNodes.push_back(CSGDifferenceOperationPointer(new CSGDifferenceOperation(leftArgument, rightArgument)));
+      } else {
+        std::cerr << "Scene snapshot error: unknown CSG operation " << operation << std::endl;
         return ScenePointer(NULL);
       }
-      scene->addShape(csgTree);
-    } else if (elementTagName == "background") {
-      if (isBackgroundMaterialInitialized) {
-        std::cerr << "Scene parsing error: 'background' tag occurred twice" << std::endl;
-        return ScenePointer(NULL);
-      }
-
-      MaterialPointer material = readMaterial(element);
-      if (material == NULL) {
-        std::cerr << "Scene parsing error: failed background material parameters reading" << std::endl;
-        return ScenePointer(NULL);
-      }
-
-      scene->setBackgroundMaterial(material);
-      isBackgroundMaterialInitialized = true;
+    } else if (recordType == SCENE_SNAPSHOT_CSG_TREE && !csgNodes.empty()) {
+      shapes.push_back(CSGTreePointer(new CSGTree(csgNodes.back())));
+      csgNodes.pop_back();
+    } else if (recordType == SCENE_SNAPSHOT_ADD_SHAPE && !shapes.empty()) {
+      addShapeToScene(scene, shapes.back(), state.spheres, state.boxes, state.quadrics);
+      shapes.pop_back();
     } else {
-      std::cerr << "Scene parsing error: unknown tag '" << elementTagName.toUtf8().constData() << "'" << std::endl;
+      std::cerr << "Scene snapshot error: unexpected record of type " << recordType << std::endl;
       return ScenePointer(NULL);
     }
 
-    element = element.nextSiblingElement();
+    if (reader.hasError()) {
+      break;
+    }
   }
-  
-  if (!isCameraIntialized) {
-    std::cerr << "Scene parsing error: camera parameters are not specified" << std::endl;
+
+  if (reader.hasError()) {
+    std::cerr << "Scene snapshot error: file is truncated or corrupted" << std::endl;
     return ScenePointer(NULL);
   }
-  if (!isBackgroundMaterialInitialized) {
-    std::cerr << "Scene parsing error: background material parameters are not specified" << std::endl;
+  if (!state.isCameraInitialized || !state.isBackgroundMaterialInitialized) {
+    std::cerr << "Scene snapshot error: camera or background material is missing" << std::endl;
     return ScenePointer(NULL);
   }
 
+  addSphereGroupToScene(scene, state.spheres);
+  addBoxGroupToScene(scene, state.boxes);
+  addQuadricGroupToScene(scene, state.quadrics);
+
+  // Light hierarchy and shape buckets are built from the loaded objects as for XML scene
+  scene->compile();
   return scene;
 }
 
+QDomElement SceneLoader::readElement(QXmlStreamReader &reader, QDomDocument &document) const {
+  QDomElement element = document.createElement(reader.name().toString());
+  for each (const QXmlStreamAttribute &attribute in reader.attributes()) {
+    element.setAttribute(attribute.name().toString(), attribute.value().toString());
+  }
+
+  // Text content is not used by scene format and is skipped
+  while (reader.readNextStartElement()) {
+    element.appendChild(readElement(reader, document));
+  }
+
+  return element;
+}
+
+bool SceneLoader::readSceneElement(const QDomElement &element, ScenePointer scene, SceneReadingState &state) const {
+  QString elementTagName = element.tagName();
+
+  if (elementTagName == "camera") {
+    if (state.isCameraInitialized) {
+      std::cerr << "Scene parsing error: 'camera' tag occurred twice, only one camera is allowed" << std::endl;
+      return false;
+    }            
+    
+    CameraPointer camera = readCamera(element);           
+    if (camera == NULL) {
+      std::cerr << "Scene parsing error: failed camera parameters reading" << std::endl;
+      return false;
+    }
+    
+    scene->setCamera(camera);
+    state.isCameraInitialized = true;
+  } else if (elementTagName == "light") {
+    LightSourcePointer lightSource = readLightSource(element);
+    if (lightSource == NULL) {
+      std::cerr << "Scene parsing error: failed light source parameters reading" << std::endl;
+      return false;
+    }
+    scene->addLightSource(lightSource);
+  } else if (elementTagName == "object") {
+    ShapePointer shape = readShape(element);
+    if (shape == NULL) {
+      std::cerr << "Scene parsing error: failed shape parameters reading" << std::endl;
+      return false;
+    }
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_ADD_SHAPE);
+      mSnapshotWriter->endRecord();
+    }
+    addShapeToScene(scene, shape, state.spheres, state.boxes, state.quadrics);
+  } else if (elementTagName == "csg") {
+    CSGTreePointer csgTree = readCSGTree(element);
+    if (csgTree == NULL) {
+      std::cerr << "Scene parsing error: failed CSG tree parameters reading" << std::endl;
+      return false;
+    }
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_ADD_SHAPE);
+      mSnapshotWriter->endRecord();
+    }
+    addShapeToScene(scene, csgTree, state.spheres, state.boxes, state.quadrics);
+  } else if (elementTagName == "background") {
+    if (state.isBackgroundMaterialInitialized) {
+      std::cerr << "Scene parsing error: 'background' tag occurred twice" << std::endl;
+      return false;
+    }
+
+    MaterialPointer material = readMaterial(element);
+    if (material == NULL) {
+      std::cerr << "Scene parsing error: failed background material parameters reading" << std::endl;
+      return false;
+    }
+
+    if (mSnapshotWriter != NULL) {
+      const int materialIndex = mSnapshotWriter->writeMaterial(material);
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_BACKGROUND);
+      mSnapshotWriter->writeInt(materialIndex);
+      mSnapshotWriter->endRecord();
+    }
+
+    scene->setBackgroundMaterial(material);
+    state.isBackgroundMaterialInitialized = true;
+  } else {
+    std::cerr << "Scene parsing error: unknown tag '" << elementTagName.toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+void SceneLoader::addShapeToScene(ScenePointer scene, ShapePointer shape, std::vector<SpherePointer> &spheres, std::vector<BoxPointer> &boxes, std::vector<QuadricPointer> &quadrics) const {
+  if (mIsQuadricLoweringEnabled) {
+    QuadricPointer quadric = lowerToQuadric(shape);
+    if (quadric != NULL) {
+      addSphereGroupToScene(scene, spheres);
+      addBoxGroupToScene(scene, boxes);
+      quadrics.push_back(quadric);
+      return;
+    }
+  }
+
+  SpherePointer sphere = shape.dynamicCast<Sphere>();
+  if (sphere != NULL) {
+    addBoxGroupToScene(scene, boxes);
+    addQuadricGroupToScene(scene, quadrics);
+    spheres.push_back(sphere);
+    return;
+  }
+
+  BoxPointer box = shape.dynamicCast<Box>();
+  if (box != NULL) {
+    addSphereGroupToScene(scene, spheres);
+    addQuadricGroupToScene(scene, quadrics);
+    boxes.push_back(box);
+    return;
+  }
+
+  addSphereGroupToScene(scene, spheres);
+  addBoxGroupToScene(scene, boxes);
+  addQuadricGroupToScene(scene, quadrics);
+  scene->addShape(shape);
+}
+
+void SceneLoader::addSphereGroupToScene(ScenePointer scene, std::vector<SpherePointer> &spheres) const {
+  if (spheres.size() >= MIN_SHAPE_GROUP_SIZE) {
+    scene->addShape(SphereGroupPointer(new SphereGroup(spheres)));
+  } else {
+    for each (auto sphere in spheres) {
+      scene->addShape(sphere);
+    }
+  }
+  spheres.clear();
+}
+
+void SceneLoader::addBoxGroupToScene(ScenePointer scene, std::vector<BoxPointer> &boxes) const {
+  if (boxes.size() >= MIN_SHAPE_GROUP_SIZE) {
+    scene->addShape(BoxGroupPointer(new BoxGroup(boxes)));
+  } else {
+    for each (auto box in boxes) {
+      scene->addShape(box);
+    }
+  }
+  boxes.clear();
+}
+
+void SceneLoader::addQuadricGroupToScene(ScenePointer scene, std::vector<QuadricPointer> &quadrics) const {
+  if (quadrics.size() >= MIN_SHAPE_GROUP_SIZE) {
+    scene->addShape(QuadricGroupPointer(new QuadricGroup(quadrics)));
+  } else {
+    for each (auto quadric in quadrics) {
+      scene->addShape(quadric);
+    }
+  }
+  quadrics.clear();
+}
+
+QuadricPointer SceneLoader::lowerToQuadric(ShapePointer shape) const {
+  SpherePointer sphere = shape.dynamicCast<Sphere>();
+  if (sphere != NULL) {
+    return Quadric::createSphere(sphere->getCenter(), sphere->getRadius(), sphere->getMaterial());
+  }
+
+  CylinderPointer cylinder = shape.dynamicCast<Cylinder>();
+  if (cylinder != NULL) {
+    return Quadric::createCylinder(cylinder->getTopCenter(), cylinder->getBottomCenter(), cylinder->getRadius(), cylinder->getMaterial());
+  }
+
+  ConePointer cone = shape.dynamicCast<Cone>();
+  if (cone != NULL) {
+    return Quadric::createCone(cone->getTop(), cone->getBottomCenter(), cone->getRadius(), cone->getMaterial());
+  }
+
+  return QuadricPointer(NULL);
+}
+
 CameraPointer SceneLoader::readCamera(const QDomElement &element) const {
   Vector position;
   Vector up;
@@ -141,6 +403,15 @@ CameraPointer SceneLoader::readCamera(const QDomElement &element) const {
       readChildElementAsVector(element, "look_at", lookAt) && 
       readChildElementAsFloat(element, "fov", "angle", fov) &&
       readChildElementAsFloat(element, "dist_to_near_plane", "dist", nearPlaneDistance)) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_CAMERA);
+      mSnapshotWriter->writeVector(position);
+      mSnapshotWriter->writeVector(up);
+      mSnapshotWriter->writeVector(lookAt);
+      mSnapshotWriter->writeFloat(fov);
+      mSnapshotWriter->writeFloat(nearPlaneDistance);
+      mSnapshotWriter->endRecord();
+    }
     return CameraPointer(new Camera(position, up, lookAt, fov, nearPlaneDistance));
   }
 
@@ -173,6 +444,12 @@ LightSourcePointer SceneLoader::readLightSource(const QDomElement &element) cons
   if (lightSourceType == "spotlight") {
     return readSpotLight(element, ambientIntensity, diffuseIntensity, specularIntensity);
   }
+  if (lightSourceType == "rectangle") {
+    return readRectangleLight(element, ambientIntensity, diffuseIntensity, specularIntensity);
+  }
+  if (lightSourceType == "sphere") {
+    return readSphereLight(element, ambientIntensity, diffuseIntensity, specularIntensity);
+  }
 
   std::cerr << "Scene parsing error: unknown light source type '" << lightSourceType.toUtf8().constData() << "'" << std::endl;
   return LightSourcePointer(NULL);
@@ -182,6 +459,14 @@ DirectedLightPointer SceneLoader::readDirectedLight(const QDomElement &element,
   Vector direction;
 
   if (readChildElementAsVector(element, "dir", direction)) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_DIRECTED_LIGHT);
+      mSnapshotWriter->writeVector(ambientIntensity);
+      mSnapshotWriter->writeVector(diffuseIntensity);
+      mSnapshotWriter->writeVector(specularIntensity);
+      mSnapshotWriter->writeVector(direction);
+      mSnapshotWriter->endRecord();
+    }
     return DirectedLightPointer(new DirectedLight(ambientIntensity, diffuseIntensity, specularIntensity, direction));
   }
 
@@ -193,13 +478,29 @@ PointLightPointer SceneLoader::readPointLight(const QDomElement &element, const
   float constantAttenutaionCoefficient;
   float linearAttenutaionCoefficient;
   float quadraticAttenutaionCoefficient;
+  float contributionThreshold;
 
   if (readChildElementAsVector(element, "pos", position) && 
       readChildElementAsFloat(element, "attenuation", "const", constantAttenutaionCoefficient) &&
       readChildElementAsFloat(element, "attenuation", "linear", linearAttenutaionCoefficient) &&
-      readChildElementAsFloat(element, "attenuation", "quad", quadraticAttenutaionCoefficient)) {
-    return PointLightPointer(new PointLight(ambientIntensity, diffuseIntensity, specularIntensity, position, 
-                                            constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+      readChildElementAsFloat(element, "attenuation", "quad", quadraticAttenutaionCoefficient) &&
+      readContributionThreshold(element, contributionThreshold)) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_POINT_LIGHT);
+      mSnapshotWriter->writeVector(ambientIntensity);
+      mSnapshotWriter->writeVector(diffuseIntensity);
+      mSnapshotWriter->writeVector(specularIntensity);
+      mSnapshotWriter->writeVector(position);
+      mSnapshotWriter->writeFloat(constantAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(linearAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(quadraticAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(contributionThreshold);
+      mSnapshotWriter->endRecord();
+    }
+    PointLightPointer pointLight = PointLightPointer(new PointLight(ambientIntensity, diffuseIntensity, specularIntensity, position, 
+                                                                    constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+    pointLight->setContributionThreshold(contributionThreshold);
+    return pointLight;
   }
   
   return PointLightPointer(NULL);
@@ -214,6 +515,7 @@ SpotLightPointer SceneLoader::readSpotLight(const QDomElement &element, const Co
   float	umbraAngle;
   float	penumbraAngle;
   float	falloffFactor;
+  float contributionThreshold;
   
   if (readChildElementAsVector(element, "pos", position) && 
       readChildElementAsVector(element, "dir", direction) &&
@@ -222,15 +524,152 @@ SpotLightPointer SceneLoader::readSpotLight(const QDomElement &element, const Co
       readChildElementAsFloat(element, "attenuation", "quad", quadraticAttenutaionCoefficient) &&
       readChildElementAsFloat(element, "umbra", "angle", umbraAngle) &&
       readChildElementAsFloat(element, "penumbra", "angle", penumbraAngle) &&
-      readChildElementAsFloat(element, "falloff", "value", falloffFactor)) {
-    return SpotLightPointer(new SpotLight(ambientIntensity, diffuseIntensity, specularIntensity, position, direction, 
-                                          constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient, 
-                                          umbraAngle, penumbraAngle, falloffFactor));
+      readChildElementAsFloat(element, "falloff", "value", falloffFactor) &&
+      readContributionThreshold(element, contributionThreshold)) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_SPOT_LIGHT);
+      mSnapshotWriter->writeVector(ambientIntensity);
+      mSnapshotWriter->writeVector(diffuseIntensity);
+      mSnapshotWriter->writeVector(specularIntensity);
+      mSnapshotWriter->writeVector(position);
+      mSnapshotWriter->writeVector(direction);
+      mSnapshotWriter->writeFloat(constantAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(linearAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(quadraticAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(umbraAngle);
+      mSnapshotWriter->writeFloat(penumbraAngle);
+      mSnapshotWriter->writeFloat(falloffFactor);
+      mSnapshotWriter->writeFloat(contributionThreshold);
+      mSnapshotWriter->endRecord();
+    }
+    SpotLightPointer spotLight = SpotLightPointer(new SpotLight(ambientIntensity, diffuseIntensity, specularIntensity, position, direction, 
+                                                                constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient, 
+                                                                umbraAngle, penumbraAngle, falloffFactor));
+    spotLight->setContributionThreshold(contributionThreshold);
+    return spotLight;
   }
 
   return SpotLightPointer(NULL);
 }
 
+RectangleLightPointer SceneLoader::readRectangleLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const {
+  Vector position;
+  Vector firstEdge;
+  Vector secondEdge;
+  float constantAttenutaionCoefficient;
+  float linearAttenutaionCoefficient;
+  float quadraticAttenutaionCoefficient;
+  float contributionThreshold;
+  int samplesCount;
+
+  if (readChildElementAsVector(element, "pos", position) && 
+      readChildElementAsVector(element, "edge1", firstEdge) &&
+      readChildElementAsVector(element, "edge2", secondEdge) &&
+      readChildElementAsFloat(element, "attenuation", "const", constantAttenutaionCoefficient) &&
+      readChildElementAsFloat(element, "attenuation", "linear", linearAttenutaionCoefficient) &&
+      readChildElementAsFloat(element, "attenuation", "quad", quadraticAttenutaionCoefficient) &&
+      readContributionThreshold(element, contributionThreshold) &&
+      readAreaLightSamplesCount(element, samplesCount)) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_RECTANGLE_LIGHT);
+      mSnapshotWriter->writeVector(ambientIntensity);
+      mSnapshotWriter->writeVector(diffuseIntensity);
+      mSnapshotWriter->writeVector(specularIntensity);
+      mSnapshotWriter->writeVector(position);
+      mSnapshotWriter->writeVector(firstEdge);
+      mSnapshotWriter->writeVector(secondEdge);
+      mSnapshotWriter->writeFloat(constantAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(linearAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(quadraticAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(contributionThreshold);
+      mSnapshotWriter->writeInt(samplesCount);
+      mSnapshotWriter->endRecord();
+    }
+    RectangleLightPointer rectangleLight = RectangleLightPointer(new RectangleLight(ambientIntensity, diffuseIntensity, specularIntensity, position, firstEdge, secondEdge, 
+                                                                                    constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+    rectangleLight->setContributionThreshold(contributionThreshold);
+    rectangleLight->setSamplesCount(samplesCount);
+    return rectangleLight;
+  }
+
+  return RectangleLightPointer(NULL);
+}
+
+SphereLightPointer SceneLoader::readSphereLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const {
+  Vector position;
+  float radius;
+  float constantAttenutaionCoefficient;
+  float linearAttenutaionCoefficient;
+  float quadraticAttenutaionCoefficient;
+  float contributionThreshold;
+  int samplesCount;
+
+  if (readChildElementAsVector(element, "pos", position) && 
+      readChildElementAsFloat(element, "radius", "r", radius) &&
+      readChildElementAsFloat(element, "attenuation", "const", constantAttenutaionCoefficient) &&
+      readChildElementAsFloat(element, "attenuation", "linear", linearAttenutaionCoefficient) &&
+      readChildElementAsFloat(element, "attenuation", "quad", quadraticAttenutaionCoefficient) &&
+      readContributionThreshold(element, contributionThreshold) &&
+      readAreaLightSamplesCount(element, samplesCount)) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_SPHERE_LIGHT);
+      mSnapshotWriter->writeVector(ambientIntensity);
+      mSnapshotWriter->writeVector(diffuseIntensity);
+      mSnapshotWriter->writeVector(specularIntensity);
+      mSnapshotWriter->writeVector(position);
+      mSnapshotWriter->writeFloat(radius);
+      mSnapshotWriter->writeFloat(constantAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(linearAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(quadraticAttenutaionCoefficient);
+      mSnapshotWriter->writeFloat(contributionThreshold);
+      mSnapshotWriter->writeInt(samplesCount);
+      mSnapshotWriter->endRecord();
+    }
+    SphereLightPointer sphereLight = SphereLightPointer(new SphereLight(ambientIntensity, diffuseIntensity, specularIntensity, position, radius, 
+                                                                        constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+    sphereLight->setContributionThreshold(contributionThreshold);
+    sphereLight->setSamplesCount(samplesCount);
+    return sphereLight;
+  }
+
+  return SphereLightPointer(NULL);
+}
+
+bool SceneLoader::readContributionThreshold(const QDomElement &element, float &threshold) const {
+  threshold = 0.f;
+  QDomElement cutoffElement = element.firstChildElement("cutoff");
+  if (cutoffElement.isNull()) {
+    return true;
+  }
+
+  if (!readAttributeAsFloat(cutoffElement, "threshold", threshold)) {
+    return false;
+  }
+  if (threshold < 0.f) {
+    std::cerr << "Scene parsing error: light source cutoff threshold should be non-negative" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool SceneLoader::readAreaLightSamplesCount(const QDomElement &element, int &samplesCount) const {
+  samplesCount = AREA_LIGHT_DEFAULT_SAMPLES_COUNT;
+  if (element.firstChildElement("samples").isNull()) {
+    return true;
+  }
+
+  float count;
+  if (!readChildElementAsFloat(element, "samples", "count", count)) {
+    return false;
+  }
+  if (count < 1.f) {
+    std::cerr << "Scene parsing error: area light samples count should be positive" << std::endl;
+    return false;
+  }
+  samplesCount = static_cast<int>(count);
+  return true;
+}
+
 ShapePointer SceneLoader::readShape(const QDomElement &element) const {
   QString shapeType;
   if (!readAttributeAsString(element, "type", shapeType)) {
@@ -277,6 +716,12 @@ PlanePointer SceneLoader::readPlane(const QDomElement &element, MaterialPointer
 
   if (readChildElementAsVector(element, "normal", normal) && 
       readChildElementAsFloat(element, "D", "d", distance)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_PLANE, material);
+      mSnapshotWriter->writeVector(normal);
+      mSnapshotWriter->writeFloat(distance);
+      mSnapshotWriter->endRecord();
+    }
     return PlanePointer(new Plane(normal, distance, material));
   }
 
@@ -289,6 +734,12 @@ ShapePointer SceneLoader::readSphere(const QDomElement &element, MaterialPointer
 
   if (readChildElementAsVector(element, "center", center) &&
       readChildElementAsFloat(element, "radius", "r", radius)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_SPHERE, material);
+      mSnapshotWriter->writeVector(center);
+      mSnapshotWriter->writeFloat(radius);
+      mSnapshotWriter->endRecord();
+    }
     return SpherePointer(new Sphere(center, radius, material));
   }
 
@@ -303,6 +754,13 @@ CylinderPointer SceneLoader::readCylinder(const QDomElement &element, MaterialPo
   if (readChildElementAsVector(element, "top", topCenter) &&
       readChildElementAsVector(element, "bottom", bottomCenter) &&
       readChildElementAsFloat(element, "radius", "r", radius)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_CYLINDER, material);
+      mSnapshotWriter->writeVector(topCenter);
+      mSnapshotWriter->writeVector(bottomCenter);
+      mSnapshotWriter->writeFloat(radius);
+      mSnapshotWriter->endRecord();
+    }
     return CylinderPointer(new Cylinder(topCenter, bottomCenter, radius, material));
   }
 
@@ -317,6 +775,13 @@ ConePointer SceneLoader::readCone(const QDomElement &element, MaterialPointer ma
   if (readChildElementAsVector(element, "top", top) &&
       readChildElementAsVector(element, "bottom", bottomCenter) &&
       readChildElementAsFloat(element, "radius", "r", radius)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_CONE, material);
+      mSnapshotWriter->writeVector(top);
+      mSnapshotWriter->writeVector(bottomCenter);
+      mSnapshotWriter->writeFloat(radius);
+      mSnapshotWriter->endRecord();
+    }
     return ConePointer(new Cone(top, bottomCenter, radius, material));
   }
 
@@ -331,6 +796,13 @@ TrianglePointer SceneLoader::readTriangle(const QDomElement &element, MaterialPo
   if (readChildElementAsVector(element, "v0", vertex0) &&
       readChildElementAsVector(element, "v1", vertex1) &&
       readChildElementAsVector(element, "v2", vertex2)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_TRIANGLE, material);
+      mSnapshotWriter->writeVector(vertex0);
+      mSnapshotWriter->writeVector(vertex1);
+      mSnapshotWriter->writeVector(vertex2);
+      mSnapshotWriter->endRecord();
+    }
     return TrianglePointer(new Triangle(vertex0, vertex1, vertex2, material));
   }
 
@@ -343,6 +815,12 @@ BoxPointer SceneLoader::readBox(const QDomElement &element, MaterialPointer mate
 
   if (readChildElementAsVector(element, "min", min) &&
       readChildElementAsVector(element, "max", max)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_BOX, material);
+      mSnapshotWriter->writeVector(min);
+      mSnapshotWriter->writeVector(max);
+      mSnapshotWriter->endRecord();
+    }
     return BoxPointer(new Box(min, max, material));
   }
 
@@ -359,6 +837,14 @@ TorusPointer SceneLoader::readTorus(const QDomElement &element, MaterialPointer
       readChildElementAsVector(element, "axis", axis) &&
       readChildElementAsFloat(element, "inner_radius", "r", innerRadius) &&
       readChildElementAsFloat(element, "outer_radius", "r", outerRadius)) {
+    if (mSnapshotWriter != NULL) {
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_TORUS, material);
+      mSnapshotWriter->writeVector(center);
+      mSnapshotWriter->writeVector(axis);
+      mSnapshotWriter->writeFloat(innerRadius);
+      mSnapshotWriter->writeFloat(outerRadius);
+      mSnapshotWriter->endRecord();
+    }
     return TorusPointer(new Torus(center, axis, innerRadius, outerRadius, material));
   }
 
@@ -373,17 +859,103 @@ MeshModelPointer SceneLoader::readMeshModel(const QDomElement &element, Material
   if (readChildElementAsVector(element, "translation", translation) &&
       readChildElementAsVector(element, "scale", scale) &&
       readChildElementAsString(element, "model", "file_name", modelFileName)) {
-    ObjFileReader objFileReader;
-    return objFileReader.readMeshFromObjFile(modelFileName, translation, scale, material);
+    if (scale.x == 0.f || scale.y == 0.f || scale.z == 0.f) {
+      std::cerr << "Scene parsing error: mesh model scale components should be non-zero" << std::endl;
+      return MeshModelPointer(NULL);
+    }
+
+    // Each file is read once, objects referencing it share the mesh with their own transform and material
+    const QString modelFilePath = QFileInfo(modelFileName).absoluteFilePath();
+
+    // Snapshot needs mesh contents, so compiled scene models are neither paged nor lazy
+    if (mMeshPageCache != NULL && mSnapshotWriter == NULL) {
+      PagedMeshPointer pagedMesh = mPagedMeshCache.value(modelFilePath);
+      if (pagedMesh == NULL) {
+        pagedMesh = readPagedMesh(modelFileName);
+        if (pagedMesh == NULL) {
+          return MeshModelPointer(NULL);
+        }
+        mPagedMeshCache.insert(modelFilePath, pagedMesh);
+      }
+      return MeshModelPointer(new MeshModel(pagedMesh, translation, scale, material));
+    }
+
+    QDomElement boundingBoxElement = element.firstChildElement("bounding_box");
+    if (mIsLazyMeshLoadingEnabled && mSnapshotWriter == NULL) {
+      if (!boundingBoxElement.isNull()) {
+        BoundingBox boundingBox;
+        if (!readChildElementAsVector(boundingBoxElement, "min", boundingBox.min) ||
+            !readChildElementAsVector(boundingBoxElement, "max", boundingBox.max)) {
+          return MeshModelPointer(NULL);
+        }
+
+        LazyMeshPointer lazyMesh = mLazyMeshCache.value(modelFilePath);
+        if (lazyMesh == NULL) {
+          lazyMesh = LazyMeshPointer(new LazyMesh(modelFileName, boundingBox, mIsMeshReorderingEnabled));
+          mLazyMeshCache.insert(modelFilePath, lazyMesh);
+        }
+        return MeshModelPointer(new MeshModel(lazyMesh, translation, scale, material));
+      }
+      std::cout << "Mesh model '" << modelFileName.toUtf8().constData() << "' has no 'bounding_box' element and is read at scene loading" << std::endl;
+    }
+
+    IndexedMeshPointer mesh = mMeshCache.value(modelFilePath);
+    if (mesh == NULL) {
+      ObjFileReader objFileReader;
+      objFileReader.setMeshReorderingEnabled(mIsMeshReorderingEnabled);
+      mesh = objFileReader.readMeshFromObjFile(modelFileName);
+      if (mesh == NULL) {
+        return MeshModelPointer(NULL);
+      }
+      mMeshCache.insert(modelFilePath, mesh);
+    }
+
+    if (mSnapshotWriter != NULL) {
+      // Mesh is written as it is after deduplication and reordering of vertices
+      const int meshIndex = mSnapshotWriter->writeMesh(mesh);
+      beginSnapshotShapeRecord(SCENE_SNAPSHOT_MESH_MODEL, material);
+      mSnapshotWriter->writeInt(meshIndex);
+      mSnapshotWriter->writeVector(translation);
+      mSnapshotWriter->writeVector(scale);
+      mSnapshotWriter->endRecord();
+    }
+    return MeshModelPointer(new MeshModel(mesh, translation, scale, material));
   }
   
   return MeshModelPointer(NULL);
 }
 
+PagedMeshPointer SceneLoader::readPagedMesh(const QString &modelFileName) const {
+  const QString pageFilePath = modelFileName + PAGED_MESH_FILE_SUFFIX;
+  QFileInfo pageFileInfo(pageFilePath);
+
+  // Page file is built by separate run, so rendering never needs memory for the whole mesh
+  if (!pageFileInfo.exists()) {
+    std::cerr << "Scene parsing error: mesh page file '" << pageFilePath.toUtf8().constData() << "' is not found, it is built with --build_mesh_pages=" 
+              << modelFileName.toUtf8().constData() << std::endl;
+    return PagedMeshPointer(NULL);
+  }
+  if (pageFileInfo.lastModified() < QFileInfo(modelFileName).lastModified()) {
+    std::cerr << "Scene parsing error: mesh page file '" << pageFilePath.toUtf8().constData() << "' is older than OBJ file, it should be built again with --build_mesh_pages=" 
+              << modelFileName.toUtf8().constData() << std::endl;
+    return PagedMeshPointer(NULL);
+  }
+
+  PagedMeshPointer pagedMesh = PagedMeshPointer(new PagedMesh(mMeshPageCache));
+  if (!pagedMesh->open(pageFilePath)) {
+    return PagedMeshPointer(NULL);
+  }
+  return pagedMesh;
+}
+
 CSGTreePointer SceneLoader::readCSGTree(const QDomElement &element) const {
   CSGNodePointer treeRoot = readCSGNode(element.firstChildElement());
   
   if (treeRoot != NULL) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_CSG_TREE);
+      mSnapshotWriter->endRecord();
+    }
     return CSGTreePointer(new CSGTree(treeRoot));
   }
 
@@ -430,24 +1002,38 @@ CSGBinaryOperationNodePointer SceneLoader::readCSGOperationNode(const QDomElemen
     return CSGBinaryOperationNodePointer(NULL);
   }
 
+  CSGBinaryOperationNodePointer operationNode;
+  SceneSnapshotCSGOperation snapshotOperation;
   if (operationType == "union") {
-    return CSGUnionOperationPointer(new CSGUnionOperation(leftArgument, rightArgument));
-  }
-  if (operationType == "intersection") {
-    return CSGIntersectionOperationPointer(new CSGIntersectionOperation(leftArgument, rightArgument));
-  }
-  if (operationType == "difference") {
-    return CSGDifferenceOperationPointer(new CSGDifferenceOperation(leftArgument, rightArgument));
+    operationNode = CSGUnionOperationPointer(new CSGUnionOperation(leftArgument, rightArgument));
+    snapshotOperation = SCENE_SNAPSHOT_CSG_UNION;
+  } else if (operationType == "intersection") {
+    operationNode = CSGIntersectionOperationPointer(new CSGIntersectionOperation(leftArgument, rightArgument));
+    snapshotOperation = SCENE_SNAPSHOT_CSG_INTERSECTION;
+  } else if (operationType == "difference") {
+    operationNode = CSGDifferenceOperationPointer(new CSGDifferenceOperation(leftArgument, rightArgument));
+    snapshotOperation = SCENE_SNAPSHOT_CSG_DIFFERENCE;
+  } else {
+    std::cerr << "Scene parsing error: unknown CSG operation type '" << operationType.toUtf8().constData() << "'" << std::endl;
+    return CSGBinaryOperationNodePointer(NULL);
   }
 
-  std::cerr << "Scene parsing error: unknown CSG operation type '" << operationType.toUtf8().constData() << "'" << std::endl;
-  return CSGBinaryOperationNodePointer(NULL);
+  if (mSnapshotWriter != NULL) {
+    mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_CSG_OPERATION);
+    mSnapshotWriter->writeInt(snapshotOperation);
+    mSnapshotWriter->endRecord();
+  }
+  return operationNode;
 }
 
 CSGShapeNodePointer SceneLoader::readCSGShapeNode(const QDomElement &element) const {
   ShapePointer shape = readShape(element);
 
   if (shape != NULL) {
+    if (mSnapshotWriter != NULL) {
+      mSnapshotWriter->beginRecord(SCENE_SNAPSHOT_CSG_SHAPE_NODE);
+      mSnapshotWriter->endRecord();
+    }
     return CSGShapeNodePointer(new CSGShapeNode(shape));
   }
 
@@ -472,12 +1058,201 @@ MaterialPointer SceneLoader::readMaterial(const QDomElement &element) const {
       readChildElementAsFloat(materialElement, "illumination_factors", "illumination_factor", material->illuminationFactor) &&
       readChildElementAsFloat(materialElement, "illumination_factors", "reflection_factor", material->reflectionFactor) &&
       readChildElementAsFloat(materialElement, "illumination_factors", "refraction_factor", material->refractionFactor)) {
+        material->updateFeatures();
         return material;
   }
 
   return MaterialPointer(NULL);
 }
 
+void SceneLoader::beginSnapshotShapeRecord(SceneSnapshotRecordType type, MaterialPointer material) const {
+  const int materialIndex = mSnapshotWriter->writeMaterial(material);
+  mSnapshotWriter->beginRecord(type);
+  mSnapshotWriter->writeInt(materialIndex);
+}
+
+MaterialPointer SceneLoader::readSnapshotMaterial(SceneSnapshotReader &reader) const {
+  MaterialPointer material = MaterialPointer(new Material());
+  material->ambientColor = reader.readVector();
+  material->diffuseColor = reader.readVector();
+  material->specularColor = reader.readVector();
+  material->emissiveColor = reader.readVector();
+  material->specularPower = reader.readFloat();
+  material->densityFactor = reader.readFloat();
+  material->illuminationFactor = reader.readFloat();
+  material->reflectionFactor = reader.readFloat();
+  material->refractionFactor = reader.readFloat();
+  material->updateFeatures();
+  return material;
+}
+
+IndexedMeshPointer SceneLoader::readSnapshotMesh(SceneSnapshotReader &reader) const {
+  const int verticesCount = reader.readInt();
+  const int indicesCount = reader.readInt();
+  const int vectorSize = 3 * sizeof(float);
+  if (verticesCount < 0 || verticesCount > INT_MAX / vectorSize ||
+      indicesCount < 0 || indicesCount > INT_MAX / static_cast<int>(sizeof(unsigned)) || indicesCount % 3 != 0) {
+    std::cerr << "Scene snapshot error: invalid mesh size" << std::endl;
+    return IndexedMeshPointer(NULL);
+  }
+
+  IndexedMeshPointer mesh = IndexedMeshPointer(new IndexedMesh());
+  mesh->boundingBox.min = reader.readVector();
+  mesh->boundingBox.max = reader.readVector();
+
+  // Arrays are copied from mapped file as they are, only vectors get padding
+  const char *positionsData = reader.readData(verticesCount * vectorSize);
+  const char *normalsData = reader.readData(verticesCount * vectorSize);
+  const char *indicesData = reader.readData(indicesCount * sizeof(unsigned));
+  if (reader.hasError()) {
+    return IndexedMeshPointer(NULL);
+  }
+
+  mesh->positions.resize(verticesCount);
+  mesh->normals.resize(verticesCount);
+  for (int i = 0; i < verticesCount; ++i) {
+    float coordinates[3];
+    memcpy(coordinates, positionsData + i * vectorSize, vectorSize);
+    mesh->positions[i] = Vector(coordinates[0], coordinates[1], coordinates[2]);
+    memcpy(coordinates, normalsData + i * vectorSize, vectorSize);
+    mesh->normals[i] = Vector(coordinates[0], coordinates[1], coordinates[2]);
+  }
+
+  mesh->indices.resize(indicesCount);
+  if (indicesCount > 0) {
+    memcpy(&mesh->indices[0], indicesData, indicesCount * sizeof(unsigned));
+  }
+  for (int i = 0; i < indicesCount; ++i) {
+    if (mesh->indices[i] >= static_cast<unsigned>(verticesCount)) {
+      std::cerr << "Scene snapshot error: mesh vertex index is out of range" << std::endl;
+      return IndexedMeshPointer(NULL);
+    }
+  }
+
+  return mesh;
+}
+
+LightSourcePointer SceneLoader::readSnapshotLightSource(SceneSnapshotReader &reader) const {
+  const SceneSnapshotRecordType recordType = reader.getRecordType();
+  Color ambientIntensity = reader.readVector();
+  Color diffuseIntensity = reader.readVector();
+  Color specularIntensity = reader.readVector();
+
+  if (recordType == SCENE_SNAPSHOT_DIRECTED_LIGHT) {
+    Vector direction = reader.readVector();
+    return DirectedLightPointer(new DirectedLight(ambientIntensity, diffuseIntensity, specularIntensity, direction));
+  }
+  if (recordType == SCENE_SNAPSHOT_POINT_LIGHT) {
+    Vector position = reader.readVector();
+    float constantAttenutaionCoefficient = reader.readFloat();
+    float linearAttenutaionCoefficient = reader.readFloat();
+    float quadraticAttenutaionCoefficient = reader.readFloat();
+    PointLightPointer pointLight = PointLightPointer(new PointLight(ambientIntensity, diffuseIntensity, specularIntensity, position, 
+                                                                    constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+    pointLight->setContributionThreshold(reader.readFloat());
+    return pointLight;
+  }
+  if (recordType == SCENE_SNAPSHOT_SPOT_LIGHT) {
+    Vector position = reader.readVector();
+    Vector direction = reader.readVector();
+    float constantAttenutaionCoefficient = reader.readFloat();
+    float linearAttenutaionCoefficient = reader.readFloat();
+    float quadraticAttenutaionCoefficient = reader.readFloat();
+    float umbraAngle = reader.readFloat();
+    float penumbraAngle = reader.readFloat();
+    float falloffFactor = reader.readFloat();
+    SpotLightPointer spotLight = SpotLightPointer(new SpotLight(ambientIntensity, diffuseIntensity, specularIntensity, position, direction, 
+                                                                constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient, 
+                                                                umbraAngle, penumbraAngle, falloffFactor));
+    spotLight->setContributionThreshold(reader.readFloat());
+    return spotLight;
+  }
+  if (recordType == SCENE_SNAPSHOT_RECTANGLE_LIGHT) {
+    Vector position = reader.readVector();
+    Vector firstEdge = reader.readVector();
+    Vector secondEdge = reader.readVector();
+    float constantAttenutaionCoefficient = reader.readFloat();
+    float linearAttenutaionCoefficient = reader.readFloat();
+    float quadraticAttenutaionCoefficient = reader.readFloat();
+    RectangleLightPointer rectangleLight = RectangleLightPointer(new RectangleLight(ambientIntensity, diffuseIntensity, specularIntensity, position, firstEdge, secondEdge, 
+                                                                                    constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+    rectangleLight->setContributionThreshold(reader.readFloat());
+    rectangleLight->setSamplesCount(reader.readInt());
+    return rectangleLight;
+  }
+
+  Vector position = reader.readVector();
+  float radius = reader.readFloat();
+  float constantAttenutaionCoefficient = reader.readFloat();
+  float linearAttenutaionCoefficient = reader.readFloat();
+  float quadraticAttenutaionCoefficient = reader.readFloat();
+  SphereLightPointer sphereLight = SphereLightPointer(new SphereLight(ambientIntensity, diffuseIntensity, specularIntensity, position, radius, 
+                                                                      constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient));
+  sphereLight->setContributionThreshold(reader.readFloat());
+  sphereLight->setSamplesCount(reader.readInt());
+  return sphereLight;
+}
+
+ShapePointer SceneLoader::readSnapshotShape(SceneSnapshotReader &reader, const std::vector<MaterialPointer> &materials, const std::vector<IndexedMeshPointer> &meshes) const {
+  const SceneSnapshotRecordType recordType = reader.getRecordType();
+  const int materialIndex = reader.readInt();
+  if (materialIndex < 0 || materialIndex >= static_cast<int>(materials.size())) {
+    std::cerr << "Scene snapshot error: invalid material index " << materialIndex << std::endl;
+    return ShapePointer(NULL);
+  }
+  MaterialPointer material = materials[materialIndex];
+
+  if (recordType == SCENE_SNAPSHOT_PLANE) {
+    Vector normal = reader.readVector();
+    float distance = reader.readFloat();
+    return PlanePointer(new Plane(normal, distance, material));
+  }
+  if (recordType == SCENE_SNAPSHOT_SPHERE) {
+    Vector center = reader.readVector();
+    float radius = reader.readFloat();
+    return SpherePointer(new Sphere(center, radius, material));
+  }
+  if (recordType == SCENE_SNAPSHOT_CYLINDER) {
+    Vector topCenter = reader.readVector();
+    Vector bottomCenter = reader.readVector();
+    float radius = reader.readFloat();
+    return CylinderPointer(new Cylinder(topCenter, bottomCenter, radius, material));
+  }
+  if (recordType == SCENE_SNAPSHOT_CONE) {
+    Vector top = reader.readVector();
+    Vector bottomCenter = reader.readVector();
+    float radius = reader.readFloat();
+    return ConePointer(new Cone(top, bottomCenter, radius, material));
+  }
+  if (recordType == SCENE_SNAPSHOT_TRIANGLE) {
+    Vector vertex0 = reader.readVector();
+    Vector vertex1 = reader.readVector();
+    Vector vertex2 = reader.readVector();
+    return TrianglePointer(new Triangle(vertex0, vertex1, vertex2, material));
+  }
+  if (recordType == SCENE_SNAPSHOT_BOX) {
+    Vector min = reader.readVector();
+    Vector max = reader.readVector();
+    return BoxPointer(new Box(min, max, material));
+  }
+  if (recordType == SCENE_SNAPSHOT_TORUS) {
+    Vector center = reader.readVector();
+    Vector axis = reader.readVector();
+    float innerRadius = reader.readFloat();
+    float outerRadius = reader.readFloat();
+    return TorusPointer(new Torus(center, axis, innerRadius, outerRadius, material));
+  }
+
+  const int meshIndex = reader.readInt();
+  if (meshIndex < 0 || meshIndex >= static_cast<int>(meshes.size())) {
+    std::cerr << "Scene snapshot error: invalid mesh index " << meshIndex << std::endl;
+    return ShapePointer(NULL);
+  }
+  Vector translation = reader.readVector();
+  Vector scale = reader.readVector();
+  return MeshModelPointer(new MeshModel(meshes[meshIndex], translation, scale, material));
+}
+
 bool SceneLoader::readVector(const QDomElement &element, Vector &vector) const {  
   if (readAttributeAsFloat(element, "x", vector.x) && 
       readAttributeAsFloat(element, "y", vector.y) && 
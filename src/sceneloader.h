@@ -6,32 +6,86 @@
 #pragma once
 
 #include <QDomDocument>
+#include <QHash>
+#include <QXmlStreamReader>
 
 #include "scene.h"
 #include "directedlight.h"
 #include "pointlight.h"
 #include "spotlight.h"
+#include "rectanglelight.h"
+#include "spherelight.h"
 #include "plane.h"
 #include "sphere.h"
+#include "spheregroup.h"
 #include "cylinder.h"
 #include "cone.h"
 #include "triangle.h"
 #include "box.h"
+#include "boxgroup.h"
+#include "quadric.h"
+#include "quadricgroup.h"
 #include "torus.h"
 #include "meshmodel.h"
+#include "lazymesh.h"
+#include "pagedmesh.h"
 #include "csgtree.h"
 #include "csgbinaryoperationnode.h"
 #include "csgshapenode.h"
+#include "scenesnapshot.h"
 
+/*!
+ * State of scene reading carried between children of scene root element.
+ */
+struct SceneReadingState {
+  SceneReadingState() : isCameraInitialized(false), isBackgroundMaterialInitialized(false) {}
+
+  bool isCameraInitialized;
+  bool isBackgroundMaterialInitialized;
+  // Consecutive spheres, boxes and lowered quadrics which are not added to scene yet
+  std::vector<SpherePointer> spheres;
+  std::vector<BoxPointer> boxes;
+  std::vector<QuadricPointer> quadrics;
+};
+
+/*!
+ * Reads scene from XML file or from binary scene snapshot.
+ * File is read by streaming reader, shapes, lights and materials are built as their elements arrive,
+ * so that only one child element of scene root is kept in memory as DOM tree.
+ * Objects built from XML may be recorded to snapshot writer, snapshot is loaded by replaying its records
+ * through the same constructors, so grouping and lowering of shapes are applied at snapshot loading as well.
+ */
 class SceneLoader {
   public:
-    SceneLoader() {}
+    SceneLoader() : mIsQuadricLoweringEnabled(false), mIsMeshReorderingEnabled(false), mIsLazyMeshLoadingEnabled(false), mSnapshotWriter(NULL) {}
     virtual ~SceneLoader() {}
 
     ScenePointer loadScene(const QString &filePath) const;
+    // Enables lowering of spheres, cylinders and cones to clipped quadrics intersected in groups
+    void setQuadricLoweringEnabled(bool isEnabled) { mIsQuadricLoweringEnabled = isEnabled; }
+    // Enables reordering of mesh model triangles and vertices for memory locality
+    void setMeshReorderingEnabled(bool isEnabled) { mIsMeshReorderingEnabled = isEnabled; }
+    // Enables deferred reading of mesh models with bounding box given in scene until they are hit by a ray
+    void setLazyMeshLoadingEnabled(bool isEnabled) { mIsLazyMeshLoadingEnabled = isEnabled; }
+    // Sets cache of mesh pages, mesh models are read from page files on request if the cache is set
+    void setMeshPageCache(MeshPageCachePointer pageCache) { mMeshPageCache = pageCache; }
+    // Sets writer objects built while reading XML scene are recorded to, snapshots are not recorded
+    void setSnapshotWriter(SceneSnapshotWriter *writer) { mSnapshotWriter = writer; }
 
   private:
-    ScenePointer readScene(const QDomNode &rootNode) const;
+    ScenePointer readScene(QXmlStreamReader &reader) const;
+    ScenePointer readSceneSnapshot(SceneSnapshotReader &reader) const;
+    // Reads element the reader is positioned at with its subelements
+    QDomElement readElement(QXmlStreamReader &reader, QDomDocument &document) const;
+    // Reads child element of scene root and adds its contents to scene
+    bool readSceneElement(const QDomElement &element, ScenePointer scene, SceneReadingState &state) const;
+
+    void addShapeToScene(ScenePointer scene, ShapePointer shape, std::vector<SpherePointer> &spheres, std::vector<BoxPointer> &boxes, std::vector<QuadricPointer> &quadrics) const;
+    void addSphereGroupToScene(ScenePointer scene, std::vector<SpherePointer> &spheres) const;
+    void addBoxGroupToScene(ScenePointer scene, std::vector<BoxPointer> &boxes) const;
+    void addQuadricGroupToScene(ScenePointer scene, std::vector<QuadricPointer> &quadrics) const;
+    // Returns quadric equivalent to the shape or NULL if the shape can not be lowered
+    QuadricPointer lowerToQuadric(ShapePointer shape) const;
 
     CameraPointer readCamera(const QDomElement &element) const;
     LightSourcePointer readLightSource(const QDomElement &element) const;
@@ -42,6 +96,12 @@ class SceneLoader {
     DirectedLightPointer readDirectedLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const;
     PointLightPointer readPointLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const;
     SpotLightPointer readSpotLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const;
+    RectangleLightPointer readRectangleLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const;
+    SphereLightPointer readSphereLight(const QDomElement &element, const Color &ambientIntensity, const Color &diffuseIntensity, const Color &specularIntensity) const;
+    // Reads optional 'cutoff' child element, threshold is zero if there is no such element
+    bool readContributionThreshold(const QDomElement &element, float &threshold) const;
+    // Reads optional 'samples' child element, count is AREA_LIGHT_DEFAULT_SAMPLES_COUNT if there is no such element
+    bool readAreaLightSamplesCount(const QDomElement &element, int &samplesCount) const;
 
     PlanePointer readPlane(const QDomElement &element, MaterialPointer material) const;
     ShapePointer readSphere(const QDomElement &element, MaterialPointer material) const;
@@ -51,15 +111,36 @@ class SceneLoader {
     BoxPointer readBox(const QDomElement &element, MaterialPointer material) const;
     TorusPointer readTorus(const QDomElement &element, MaterialPointer material) const;
     MeshModelPointer readMeshModel(const QDomElement &element, MaterialPointer material) const;
+    // Opens page file of OBJ file, fails if page file is missing or older than OBJ file
+    PagedMeshPointer readPagedMesh(const QString &modelFileName) const;
 
     CSGNodePointer readCSGNode(const QDomElement &element) const;
     CSGBinaryOperationNodePointer readCSGOperationNode(const QDomElement &element) const;
     CSGShapeNodePointer readCSGShapeNode(const QDomElement &element) const;
 
+    // Writes material of shape and begins shape record referencing it
+    void beginSnapshotShapeRecord(SceneSnapshotRecordType type, MaterialPointer material) const;
+
+    MaterialPointer readSnapshotMaterial(SceneSnapshotReader &reader) const;
+    IndexedMeshPointer readSnapshotMesh(SceneSnapshotReader &reader) const;
+    LightSourcePointer readSnapshotLightSource(SceneSnapshotReader &reader) const;
+    ShapePointer readSnapshotShape(SceneSnapshotReader &reader, const std::vector<MaterialPointer> &materials, const std::vector<IndexedMeshPointer> &meshes) const;
+
     bool readVector(const QDomElement &element, Vector &vector) const;
     bool readAttributeAsFloat(const QDomElement &element, const QString &attributeName, float &value) const;
     bool readAttributeAsString(const QDomElement &element, const QString &attributeName, QString &value) const;
     bool readChildElementAsVector(const QDomElement &element, const QString &childElementName, Vector &vector) const;
     bool readChildElementAsFloat(const QDomElement &element, const QString &childElementName, const QString &attributeName, float &value) const;
     bool readChildElementAsString(const QDomElement &element, const QString &childElementName, const QString &attributeName, QString &value) const;
+
+  private:
+    bool mIsQuadricLoweringEnabled;
+    bool mIsMeshReorderingEnabled;
+    bool mIsLazyMeshLoadingEnabled;
+    // Meshes read while loading scene by absolute file path
+    mutable QHash<QString, IndexedMeshPointer> mMeshCache;
+    mutable QHash<QString, LazyMeshPointer> mLazyMeshCache;
+    mutable QHash<QString, PagedMeshPointer> mPagedMeshCache;
+    MeshPageCachePointer mMeshPageCache;
+    SceneSnapshotWriter *mSnapshotWriter;
 };
\ No newline at end of file
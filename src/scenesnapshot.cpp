@@ -0,0 +1,300 @@
+/*!
+ *\file scenesnapshot.cpp
+ *\brief Contains SceneSnapshotWriter and SceneSnapshotReader classes definition
+ */
+
+#include <iostream>
+#include <string.h>
+
+#include "scenesnapshot.h"
+
+// Size of record type and payload size preceding record payload
+#define SCENE_SNAPSHOT_RECORD_HEADER_SIZE (2 * sizeof(quint32))
+
+// Vector equality operator has tolerance, materials are merged only if they are exactly equal
+static bool areColorsEqual(const Color &first, const Color &second) {
+  return first.x == second.x && first.y == second.y && first.z == second.z;
+}
+
+static bool areMaterialsEqual(const Material &first, const Material &second) {
+  return areColorsEqual(first.ambientColor, second.ambientColor) &&
+         areColorsEqual(first.diffuseColor, second.diffuseColor) &&
+         areColorsEqual(first.specularColor, second.specularColor) &&
+         areColorsEqual(first.emissiveColor, second.emissiveColor) &&
+         first.specularPower == second.specularPower &&
+         first.densityFactor == second.densityFactor &&
+         first.illuminationFactor == second.illuminationFactor &&
+         first.reflectionFactor == second.reflectionFactor &&
+         first.refractionFactor == second.refractionFactor;
+}
+
+// Combines bit patterns of values compared by areMaterialsEqual, zeros of both signs are equal so they are hashed alike
+static void combineFloatHash(uint &hash, float value) {
+  quint32 bits = 0;
+  if (value != 0.f) {
+    memcpy(&bits, &value, sizeof(bits));
+  }
+  hash = hash * 31 + bits;
+}
+
+static void combineColorHash(uint &hash, const Color &color) {
+  combineFloatHash(hash, color.x);
+  combineFloatHash(hash, color.y);
+  combineFloatHash(hash, color.z);
+}
+
+static uint calculateMaterialHash(const Material &material) {
+  uint hash = 0;
+  combineColorHash(hash, material.ambientColor);
+  combineColorHash(hash, material.diffuseColor);
+  combineColorHash(hash, material.specularColor);
+  combineColorHash(hash, material.emissiveColor);
+  combineFloatHash(hash, material.specularPower);
+  combineFloatHash(hash, material.densityFactor);
+  combineFloatHash(hash, material.illuminationFactor);
+  combineFloatHash(hash, material.reflectionFactor);
+  combineFloatHash(hash, material.refractionFactor);
+  return hash;
+}
+
+/*
+* SceneSnapshotWriter public:
+*/
+SceneSnapshotWriter::SceneSnapshotWriter() : mRecordOffset(-1) {
+  SceneSnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  strcpy(header.magic, SCENE_SNAPSHOT_MAGIC);
+  header.version = SCENE_SNAPSHOT_VERSION;
+  header.byteOrderMark = SCENE_SNAPSHOT_BYTE_ORDER_MARK;
+  mData.append(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+int SceneSnapshotWriter::writeMaterial(MaterialPointer material) {
+  const uint materialHash = calculateMaterialHash(*material);
+  for (QMultiHash<uint, int>::const_iterator materialIndex = mMaterialIndices.constFind(materialHash);
+       materialIndex != mMaterialIndices.constEnd() && materialIndex.key() == materialHash; ++materialIndex) {
+    if (areMaterialsEqual(*mMaterials[materialIndex.value()], *material)) {
+      return materialIndex.value();
+    }
+  }
+
+  beginRecord(SCENE_SNAPSHOT_MATERIAL);
+  writeVector(material->ambientColor);
+  writeVector(material->diffuseColor);
+  writeVector(material->specularColor);
+  writeVector(material->emissiveColor);
+  writeFloat(material->specularPower);
+  writeFloat(material->densityFactor);
+  writeFloat(material->illuminationFactor);
+  writeFloat(material->reflectionFactor);
+  writeFloat(material->refractionFactor);
+  endRecord();
+
+  const int index = mMaterials.size();
+  mMaterials.push_back(material);
+  mMaterialIndices.insert(materialHash, index);
+  return index;
+}
+
+int SceneSnapshotWriter::writeMesh(IndexedMeshPointer mesh) {
+  QHash<const IndexedMesh *, int>::const_iterator meshIndex = mMeshIndices.constFind(mesh.data());
+  if (meshIndex != mMeshIndices.constEnd()) {
+    return meshIndex.value();
+  }
+
+  beginRecord(SCENE_SNAPSHOT_MESH);
+  writeInt(mesh->positions.size());
+  writeInt(mesh->indices.size());
+  writeVector(mesh->boundingBox.min);
+  writeVector(mesh->boundingBox.max);
+  // Vectors are written without padding, so that layout does not depend on vector type
+  for (size_t i = 0; i < mesh->positions.size(); ++i) {
+    writeVector(mesh->positions[i]);
+  }
+  for (size_t i = 0; i < mesh->normals.size(); ++i) {
+    writeVector(mesh->normals[i]);
+  }
+  if (!mesh->indices.empty()) {
+    writeData(&mesh->indices[0], mesh->indices.size() * sizeof(unsigned));
+  }
+  endRecord();
+
+  const int index = mMeshIndices.size();
+  mMeshIndices.insert(mesh.data(), index);
+  return index;
+}
+
+void SceneSnapshotWriter::beginRecord(SceneSnapshotRecordType type) {
+  mRecordOffset = mData.size();
+  const quint32 recordHeader[2] = { static_cast<quint32>(type), 0 };
+  mData.append(reinterpret_cast<const char *>(recordHeader), sizeof(recordHeader));
+}
+
+void SceneSnapshotWriter::writeInt(int value) {
+  const qint32 storedValue = value;
+  mData.append(reinterpret_cast<const char *>(&storedValue), sizeof(storedValue));
+}
+
+void SceneSnapshotWriter::writeFloat(float value) {
+  mData.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void SceneSnapshotWriter::writeVector(const Vector &vector) {
+  writeFloat(vector.x);
+  writeFloat(vector.y);
+  writeFloat(vector.z);
+}
+
+void SceneSnapshotWriter::writeData(const void *data, int size) {
+  mData.append(reinterpret_cast<const char *>(data), size);
+  // Payload is padded to 32-bit values
+  const int paddingSize = (4 - size % 4) % 4;
+  const char padding[4] = { 0, 0, 0, 0 };
+  mData.append(padding, paddingSize);
+}
+
+void SceneSnapshotWriter::endRecord() {
+  const quint32 payloadSize = mData.size() - mRecordOffset - SCENE_SNAPSHOT_RECORD_HEADER_SIZE;
+  memcpy(mData.data() + mRecordOffset + sizeof(quint32), &payloadSize, sizeof(payloadSize));
+  mRecordOffset = -1;
+}
+
+bool SceneSnapshotWriter::saveToFile(const QString &filePath) const {
+  QFile snapshotFile(filePath);
+
+  if (!snapshotFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    std::cerr << "Unable to open file at path '" << filePath.toUtf8().constData() << "' for writing" << std::endl;
+    return false;
+  }
+  if (snapshotFile.write(mData) != mData.size()) {
+    std::cerr << "Unable to write scene snapshot to file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
+/*
+* SceneSnapshotReader public:
+*/
+SceneSnapshotReader::SceneSnapshotReader()
+  : mCursor(NULL),
+    mEnd(NULL),
+    mRecordEnd(NULL),
+    mRecordType(SCENE_SNAPSHOT_CAMERA),
+    mHasError(false) {
+}
+
+bool SceneSnapshotReader::isSnapshotFile(const QString &filePath) {
+  QFile file(filePath);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  char magic[sizeof(SCENE_SNAPSHOT_MAGIC)];
+  return file.read(magic, sizeof(magic)) == sizeof(magic) && memcmp(magic, SCENE_SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+bool SceneSnapshotReader::open(const QString &filePath) {
+  mFile.setFileName(filePath);
+  if (!mFile.open(QIODevice::ReadOnly)) {
+    std::cerr << "Unable to open file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+
+  const qint64 fileSize = mFile.size();
+  SceneSnapshotHeader header;
+  if (fileSize < static_cast<qint64>(sizeof(header))) {
+    std::cerr << "Scene snapshot error: file is truncated" << std::endl;
+    return false;
+  }
+
+  const char *fileContents = reinterpret_cast<const char *>(mFile.map(0, fileSize));
+  if (fileContents == NULL) {
+    std::cerr << "Scene snapshot error: unable to map file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+
+  memcpy(&header, fileContents, sizeof(header));
+  if (memcmp(header.magic, SCENE_SNAPSHOT_MAGIC, sizeof(SCENE_SNAPSHOT_MAGIC)) != 0) {
+    std::cerr << "Scene snapshot error: file is not a scene snapshot" << std::endl;
+    return false;
+  }
+  if (header.byteOrderMark != SCENE_SNAPSHOT_BYTE_ORDER_MARK) {
+    std::cerr << "Scene snapshot error: snapshot is written on machine with different byte order" << std::endl;
+    return false;
+  }
+  if (header.version != SCENE_SNAPSHOT_VERSION) {
+    std::cerr << "Scene snapshot error: snapshot version " << header.version << " is not supported, version "
+              << SCENE_SNAPSHOT_VERSION << " is expected, scene should be compiled again" << std::endl;
+    return false;
+  }
+
+  mCursor = fileContents + sizeof(header);
+  mEnd = fileContents + fileSize;
+  mRecordEnd = mCursor;
+  return true;
+}
+
+bool SceneSnapshotReader::readNextRecord() {
+  // Unread rest of the previous record is skipped
+  mCursor = mRecordEnd;
+  if (mHasError || mCursor == mEnd) {
+    return false;
+  }
+
+  quint32 recordHeader[2];
+  if (mEnd - mCursor < static_cast<ptrdiff_t>(sizeof(recordHeader))) {
+    mHasError = true;
+    return false;
+  }
+  memcpy(recordHeader, mCursor, sizeof(recordHeader));
+  mCursor += sizeof(recordHeader);
+
+  if (recordHeader[1] > static_cast<quint32>(mEnd - mCursor)) {
+    mHasError = true;
+    return false;
+  }
+  mRecordType = static_cast<SceneSnapshotRecordType>(recordHeader[0]);
+  mRecordEnd = mCursor + recordHeader[1];
+  return true;
+}
+
+int SceneSnapshotReader::readInt() {
+  qint32 value = 0;
+  const char *data = readData(sizeof(value));
+  if (data != NULL) {
+    memcpy(&value, data, sizeof(value));
+  }
+  return value;
+}
+
+float SceneSnapshotReader::readFloat() {
+  float value = 0.f;
+  const char *data = readData(sizeof(value));
+  if (data != NULL) {
+    memcpy(&value, data, sizeof(value));
+  }
+  return value;
+}
+
+Vector SceneSnapshotReader::readVector() {
+  float coordinates[3] = { 0.f, 0.f, 0.f };
+  const char *data = readData(sizeof(coordinates));
+  if (data != NULL) {
+    memcpy(coordinates, data, sizeof(coordinates));
+  }
+  return Vector(coordinates[0], coordinates[1], coordinates[2]);
+}
+
+const char *SceneSnapshotReader::readData(int size) {
+  const int paddedSize = (size + 3) / 4 * 4;
+  if (size < 0 || paddedSize > mRecordEnd - mCursor) {
+    mHasError = true;
+    return NULL;
+  }
+
+  const char *data = mCursor;
+  mCursor += paddedSize;
+  return data;
+}
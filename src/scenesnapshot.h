@@ -0,0 +1,136 @@
+/*!
+ *\file scenesnapshot.h
+ *\brief Contains SceneSnapshotWriter and SceneSnapshotReader classes declaration
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+
+#include "types.h"
+#include "material.h"
+#include "meshmodel.h"
+
+#define SCENE_SNAPSHOT_MAGIC "RTSCENE"
+// Should be incremented whenever layout of any record changes
+#define SCENE_SNAPSHOT_VERSION 1
+// Written in native byte order, snapshot is rejected on machine with other byte order
+#define SCENE_SNAPSHOT_BYTE_ORDER_MARK 0x01020304
+
+/*!
+ * Types of snapshot records.
+ * Records are written in order objects are built by scene loader, so that children of CSG trees precede their parents.
+ * Shape records push shape to stack of loaded objects, CSG and 'add shape' records take their arguments from the stack.
+ */
+enum SceneSnapshotRecordType {
+  SCENE_SNAPSHOT_CAMERA = 1,
+  SCENE_SNAPSHOT_BACKGROUND,
+  // Definitions referenced by index in order of their appearance
+  SCENE_SNAPSHOT_MATERIAL,
+  SCENE_SNAPSHOT_MESH,
+  SCENE_SNAPSHOT_DIRECTED_LIGHT,
+  SCENE_SNAPSHOT_POINT_LIGHT,
+  SCENE_SNAPSHOT_SPOT_LIGHT,
+  SCENE_SNAPSHOT_RECTANGLE_LIGHT,
+  SCENE_SNAPSHOT_SPHERE_LIGHT,
+  SCENE_SNAPSHOT_PLANE,
+  SCENE_SNAPSHOT_SPHERE,
+  SCENE_SNAPSHOT_CYLINDER,
+  SCENE_SNAPSHOT_CONE,
+  SCENE_SNAPSHOT_TRIANGLE,
+  SCENE_SNAPSHOT_BOX,
+  SCENE_SNAPSHOT_TORUS,
+  SCENE_SNAPSHOT_MESH_MODEL,
+  SCENE_SNAPSHOT_CSG_SHAPE_NODE,
+  SCENE_SNAPSHOT_CSG_OPERATION,
+  SCENE_SNAPSHOT_CSG_TREE,
+  SCENE_SNAPSHOT_ADD_SHAPE
+};
+
+enum SceneSnapshotCSGOperation {
+  SCENE_SNAPSHOT_CSG_UNION = 1,
+  SCENE_SNAPSHOT_CSG_INTERSECTION,
+  SCENE_SNAPSHOT_CSG_DIFFERENCE
+};
+
+/*!
+ * Header at the beginning of snapshot file, records follow it.
+ * Each record is its type and payload size followed by payload of 32-bit values.
+ */
+struct SceneSnapshotHeader {
+  char magic[8];
+  quint32 version;
+  quint32 byteOrderMark;
+};
+
+/*!
+ * Writes binary snapshot of scene as it is built by scene loader.
+ * Materials are deduplicated by value, meshes shared by several models are written once.
+ */
+class SceneSnapshotWriter {
+  public:
+    SceneSnapshotWriter();
+    virtual ~SceneSnapshotWriter() {}
+
+    // Writes material definition unless equal material is written already, returns material index
+    int writeMaterial(MaterialPointer material);
+    // Writes mesh definition unless the mesh is written already, returns mesh index
+    int writeMesh(IndexedMeshPointer mesh);
+
+    // Records can not be nested, definitions should be written before record referencing them is begun
+    void beginRecord(SceneSnapshotRecordType type);
+    void writeInt(int value);
+    void writeFloat(float value);
+    void writeVector(const Vector &vector);
+    void writeData(const void *data, int size);
+    void endRecord();
+
+    bool saveToFile(const QString &filePath) const;
+
+  private:
+    QByteArray mData;
+    // Offset of the record being written
+    int mRecordOffset;
+    std::vector<MaterialPointer> mMaterials;
+    // Indices of written materials by hash of their values, equal hashes are confirmed by comparing materials
+    QMultiHash<uint, int> mMaterialIndices;
+    QHash<const IndexedMesh *, int> mMeshIndices;
+};
+
+/*!
+ * Reads records of memory-mapped snapshot file.
+ * Values are read directly from mapping, reading past the end of record sets error flag.
+ */
+class SceneSnapshotReader {
+  public:
+    SceneSnapshotReader();
+    virtual ~SceneSnapshotReader() {}
+
+    // Checks whether file starts with snapshot magic
+    static bool isSnapshotFile(const QString &filePath);
+
+    // Maps file and checks its header
+    bool open(const QString &filePath);
+    // Moves to the next record, returns false at the end of file or if the record is truncated
+    bool readNextRecord();
+    SceneSnapshotRecordType getRecordType() const { return mRecordType; }
+
+    int readInt();
+    float readFloat();
+    Vector readVector();
+    // Returns pointer to data inside mapping
+    const char *readData(int size);
+
+    // Whether the file or the current record is malformed
+    bool hasError() const { return mHasError; }
+
+  private:
+    QFile mFile;
+    const char *mCursor;
+    const char *mEnd;
+    const char *mRecordEnd;
+    SceneSnapshotRecordType mRecordType;
+    bool mHasError;
+};
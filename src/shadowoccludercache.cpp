@@ -0,0 +1,45 @@
+/*!
+ *\file shadowoccludercache.cpp
+ *\brief Contains ShadowOccluderCache class definition
+ */
+
+#include "shadowoccludercache.h"
+
+ShadowOccluderCache::ShadowOccluderCache()
+  : mLookupsCount(0),
+    mHitsCount(0) {
+}
+
+ShadowOccluderCache::~ShadowOccluderCache() {
+}
+
+const ShadowOccluder &ShadowOccluderCache::getOccluder(int lightIndex) {
+  if (lightIndex >= static_cast<int>(mOccluders.size())) {
+    mOccluders.resize(lightIndex + 1);
+  }
+  return mOccluders[lightIndex];
+}
+
+void ShadowOccluderCache::setOccluder(int lightIndex, const ShadowOccluder &occluder) {
+  if (lightIndex >= static_cast<int>(mOccluders.size())) {
+    mOccluders.resize(lightIndex + 1);
+  }
+  mOccluders[lightIndex] = occluder;
+}
+
+void ShadowOccluderCache::registerLookup(bool isHit) {
+  ++mLookupsCount;
+  if (isHit) {
+    ++mHitsCount;
+  }
+}
+
+float ShadowOccluderCache::getHitRate() const {
+  return mLookupsCount > 0 ? static_cast<float>(mHitsCount) / mLookupsCount : 0.f;
+}
+
+void ShadowOccluderCache::clear() {
+  mOccluders.clear();
+  mLookupsCount = 0;
+  mHitsCount = 0;
+}
@@ -0,0 +1,51 @@
+/*!
+ *\file shadowoccludercache.h
+ *\brief Contains ShadowOccluderCache class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "shapedispatch.h"
+
+// Scene shape which occluded a shadow ray
+struct ShadowOccluder {
+  ShadowOccluder()
+    : shape(NULL),
+      type(SHAPE_TYPE_OTHER) {}
+  ShadowOccluder(const Shape *occluderShape, ShapeType occluderType)
+    : shape(occluderShape),
+      type(occluderType) {}
+
+  const Shape *shape;
+  ShapeType type;
+};
+
+/*!
+ * Last shadow ray occluder of each light source.
+ * Neighboring pixels are usually shadowed by the same shape, so the shape is tested
+ * before full scene traversal. Cache is not synchronized, each rendering thread should own its own cache.
+ */
+class ShadowOccluderCache {
+  public:
+    ShadowOccluderCache();
+    virtual ~ShadowOccluderCache();
+
+    // Returns last occluder of the light source, shape is NULL if there is no one
+    const ShadowOccluder &getOccluder(int lightIndex);
+    void setOccluder(int lightIndex, const ShadowOccluder &occluder);
+
+    // Statistics of shadow rays resolved by cached occluders
+    void registerLookup(bool isHit);
+    long long getLookupsCount() const { return mLookupsCount; }
+    long long getHitsCount() const { return mHitsCount; }
+    float getHitRate() const;
+
+    void clear();
+
+  private:
+    std::vector<ShadowOccluder> mOccluders;
+    long long mLookupsCount;
+    long long mHitsCount;
+};
@@ -0,0 +1,119 @@
+/*!
+ *\file shapedispatch.h
+ *\brief Contains ShapeType enumeration and functions for non-virtual dispatch of shape intersection tests
+ */
+
+#pragma once
+
+#include <typeinfo>
+
+#include "sphere.h"
+#include "plane.h"
+#include "box.h"
+#include "cylinder.h"
+#include "cone.h"
+#include "triangle.h"
+#include "torus.h"
+#include "meshmodel.h"
+#include "csgtree.h"
+#include "spheregroup.h"
+#include "boxgroup.h"
+#include "quadric.h"
+#include "quadricgroup.h"
+#include "rayintersection.h"
+
+// Concrete shape types, shapes of other types are intersected through virtual call
+enum ShapeType {
+  SHAPE_TYPE_SPHERE,
+  SHAPE_TYPE_PLANE,
+  SHAPE_TYPE_BOX,
+  SHAPE_TYPE_CYLINDER,
+  SHAPE_TYPE_CONE,
+  SHAPE_TYPE_TRIANGLE,
+  SHAPE_TYPE_TORUS,
+  SHAPE_TYPE_MESH,
+  SHAPE_TYPE_CSG,
+  SHAPE_TYPE_SPHERE_GROUP,
+  SHAPE_TYPE_BOX_GROUP,
+  SHAPE_TYPE_QUADRIC,
+  SHAPE_TYPE_QUADRIC_GROUP,
+  SHAPE_TYPE_OTHER,
+  SHAPE_TYPES_COUNT
+};
+
+// Determines concrete shape type, supposed to be called once when shape is added to scene
+inline ShapeType getShapeType(const Shape *shape) {
+  // Exact type is checked, so that derived classes fall to generic case
+  const std::type_info &type = typeid(*shape);
+  if (type == typeid(Sphere)) {
+    return SHAPE_TYPE_SPHERE;
+  }
+  if (type == typeid(Plane)) {
+    return SHAPE_TYPE_PLANE;
+  }
+  if (type == typeid(Box)) {
+    return SHAPE_TYPE_BOX;
+  }
+  if (type == typeid(Cylinder)) {
+    return SHAPE_TYPE_CYLINDER;
+  }
+  if (type == typeid(Cone)) {
+    return SHAPE_TYPE_CONE;
+  }
+  if (type == typeid(Triangle)) {
+    return SHAPE_TYPE_TRIANGLE;
+  }
+  if (type == typeid(Torus)) {
+    return SHAPE_TYPE_TORUS;
+  }
+  if (type == typeid(MeshModel)) {
+    return SHAPE_TYPE_MESH;
+  }
+  if (type == typeid(CSGTree)) {
+    return SHAPE_TYPE_CSG;
+  }
+  if (type == typeid(SphereGroup)) {
+    return SHAPE_TYPE_SPHERE_GROUP;
+  }
+  if (type == typeid(BoxGroup)) {
+    return SHAPE_TYPE_BOX_GROUP;
+  }
+  if (type == typeid(Quadric)) {
+    return SHAPE_TYPE_QUADRIC;
+  }
+  if (type == typeid(QuadricGroup)) {
+    return SHAPE_TYPE_QUADRIC_GROUP;
+  }
+  return SHAPE_TYPE_OTHER;
+}
+
+// Calls intersection method of concrete shape class directly, without virtual dispatch
+template <class ShapeClass>
+inline RayIntersection intersectShapeOfType(const Shape *shape, const Ray &ray) {
+  return static_cast<const ShapeClass *>(shape)->ShapeClass::intersectWithRay(ray);
+}
+
+// Shapes of unknown type are intersected through virtual call
+template <>
+inline RayIntersection intersectShapeOfType<Shape>(const Shape *shape, const Ray &ray) {
+  return shape->intersectWithRay(ray);
+}
+
+inline RayIntersection intersectShape(ShapeType type, const Shape *shape, const Ray &ray) {
+  switch (type) {
+    case SHAPE_TYPE_SPHERE:        return intersectShapeOfType<Sphere>(shape, ray);
+    case SHAPE_TYPE_PLANE:         return intersectShapeOfType<Plane>(shape, ray);
+    case SHAPE_TYPE_BOX:           return intersectShapeOfType<Box>(shape, ray);
+    case SHAPE_TYPE_CYLINDER:      return intersectShapeOfType<Cylinder>(shape, ray);
+    case SHAPE_TYPE_CONE:          return intersectShapeOfType<Cone>(shape, ray);
+    case SHAPE_TYPE_TRIANGLE:      return intersectShapeOfType<Triangle>(shape, ray);
+    case SHAPE_TYPE_TORUS:         return intersectShapeOfType<Torus>(shape, ray);
+    case SHAPE_TYPE_MESH:          return intersectShapeOfType<MeshModel>(shape, ray);
+    case SHAPE_TYPE_CSG:           return intersectShapeOfType<CSGTree>(shape, ray);
+    case SHAPE_TYPE_SPHERE_GROUP:  return intersectShapeOfType<SphereGroup>(shape, ray);
+    case SHAPE_TYPE_BOX_GROUP:     return intersectShapeOfType<BoxGroup>(shape, ray);
+    case SHAPE_TYPE_QUADRIC:       return intersectShapeOfType<Quadric>(shape, ray);
+    case SHAPE_TYPE_QUADRIC_GROUP: return intersectShapeOfType<QuadricGroup>(shape, ray);
+    default:                       return intersectShapeOfType<Shape>(shape, ray);
+  }
+}
@@ -0,0 +1,71 @@
+/*!
+ *\file simdpacket.h
+ *\brief Contains wrappers for packed float SIMD operations used by batch intersection kernels
+ */
+
+#pragma once
+
+#include <float.h>
+
+/*
+ * Packet holds PACKET_SIZE float lanes. With AVX enabled at compile time (/arch:AVX, -mavx)
+ * packets are 8 lanes wide, otherwise SSE packets of 4 lanes are used.
+ * Loads are unaligned, so kernel data can be kept in plain std::vector<float>.
+ */
+#ifdef __AVX__
+
+#include <immintrin.h>
+
+#define PACKET_SIZE 8
+
+typedef __m256 Packet;
+
+inline Packet packetLoad(const float *data) { return _mm256_loadu_ps(data); }
+inline Packet packetSet(float value) { return _mm256_set1_ps(value); }
+inline Packet packetAdd(Packet a, Packet b) { return _mm256_add_ps(a, b); }
+inline Packet packetSub(Packet a, Packet b) { return _mm256_sub_ps(a, b); }
+inline Packet packetMul(Packet a, Packet b) { return _mm256_mul_ps(a, b); }
+inline Packet packetDiv(Packet a, Packet b) { return _mm256_div_ps(a, b); }
+inline Packet packetSqrt(Packet a) { return _mm256_sqrt_ps(a); }
+// Returns second argument for NaN lanes, so accumulators should be passed as the second argument
+inline Packet packetMin(Packet a, Packet b) { return _mm256_min_ps(a, b); }
+inline Packet packetMax(Packet a, Packet b) { return _mm256_max_ps(a, b); }
+inline Packet packetLess(Packet a, Packet b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline Packet packetGreater(Packet a, Packet b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline Packet packetLessOrEqual(Packet a, Packet b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline Packet packetAnd(Packet a, Packet b) { return _mm256_and_ps(a, b); }
+inline Packet packetOr(Packet a, Packet b) { return _mm256_or_ps(a, b); }
+// Takes lanes of second argument where mask is set and lanes of first argument otherwise
+inline Packet packetSelect(Packet a, Packet b, Packet mask) { return _mm256_blendv_ps(a, b, mask); }
+inline int packetMask(Packet mask) { return _mm256_movemask_ps(mask); }
+inline void packetStore(float *data, Packet a) { _mm256_storeu_ps(data, a); }
+
+#else
+
+#include <xmmintrin.h>
+
+#define PACKET_SIZE 4
+
+typedef __m128 Packet;
+
+inline Packet packetLoad(const float *data) { return _mm_loadu_ps(data); }
+inline Packet packetSet(float value) { return _mm_set1_ps(value); }
+inline Packet packetAdd(Packet a, Packet b) { return _mm_add_ps(a, b); }
+inline Packet packetSub(Packet a, Packet b) { return _mm_sub_ps(a, b); }
+inline Packet packetMul(Packet a, Packet b) { return _mm_mul_ps(a, b); }
+inline Packet packetDiv(Packet a, Packet b) { return _mm_div_ps(a, b); }
+inline Packet packetSqrt(Packet a) { return _mm_sqrt_ps(a); }
+// Returns second argument for NaN lanes, so accumulators should be passed as the second argument
+inline Packet packetMin(Packet a, Packet b) { return _mm_min_ps(a, b); }
+inline Packet packetMax(Packet a, Packet b) { return _mm_max_ps(a, b); }
+inline Packet packetLess(Packet a, Packet b) { return _mm_cmplt_ps(a, b); }
+inline Packet packetGreater(Packet a, Packet b) { return _mm_cmpgt_ps(a, b); }
+inline Packet packetLessOrEqual(Packet a, Packet b) { return _mm_cmple_ps(a, b); }
+inline Packet packetAnd(Packet a, Packet b) { return _mm_and_ps(a, b); }
+inline Packet packetOr(Packet a, Packet b) { return _mm_or_ps(a, b); }
+// Takes lanes of second argument where mask is set and lanes of first argument otherwise
+inline Packet packetSelect(Packet a, Packet b, Packet mask) { return _mm_or_ps(_mm_andnot_ps(mask, a), _mm_and_ps(mask, b)); }
+inline int packetMask(Packet mask) { return _mm_movemask_ps(mask); }
+inline void packetStore(float *data, Packet a) { _mm_storeu_ps(data, a); }
+
+#endif
@@ -0,0 +1,105 @@
+/*!
+ *\file simdvector.h
+ *\brief Contains SimdVector3 class declaration and definition
+ */
+
+#pragma once
+
+#include <math.h>
+#include <xmmintrin.h>
+
+/*!
+ * Three component float vector padded to 16 bytes, arithmetic is done with SSE instructions.
+ * Interface repeats vmath Vector3<float> one (x, y, z and r, g, b members, dotProduct, crossProduct,
+ * length, normalize and arithmetic operators), so the type can replace it.
+ * Components are loaded with unaligned loads, so the type has no alignment requirements
+ * and can be stored in heap allocated shapes and std::vector on 32-bit platforms.
+ * Padding component is kept equal to zero.
+ */
+class SimdVector3 {
+  public:
+    SimdVector3() : x(0.f), y(0.f), z(0.f), w(0.f) {}
+    SimdVector3(float nx, float ny, float nz) : x(nx), y(ny), z(nz), w(0.f) {}
+
+    // Vector arithmetic operators, multiplication and division are componentwise
+    SimdVector3 operator+(const SimdVector3 &rhs) const { return SimdVector3(_mm_add_ps(load(), rhs.load())); }
+    SimdVector3 operator-(const SimdVector3 &rhs) const { return SimdVector3(_mm_sub_ps(load(), rhs.load())); }
+    SimdVector3 operator*(const SimdVector3 &rhs) const { return SimdVector3(_mm_mul_ps(load(), rhs.load())); }
+    SimdVector3 operator/(const SimdVector3 &rhs) const {
+      SimdVector3 result(_mm_div_ps(load(), rhs.load()));
+      // Zero by zero division of padding gives NaN
+      result.w = 0.f;
+      return result;
+    }
+
+    SimdVector3 &operator+=(const SimdVector3 &rhs) { store(_mm_add_ps(load(), rhs.load())); return *this; }
+    SimdVector3 &operator-=(const SimdVector3 &rhs) { store(_mm_sub_ps(load(), rhs.load())); return *this; }
+    SimdVector3 &operator*=(const SimdVector3 &rhs) { store(_mm_mul_ps(load(), rhs.load())); return *this; }
+    SimdVector3 &operator/=(const SimdVector3 &rhs) { *this = *this / rhs; return *this; }
+
+    // Scalar arithmetic operators
+    SimdVector3 operator+(float rhs) const { return SimdVector3(x + rhs, y + rhs, z + rhs); }
+    SimdVector3 operator-(float rhs) const { return SimdVector3(x - rhs, y - rhs, z - rhs); }
+    SimdVector3 operator*(float rhs) const { return SimdVector3(_mm_mul_ps(load(), _mm_set1_ps(rhs))); }
+    SimdVector3 operator/(float rhs) const { return SimdVector3(_mm_div_ps(load(), _mm_set1_ps(rhs))); }
+
+    SimdVector3 &operator+=(float rhs) { *this = *this + rhs; return *this; }
+    SimdVector3 &operator-=(float rhs) { *this = *this - rhs; return *this; }
+    SimdVector3 &operator*=(float rhs) { store(_mm_mul_ps(load(), _mm_set1_ps(rhs))); return *this; }
+    SimdVector3 &operator/=(float rhs) { store(_mm_div_ps(load(), _mm_set1_ps(rhs))); return *this; }
+
+    SimdVector3 operator-() const { return SimdVector3(_mm_sub_ps(_mm_setzero_ps(), load())); }
+
+    // Equality is tested with the same threshold as vmath EPSILON
+    bool operator==(const SimdVector3 &rhs) const {
+      const float epsilon = 4.37114e-05f;
+      return fabs(x - rhs.x) < epsilon && fabs(y - rhs.y) < epsilon && fabs(z - rhs.z) < epsilon;
+    }
+    bool operator!=(const SimdVector3 &rhs) const { return !(*this == rhs); }
+
+    float &operator[](int n) { return (&x)[n]; }
+    const float &operator[](int n) const { return (&x)[n]; }
+
+    float dotProduct(const SimdVector3 &rhs) const {
+      __m128 product = _mm_mul_ps(load(), rhs.load());
+      // Sum x, y and z lanes, padding lane is ignored
+      __m128 sum = _mm_add_ss(product, _mm_shuffle_ps(product, product, _MM_SHUFFLE(1, 1, 1, 1)));
+      sum = _mm_add_ss(sum, _mm_shuffle_ps(product, product, _MM_SHUFFLE(2, 2, 2, 2)));
+      return _mm_cvtss_f32(sum);
+    }
+
+    SimdVector3 crossProduct(const SimdVector3 &rhs) const {
+      __m128 lhsValue = load();
+      __m128 rhsValue = rhs.load();
+      // (y, z, x) permutations of arguments
+      __m128 lhsYzx = _mm_shuffle_ps(lhsValue, lhsValue, _MM_SHUFFLE(3, 0, 2, 1));
+      __m128 rhsYzx = _mm_shuffle_ps(rhsValue, rhsValue, _MM_SHUFFLE(3, 0, 2, 1));
+      __m128 result = _mm_sub_ps(_mm_mul_ps(lhsValue, rhsYzx), _mm_mul_ps(lhsYzx, rhsValue));
+      return SimdVector3(_mm_shuffle_ps(result, result, _MM_SHUFFLE(3, 0, 2, 1)));
+    }
+
+    // Componentwise minimum and maximum
+    SimdVector3 minimum(const SimdVector3 &rhs) const { return SimdVector3(_mm_min_ps(load(), rhs.load())); }
+    SimdVector3 maximum(const SimdVector3 &rhs) const { return SimdVector3(_mm_max_ps(load(), rhs.load())); }
+
+    float lengthSq() const { return dotProduct(*this); }
+    float length() const { return sqrtf(lengthSq()); }
+
+    void normalize() {
+      store(_mm_div_ps(load(), _mm_set1_ps(length())));
+    }
+
+  public:
+    union { float x; float r; };
+    union { float y; float g; };
+    union { float z; float b; };
+
+  private:
+    explicit SimdVector3(__m128 value) { store(value); }
+
+    __m128 load() const { return _mm_loadu_ps(&x); }
+    void store(__m128 value) { _mm_storeu_ps(&x, value); }
+
+    // Padding component
+    float w;
+};
@@ -9,7 +9,9 @@
 Sphere::Sphere(Vector center, float radius, MaterialPointer material) 
   : Shape(material), 
     mCenter(center), 
-    mRadius(radius) {
+    mRadius(radius),
+    mSquaredRadius(radius * radius),
+    mInvertedRadius(1.f / radius) {
 }
 
 Sphere::~Sphere() {
@@ -19,7 +21,7 @@ RayIntersection Sphere::intersectWithRay(const Ray &ray) const {
   // Solve square equation x^2 + b * x + c = 0
   Vector cameraToRayOrigin = ray.getOriginPosition() - mCenter;
   float b = ray.getDirection().dotProduct(cameraToRayOrigin);
-  float c = cameraToRayOrigin.dotProduct(cameraToRayOrigin) - mRadius * mRadius;
+  float c = cameraToRayOrigin.dotProduct(cameraToRayOrigin) - mSquaredRadius;
   float descriminant = b * b - c;
 
   if (descriminant < 0) {
@@ -56,15 +58,12 @@ RayIntersection Sphere::intersectWithRay(const Ray &ray) const {
     if (rayExit < 0.f) {
       intersectionDistances.insert(intersectionDistances.begin(), 0.f);
     }
-    SpherePointer pointer = SpherePointer(new Sphere(*this));
-    return RayIntersection(true, pointer, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
+    return RayIntersection(true, this, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
   }
 
   return RayIntersection();
 }
 
 Vector Sphere::getNormal(const Ray &ray, float distance) const {
-  Vector normal = (ray.getPointAt(distance) - mCenter) / mRadius;
-  normal.normalize();
-  return normal;
+  return (ray.getPointAt(distance) - mCenter) * mInvertedRadius;
 }
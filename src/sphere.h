@@ -18,7 +18,14 @@ class Sphere : public Shape {
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const Vector &getCenter() const { return mCenter; }
+    float getRadius() const { return mRadius; }
+
   private:
     Vector mCenter;
     float mRadius;
+
+    // Invariants calculated at construction
+    float mSquaredRadius;
+    float mInvertedRadius;
 };
\ No newline at end of file
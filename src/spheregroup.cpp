@@ -0,0 +1,101 @@
+/*!
+ *\file spheregroup.cpp
+ *\brief Contains SphereGroup class definition
+ */
+
+#include "spheregroup.h"
+#include "rayintersection.h"
+#include "simdpacket.h"
+
+SphereGroup::SphereGroup(const std::vector<SpherePointer> &spheres)
+  : Shape(MaterialPointer(NULL)),  // materials are owned by spheres
+    mSpheres(spheres) {
+  int paddedSize = (spheres.size() + PACKET_SIZE - 1) / PACKET_SIZE * PACKET_SIZE;
+  // Padding spheres have negative squared radius, so they are never intersected
+  mCentersX.resize(paddedSize, 0.f);
+  mCentersY.resize(paddedSize, 0.f);
+  mCentersZ.resize(paddedSize, 0.f);
+  mSquaredRadii.resize(paddedSize, -1.f);
+
+  for (int idx = 0, count = spheres.size(); idx < count; ++idx) {
+    const Vector &center = spheres[idx]->getCenter();
+    float radius = spheres[idx]->getRadius();
+    mCentersX[idx] = center.x;
+    mCentersY[idx] = center.y;
+    mCentersZ[idx] = center.z;
+    mSquaredRadii[idx] = radius * radius;
+  }
+}
+
+SphereGroup::~SphereGroup() {
+}
+
+RayIntersection SphereGroup::intersectWithRay(const Ray &ray) const {
+  const Vector &rayOrigin = ray.getOriginPosition();
+  const Vector &rayDirection = ray.getDirection();
+
+  Packet originX = packetSet(rayOrigin.x);
+  Packet originY = packetSet(rayOrigin.y);
+  Packet originZ = packetSet(rayOrigin.z);
+  Packet directionX = packetSet(rayDirection.x);
+  Packet directionY = packetSet(rayDirection.y);
+  Packet directionZ = packetSet(rayDirection.z);
+  Packet zero = packetSet(0.f);
+  Packet infinity = packetSet(MAX_DISTANCE_TO_INTERSECTON);
+
+  float closestDistance = MAX_DISTANCE_TO_INTERSECTON;
+  int closestSphereIndex = -1;
+  float distances[PACKET_SIZE];
+
+  for (int first = 0, count = mSquaredRadii.size(); first < count; first += PACKET_SIZE) {
+    // Solve square equation x^2 + 2 * b * x + c = 0 for PACKET_SIZE spheres
+    Packet centerToOriginX = packetSub(originX, packetLoad(&mCentersX[first]));
+    Packet centerToOriginY = packetSub(originY, packetLoad(&mCentersY[first]));
+    Packet centerToOriginZ = packetSub(originZ, packetLoad(&mCentersZ[first]));
+
+    Packet b = packetAdd(packetAdd(packetMul(directionX, centerToOriginX), 
+                                   packetMul(directionY, centerToOriginY)),
+                                   packetMul(directionZ, centerToOriginZ));
+    Packet c = packetSub(packetAdd(packetAdd(packetMul(centerToOriginX, centerToOriginX), 
+                                             packetMul(centerToOriginY, centerToOriginY)),
+                                             packetMul(centerToOriginZ, centerToOriginZ)),
+                         packetLoad(&mSquaredRadii[first]));
+    Packet discriminant = packetSub(packetMul(b, b), c);
+    Packet hasRoots = packetGreater(discriminant, zero);
+    if (packetMask(hasRoots) == 0) {
+      continue;
+    }
+
+    // Take the closest root if it is in front of ray origin, otherwise take the farthest one
+    Packet discriminantRoot = packetSqrt(packetMax(discriminant, zero));
+    Packet closestRoot = packetSub(packetSub(zero, b), discriminantRoot);
+    Packet farthestRoot = packetSub(discriminantRoot, b);
+    Packet root = packetSelect(farthestRoot, closestRoot, packetGreater(closestRoot, zero));
+
+    Packet isHit = packetAnd(hasRoots, packetGreater(root, zero));
+    Packet hitDistances = packetSelect(infinity, root, isHit);
+    if (packetMask(packetLess(hitDistances, packetSet(closestDistance))) == 0) {
+      continue;
+    }
+
+    packetStore(distances, hitDistances);
+    for (int lane = 0; lane < PACKET_SIZE; ++lane) {
+      if (distances[lane] < closestDistance) {
+        closestDistance = distances[lane];
+        closestSphereIndex = first + lane;
+      }
+    }
+  }
+
+  if (closestSphereIndex < 0) {
+    return RayIntersection();
+  }
+
+  // Calculate complete intersection data for the closest sphere only
+  return mSpheres[closestSphereIndex]->intersectWithRay(ray);
+}
+
+Vector SphereGroup::getNormal(const Ray &ray, float distance) const {
+  // This method is actually never called
+  return Vector();
+}
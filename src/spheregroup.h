@@ -0,0 +1,40 @@
+/*!
+ *\file spheregroup.h
+ *\brief Contains SphereGroup class declaration
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "shape.h"
+#include "sphere.h"
+
+class SphereGroup;
+
+typedef QSharedPointer<SphereGroup> SphereGroupPointer;
+
+/*!
+ * Group of spheres stored as structure of arrays.
+ * Ray is tested against PACKET_SIZE spheres at once, full intersection data 
+ * is calculated only for the nearest hit sphere.
+ */
+class SphereGroup : public Shape {
+  public:
+    SphereGroup(const std::vector<SpherePointer> &spheres);
+    virtual ~SphereGroup();
+
+    virtual RayIntersection intersectWithRay(const Ray &ray) const;
+    virtual Vector getNormal(const Ray &ray, float distance) const;
+
+    const std::vector<SpherePointer> &getSpheres() const { return mSpheres; }
+
+  private:
+    std::vector<SpherePointer> mSpheres;
+
+    // Sphere centers and squared radii, padded to packet size
+    std::vector<float> mCentersX;
+    std::vector<float> mCentersY;
+    std::vector<float> mCentersZ;
+    std::vector<float> mSquaredRadii;
+};
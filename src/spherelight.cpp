@@ -0,0 +1,44 @@
+/*!
+ *\file spherelight.cpp
+ *\brief Contains SphereLight class definition
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "spherelight.h"
+#include "coordinateframe.h"
+
+SphereLight::SphereLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, 
+                         Vector position, float radius, 
+                         float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient)
+  : AreaLight(ambientIntensity, diffuseIntensity, specularIntensity, position, 
+              constantAttenutaionCoefficient, linearAttenutaionCoefficient, quadraticAttenutaionCoefficient),
+    mRadius(radius) {
+}
+
+SphereLight::~SphereLight() {
+}
+
+Vector SphereLight::sampleSurface(const Vector &point, float u, float v) const {
+  Vector toCenter = mPosition - point;
+  float squaredDistance = toCenter.lengthSq();
+  float squaredRadius = mRadius * mRadius;
+  // Point inside the sphere sees its center
+  if (squaredDistance <= squaredRadius) {
+    return mPosition;
+  }
+
+  // Uniformly sample cone around direction to the center
+  float cosThetaMax = sqrtf(1.f - squaredRadius / squaredDistance);
+  float cosTheta = 1.f - u * (1.f - cosThetaMax);
+  float sinTheta = sqrtf(std::max(1.f - cosTheta * cosTheta, 0.f));
+  float phi = 2.f * static_cast<float>(M_PI) * v;
+  CoordinateFrame frame(point, toCenter);
+  Vector direction = frame.toWorldDirection(Vector(sinTheta * cosf(phi), sinTheta * sinf(phi), cosTheta));
+
+  // The nearest intersection of sampled direction with the sphere
+  float projection = direction.dotProduct(toCenter);
+  float discriminant = std::max(squaredRadius - (squaredDistance - projection * projection), 0.f);
+  return point + direction * (projection - sqrtf(discriminant));
+}
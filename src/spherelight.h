@@ -0,0 +1,27 @@
+/*!
+ *\file spherelight.h
+ *\brief Contains SphereLight class declaration
+ */
+
+#pragma once
+
+#include "arealight.h"
+
+class SphereLight;
+
+typedef QSharedPointer<SphereLight> SphereLightPointer;
+
+class SphereLight : public AreaLight {
+  public:
+    SphereLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, 
+                Vector position, float radius, 
+                float constantAttenutaionCoefficient, float linearAttenutaionCoefficient, float quadraticAttenutaionCoefficient);
+    virtual ~SphereLight();
+
+  protected:
+    // Samples cone of directions subtended by the sphere, so that only visible half of the sphere is sampled
+    virtual Vector sampleSurface(const Vector &point, float u, float v) const;
+
+  private:
+    float mRadius;
+};
@@ -1,6 +1,5 @@
 #include "spotlight.h"
 #include "mathcommons.h"
-#include "scene.h"
 
 SpotLight::SpotLight(Color ambientIntensity, Color diffuseIntensity, Color specularIntensity, 
                      Vector position, Vector direction, 
@@ -12,6 +11,7 @@ SpotLight::SpotLight(Color ambientIntensity, Color diffuseIntensity, Color specu
     mConstantAttenutaionCoefficient(constantAttenutaionCoefficient),
     mLinearAttenutaionCoefficient(linearAttenutaionCoefficient),
     mQuadraticAttenutaionCoefficient(quadraticAttenutaionCoefficient),
+    mInfluenceRadius(MAX_DISTANCE_TO_INTERSECTON),
     mUmbraAngle(umbraAngle), 
     mPenumbraAngle(penumbraAngle), 
     mFalloffFactor(falloffFactor) {
@@ -24,15 +24,68 @@ SpotLight::SpotLight(Color ambientIntensity, Color diffuseIntensity, Color specu
 SpotLight::~SpotLight() {
 }
 
-Color SpotLight::calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const {
+void SpotLight::setContributionThreshold(float threshold) {
+  mInfluenceRadius = calculateInfluenceRadius(mConstantAttenutaionCoefficient, mLinearAttenutaionCoefficient, 
+                                              mQuadraticAttenutaionCoefficient, threshold);
+}
+
+bool SpotLight::getInfluenceSphere(Vector &center, float &radius) const {
+  if (mInfluenceRadius == MAX_DISTANCE_TO_INTERSECTON) {
+    return false;
+  }
+  center = mPosition;
+  radius = mInfluenceRadius;
+  return true;
+}
+
+bool SpotLight::getAttenuation(Vector &position, float &constantAttenutaionCoefficient, float &linearAttenutaionCoefficient, 
+                               float &quadraticAttenutaionCoefficient) const {
+  position = mPosition;
+  constantAttenutaionCoefficient = mConstantAttenutaionCoefficient;
+  linearAttenutaionCoefficient = mLinearAttenutaionCoefficient;
+  quadraticAttenutaionCoefficient = mQuadraticAttenutaionCoefficient;
+  return true;
+}
+
+float SpotLight::estimateContribution(const Vector &point, const Vector &normal) const {
+  Vector lightVector = -mDirection;
+  Vector lightDirection = mPosition - point;
+  float distanceToLight = lightDirection.length();
+  if (distanceToLight > mInfluenceRadius) {
+    return 0.f;
+  }
+  lightDirection.normalize();
+
+  float distanceAttenuation = 1 / (mConstantAttenutaionCoefficient + mLinearAttenutaionCoefficient * distanceToLight + mQuadraticAttenutaionCoefficient * distanceToLight * distanceToLight);
+  float spotAttenuation = calculateSpotAttenuation(lightDirection.dotProduct(lightVector));
+  bool isFacingLight = lightVector.dotProduct(normal) > 0.f && lightDirection.dotProduct(lightVector) > 0.f;
+  return estimateAttenuatedContribution(distanceAttenuation * spotAttenuation, isFacingLight);
+}
+
+bool SpotLight::calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const {
   Vector point = ray.getPointAt(distance);
+  Vector lightVector = -mDirection;
 
-  Color ambientComponent;
-  Color diffuseComponent;
-  Color specularComponent;
+  Vector lightDirection = mPosition - point;
+  float distanceToLight	= lightDirection.length();
+  lightDirection.normalize();
+
+  // If the point is not illuminated
+  if (lightVector.dotProduct(normal) <= 0.0 || lightDirection.dotProduct(lightVector) <= 0.0) {
+    return false;
+  }
+
+  // If the point is outside of penumbra cone, spot attenuation is zero
+  if (lightDirection.dotProduct(lightVector) <= mHalfPenumbraAngleCosine) {
+    return false;
+  }
+
+  shadowRay = Ray(point + lightVector * EPS_FOR_SHADOW_RAYS, lightVector, 0.f, distanceToLight);
+  return true;
+}
 
-  ambientComponent = componentwiseProduct(material->ambientColor, mAmbientIntensity);
-  Color result = ambientComponent;
+LightIrradiance SpotLight::calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const {
+  Vector point = ray.getPointAt(distance);
 
   Vector lightVector = -mDirection;
   float	lightVectorDotNormal = lightVector.dotProduct(normal);
@@ -42,51 +95,45 @@ Color SpotLight::calculateColor(const Scene &scene, const Ray &ray, float distan
 
   float distanceToLight	= (mPosition - point).length();
   float distanceAttenuation = 1 / (mConstantAttenutaionCoefficient + mLinearAttenutaionCoefficient * distanceToLight + mQuadraticAttenutaionCoefficient * distanceToLight * distanceToLight);
-  result *= distanceAttenuation;
 
   float lightDirectionDotLightVector = lightDirection.dotProduct(lightVector);
-  float spotAttenuation = 0.0;
-  if (lightDirectionDotLightVector > mHalfUmbraAngleCosine) {
-    spotAttenuation = 1.0;
-  } else if (lightDirectionDotLightVector < mHalfPenumbraAngleCosine) {
-    spotAttenuation = 0.0;
-  } else {
-    const float factor = (lightDirectionDotLightVector - mHalfPenumbraAngleCosine) / (mHalfUmbraAngleCosine - mHalfPenumbraAngleCosine);
-    spotAttenuation = powf(factor, mFalloffFactor);
-  }
+  float spotAttenuation = calculateSpotAttenuation(lightDirectionDotLightVector);
 
-  result *= spotAttenuation;
+  LightIrradiance irradiance;
+  irradiance.ambient = mAmbientIntensity * distanceAttenuation * spotAttenuation;
 
   // If the point is not illuminated  
   if (lightVectorDotNormal <= 0.0) {
-    return result;
+    return irradiance;
   }
 
   if (lightDirectionDotLightVector <= 0.0) {
-    return result;
+    return irradiance;
   }
 
-  Ray shadowRay(point + lightVector * EPS_FOR_SHADOW_RAYS, lightVector);	
-  RayIntersection shadowRayIntersection = scene.calculateFirstIntersection(shadowRay);
+  irradiance.diffuse = mDiffuseIntensity * spotAttenuation * distanceAttenuation * lightVectorDotNormal;
 
-  // Object not in the shadow
-  if (!shadowRayIntersection.rayIntersectsWithShape || shadowRayIntersection.distanceFromRayOrigin > distanceToLight) {
-    Color diffuseColor = material->diffuseColor;
-    diffuseComponent = componentwiseProduct(diffuseColor, mDiffuseIntensity * spotAttenuation * distanceAttenuation * lightVectorDotNormal);
+  Vector lightReflect = mDirection -  normal * 2 * mDirection.dotProduct(normal);
+  lightReflect.normalize();
 
-    Vector lightReflect = mDirection -  normal * 2 * mDirection.dotProduct(normal);
-    lightReflect.normalize();
+  Vector cameraDirection = ray.getOriginPosition() - point;
+  cameraDirection.normalize();
 
-    Vector cameraDirection = ray.getOriginPosition() - point;
-    cameraDirection.normalize();
+  float	cosLightReflect = cameraDirection.dotProduct(lightReflect);
+  if (cosLightReflect > 0.0) {
+    irradiance.specular = mSpecularIntensity * powf(cosLightReflect, specularPower) * spotAttenuation * distanceAttenuation;
+  }				
 
-    float	cosLightReflect = cameraDirection.dotProduct(lightReflect);
-    if (cosLightReflect > 0.0) {
-      Color specularColor = material->specularColor;
-      specularComponent	= componentwiseProduct(specularColor, mSpecularIntensity * powf(cosLightReflect, material->specularPower) * spotAttenuation * distanceAttenuation);
-    }				
-  }
+  return irradiance;
+}
 
-  result += (diffuseComponent + specularComponent);
-  return result;
+float SpotLight::calculateSpotAttenuation(float lightDirectionDotLightVector) const {
+  if (lightDirectionDotLightVector > mHalfUmbraAngleCosine) {
+    return 1.0;
+  }
+  if (lightDirectionDotLightVector < mHalfPenumbraAngleCosine) {
+    return 0.0;
+  }
+  const float factor = (lightDirectionDotLightVector - mHalfPenumbraAngleCosine) / (mHalfUmbraAngleCosine - mHalfPenumbraAngleCosine);
+  return powf(factor, mFalloffFactor);
 }
\ No newline at end of file
@@ -14,7 +14,19 @@ public:
             float umbraAngle, float penumbraAngle, float falloffFactor);
   virtual ~SpotLight();
 
-  virtual Color calculateColor(const Scene &scene, const Ray &ray, float distance, const Vector &normal, MaterialPointer material) const;
+  virtual bool calculateShadowRay(const Ray &ray, float distance, const Vector &normal, Ray &shadowRay) const;
+  virtual LightIrradiance calculateIrradiance(const Ray &ray, float distance, const Vector &normal, float specularPower) const;
+  virtual bool getInfluenceSphere(Vector &center, float &radius) const;
+  virtual bool getAttenuation(Vector &position, float &constantAttenutaionCoefficient, float &linearAttenutaionCoefficient, 
+                              float &quadraticAttenutaionCoefficient) const;
+  virtual float estimateContribution(const Vector &point, const Vector &normal) const;
+
+  // Light source is ignored at points where its contribution is below threshold, zero threshold disables culling
+  void setContributionThreshold(float threshold);
+
+private:
+  // Attenuation by angle between light direction and direction to the point
+  float calculateSpotAttenuation(float lightDirectionDotLightVector) const;
 
 private:
   // Light position
@@ -27,6 +39,9 @@ private:
   float mLinearAttenutaionCoefficient;
   float mQuadraticAttenutaionCoefficient;
 
+  // Distance at which contribution drops below threshold
+  float mInfluenceRadius;
+
   // Umbra angle
   float	mUmbraAngle;
   // Penumbra angle
@@ -0,0 +1,122 @@
+/*!
+ *\file streamingimagewriter.cpp
+ *\brief Contains StreamingImageWriter class definition
+ */
+
+#include <iostream>
+#include <stdio.h>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+#include "streamingimagewriter.h"
+#include "tonemapping.h"
+
+StreamingImageWriter::StreamingImageWriter()
+  : mFormat(STREAMING_IMAGE_PPM),
+    mImageWidth(0),
+    mImageHeight(0),
+    mWrittenRowsCount(0),
+    mHeaderSize(0) {
+}
+
+StreamingImageWriter::~StreamingImageWriter() {
+}
+
+bool StreamingImageWriter::isHighDynamicRangeFile(const QString &filePath) {
+  return filePath.endsWith(".pfm", Qt::CaseInsensitive);
+}
+
+bool StreamingImageWriter::isStandardOutput(const QString &filePath) {
+  return filePath == STREAMING_IMAGE_STANDARD_OUTPUT;
+}
+
+bool StreamingImageWriter::open(const QString &filePath, int imageWidth, int imageHeight) {
+  if (isStandardOutput(filePath)) {
+#ifdef _WIN32
+    // Line ends would be translated in text mode
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    if (!mFile.open(stdout, QIODevice::WriteOnly)) {
+      std::cerr << "Unable to open standard output for writing" << std::endl;
+      return false;
+    }
+  } else {
+    mFile.setFileName(filePath);
+    if (!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+      std::cerr << "Unable to open file at path '" << filePath.toUtf8().constData() << "' for writing" << std::endl;
+      return false;
+    }
+  }
+
+  mFormat = isHighDynamicRangeFile(filePath) ? STREAMING_IMAGE_PFM : STREAMING_IMAGE_PPM;
+  mImageWidth = imageWidth;
+  mImageHeight = imageHeight;
+  mWrittenRowsCount = 0;
+
+  QByteArray header;
+  if (mFormat == STREAMING_IMAGE_PFM) {
+    // Negative scale marks little-endian floats
+    header = "PF\n" + QByteArray::number(imageWidth) + " " + QByteArray::number(imageHeight) + "\n-1.0\n";
+  } else {
+    header = "P6\n" + QByteArray::number(imageWidth) + " " + QByteArray::number(imageHeight) + "\n255\n";
+    mRowPixels.resize(imageWidth);
+    mRowData.resize(imageWidth * 3);
+  }
+  mHeaderSize = header.size();
+
+  if (mFile.write(header) != header.size()) {
+    std::cerr << "Unable to write image to file at path '" << filePath.toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool StreamingImageWriter::writeBand(const float *colors, int rowsCount) {
+  if (mWrittenRowsCount + rowsCount > mImageHeight) {
+    std::cerr << "Image band exceeds height of image '" << mFile.fileName().toUtf8().constData() << "'" << std::endl;
+    return false;
+  }
+
+  for (int y = 0; y < rowsCount; ++y) {
+    if (!writeRow(colors + y * mImageWidth * 3)) {
+      std::cerr << "Unable to write image to file at path '" << mFile.fileName().toUtf8().constData() << "'" << std::endl;
+      return false;
+    }
+    ++mWrittenRowsCount;
+  }
+
+  return true;
+}
+
+bool StreamingImageWriter::close() {
+  mFile.close();
+  if (mWrittenRowsCount != mImageHeight) {
+    std::cerr << "Image '" << mFile.fileName().toUtf8().constData() << "' is incomplete, " << mWrittenRowsCount 
+              << " of " << mImageHeight << " rows are written" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/*
+* private:
+*/
+bool StreamingImageWriter::writeRow(const float *colors) {
+  if (mFormat == STREAMING_IMAGE_PFM) {
+    // PFM rows go from bottom to top, so each row is written at its place
+    const qint64 rowSize = mImageWidth * 3 * sizeof(float);
+    return mFile.seek(mHeaderSize + (mImageHeight - 1 - mWrittenRowsCount) * rowSize) &&
+           mFile.write(reinterpret_cast<const char *>(colors), rowSize) == rowSize;
+  }
+
+  quantizeColors(colors, mImageWidth, &mRowPixels[0]);
+  char *rowData = mRowData.data();
+  for (int x = 0; x < mImageWidth; ++x) {
+    rowData[x * 3]     = static_cast<char>((mRowPixels[x] >> 16) & 0xff);
+    rowData[x * 3 + 1] = static_cast<char>((mRowPixels[x] >> 8) & 0xff);
+    rowData[x * 3 + 2] = static_cast<char>(mRowPixels[x] & 0xff);
+  }
+  return mFile.write(mRowData) == mRowData.size();
+}
@@ -0,0 +1,63 @@
+/*!
+ *\file streamingimagewriter.h
+ *\brief Contains StreamingImageWriter class declaration
+ */
+
+#pragma once
+
+#include <vector>
+#include <QFile>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QString>
+
+// Output path which makes image to be written to standard output, so that it can be piped to external encoder
+#define STREAMING_IMAGE_STANDARD_OUTPUT "-"
+
+class StreamingImageWriter;
+
+typedef QSharedPointer<StreamingImageWriter> StreamingImageWriterPointer;
+
+enum StreamingImageFormat {
+  // Binary PPM, tone mapped 8-bit components
+  STREAMING_IMAGE_PPM,
+  // Portable float map, 32-bit float components as rendered
+  STREAMING_IMAGE_PFM
+};
+
+/*!
+ * Writes image to binary PPM or PFM file band by band, so that the whole image is never kept in memory.
+ * Format is chosen by file extension, standard output always gets PPM, as PFM rows are written out of order.
+ * Header is written at opening, bands of rows are passed in order from top to bottom.
+ */
+class StreamingImageWriter {
+  public:
+    StreamingImageWriter();
+    virtual ~StreamingImageWriter();
+
+    // Returns true if image is written as PFM to file with given path
+    static bool isHighDynamicRangeFile(const QString &filePath);
+    static bool isStandardOutput(const QString &filePath);
+
+    bool open(const QString &filePath, int imageWidth, int imageHeight);
+    // Appends rows of rendered colors, three floats per pixel
+    bool writeBand(const float *colors, int rowsCount);
+    // Fails if not all rows of image are written
+    bool close();
+
+    int getWrittenRowsCount() const { return mWrittenRowsCount; }
+
+  private:
+    bool writeRow(const float *colors);
+
+  private:
+    QFile mFile;
+    StreamingImageFormat mFormat;
+    int mImageWidth;
+    int mImageHeight;
+    int mWrittenRowsCount;
+    qint64 mHeaderSize;
+    // Row of tone mapped pixels and its 8-bit RGB triples
+    std::vector<unsigned> mRowPixels;
+    QByteArray mRowData;
+};
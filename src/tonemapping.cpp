@@ -0,0 +1,45 @@
+/*!
+ *\file tonemapping.cpp
+ *\brief Contains definition of tone mapping of rendered colors to 8-bit pixels
+ */
+
+#include <algorithm>
+
+#include "tonemapping.h"
+#include "simdpacket.h"
+
+#define TONE_MAPPING_MAX_COMPONENT_VALUE 255.f
+
+static unsigned packPixel(float red, float green, float blue) {
+  return 0xff000000 | (static_cast<unsigned>(red) << 16) | (static_cast<unsigned>(green) << 8) | static_cast<unsigned>(blue);
+}
+
+static float quantizeComponent(float value) {
+  // Zero is the first argument, so NaN value gives zero
+  return std::min(std::max(0.f, value * TONE_MAPPING_MAX_COMPONENT_VALUE), TONE_MAPPING_MAX_COMPONENT_VALUE);
+}
+
+void quantizeColors(const float *colors, int pixelsCount, unsigned *pixels) {
+  const Packet maxComponentValue = packetSet(TONE_MAPPING_MAX_COMPONENT_VALUE);
+  const Packet zero = packetSet(0.f);
+  // PACKET_SIZE pixels are three packets of interleaved components
+  float quantizedComponents[3 * PACKET_SIZE];
+
+  int pixel = 0;
+  for (; pixel + PACKET_SIZE <= pixelsCount; pixel += PACKET_SIZE) {
+    const float *components = colors + pixel * 3;
+    for (int packet = 0; packet < 3; ++packet) {
+      // NaN lanes become zero, as max returns its second argument for them
+      Packet value = packetMax(packetMul(packetLoad(components + packet * PACKET_SIZE), maxComponentValue), zero);
+      packetStore(quantizedComponents + packet * PACKET_SIZE, packetMin(value, maxComponentValue));
+    }
+    for (int i = 0; i < PACKET_SIZE; ++i) {
+      pixels[pixel + i] = packPixel(quantizedComponents[i * 3], quantizedComponents[i * 3 + 1], quantizedComponents[i * 3 + 2]);
+    }
+  }
+
+  for (; pixel < pixelsCount; ++pixel) {
+    const float *components = colors + pixel * 3;
+    pixels[pixel] = packPixel(quantizeComponent(components[0]), quantizeComponent(components[1]), quantizeComponent(components[2]));
+  }
+}
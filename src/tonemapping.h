@@ -0,0 +1,13 @@
+/*!
+ *\file tonemapping.h
+ *\brief Contains declaration of tone mapping of rendered colors to 8-bit pixels
+ */
+
+#pragma once
+
+/*
+ * Converts high dynamic range colors (three floats per pixel) to pixels of 32-bit RGB format (0xffRRGGBB).
+ * Components are clamped to [0, 1] range and quantized to 8 bits, NaN components become zero.
+ * Colors are processed a packet at a time, so the pass is run separately from rendering over whole rows.
+ */
+void quantizeColors(const float *colors, int pixelsCount, unsigned *pixels);
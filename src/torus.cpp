@@ -1,15 +1,17 @@
-#include <quarticsolver.h>
-
 #include "torus.h"
 #include "rayintersection.h"
-
+#include "floatquarticequation.h"
 
 Torus::Torus(Vector center, Vector axis, float innerRadius, float outerRadius, MaterialPointer material) 
   : Shape(material),
     mCenter(center),
     mAxis(axis),
     mInnerRadius(innerRadius),
-    mOuterRadius(outerRadius) {
+    mOuterRadius(outerRadius),
+    mFrame(center, axis),
+    mSquaredInnerRadius(innerRadius * innerRadius),
+    mSquaredOuterRadius(outerRadius * outerRadius),
+    mSquaredBoundingRadius((outerRadius + innerRadius) * (outerRadius + innerRadius)) {
   mAxis.normalize();
 }
 
@@ -17,66 +19,80 @@ Torus::~Torus() {
 }
 
 RayIntersection Torus::intersectWithRay(const Ray &ray) const {
-  Vector rayOriginPosition = ray.getOriginPosition();
-  Vector rayDirection = ray.getDirection();
-  
-  Vector centerToRayOrigin = rayOriginPosition - mCenter;
-  const float centerToRayOriginDotDirection = rayDirection.dotProduct(centerToRayOrigin);
-  float	centerToRayOriginDotDirectionSquared = centerToRayOrigin.dotProduct(centerToRayOrigin);
-  float innerRadiusSquared = mInnerRadius * mInnerRadius;
-  float outerRadiusSquared = mOuterRadius * mOuterRadius;
+  // Transform ray to local frame, where torus axis is Z axis and torus center is at origin
+  Vector rayOrigin    = mFrame.toLocalPoint(ray.getOriginPosition());
+  Vector rayDirection = mFrame.toLocalDirection(ray.getDirection());
 
-  float	axisDotCenterToRayOrigin	= mAxis.dotProduct(centerToRayOrigin);
-  float	axisDotRayDirection = mAxis.dotProduct(rayDirection);
-  float	a = 1 - axisDotRayDirection * axisDotRayDirection;
-  float	b = 2 * (centerToRayOrigin.dotProduct(rayDirection) - axisDotCenterToRayOrigin * axisDotRayDirection);
-  float c = centerToRayOriginDotDirectionSquared - axisDotCenterToRayOrigin * axisDotCenterToRayOrigin;
-  float	d = centerToRayOriginDotDirectionSquared + outerRadiusSquared - innerRadiusSquared;
+  // Cull rays by bounding sphere
+  float rayOriginDotDirection = rayOrigin.dotProduct(rayDirection);
+  float descriminant = rayOriginDotDirection * rayOriginDotDirection - rayOrigin.dotProduct(rayOrigin) + mSquaredBoundingRadius;
+  if (descriminant < 0.f) {
+    return RayIntersection();
+  }
+  descriminant = sqrtf(descriminant);
+  float nearDistance = -rayOriginDotDirection - descriminant;
+  float farDistance = -rayOriginDotDirection + descriminant;
 
-  // Solve quartic equation with coefficients A, B, C, D and E
-  float A = 1; 
-  float B = 4 * centerToRayOriginDotDirection;
-  float C = 2 * d + B * B * 0.25f - 4 * outerRadiusSquared * a;
-  float D = B * d - 4 * outerRadiusSquared * b;
-  float E = d * d - 4 * outerRadiusSquared * c;
-  
-  // Maximum number of roots is 4
-  QuarticEquation equation(A, B, C, D, E);
-  const int maxRootsCount = 4;
-  double roots[maxRootsCount] = {-1.0, -1.0, -1.0, -1.0};
-  int rootsCount = equation.Solve(roots);
+  // Cull rays by slab |z| <= inner radius containing the torus
+  if (rayDirection.z != 0.f) {
+    float invertedDirection = 1.f / rayDirection.z;
+    float slabNear = (-mInnerRadius - rayOrigin.z) * invertedDirection;
+    float slabFar = (mInnerRadius - rayOrigin.z) * invertedDirection;
+    if (slabNear > slabFar) {
+      std::swap(slabNear, slabFar);
+    }
+    nearDistance = std::max(nearDistance, slabNear);
+    farDistance = std::min(farDistance, slabFar);
+  } else if (fabs(rayOrigin.z) > mInnerRadius) {
+    return RayIntersection();
+  }
 
-  if (rootsCount == 0) {
+  nearDistance = std::max(nearDistance, 0.f);
+  farDistance = std::min(farDistance, ray.getMaxDistance());
+  if (nearDistance > farDistance) {
     return RayIntersection();
   }
 
-  // Find closest to zero positive solution
-  float closestRoot = MAX_DISTANCE_TO_INTERSECTON;
-  std::vector<float> intersectionDistances;  
-  for (int idx = 0; idx < maxRootsCount; ++idx) {
-    float root = roots[idx];
-    if (root > FLOAT_ZERO && root < closestRoot) {
-      closestRoot = root;
+  // Move ray origin to the bounding volume entry, so quartic roots are small and float precision is enough
+  rayOrigin += rayDirection * nearDistance;
+  rayOriginDotDirection = rayOrigin.dotProduct(rayDirection);
+  float d = rayOrigin.dotProduct(rayOrigin) + mSquaredOuterRadius - mSquaredInnerRadius;
+  float fourSquaredOuterRadius = 4 * mSquaredOuterRadius;
+
+  // Solve quartic equation with coefficients 1, B, C, D and E
+  float B = 4 * rayOriginDotDirection;
+  float C = 2 * d + B * B * 0.25f - fourSquaredOuterRadius * (rayDirection.x * rayDirection.x + rayDirection.y * rayDirection.y);
+  float D = B * d - 2 * fourSquaredOuterRadius * (rayOrigin.x * rayDirection.x + rayOrigin.y * rayDirection.y);
+  float E = d * d - fourSquaredOuterRadius * (rayOrigin.x * rayOrigin.x + rayOrigin.y * rayOrigin.y);
+
+  // Maximum number of roots is 4, they are returned in ascending order
+  FloatQuarticEquation equation(B, C, D, E);
+  const int maxRootsCount = 4;
+  float roots[maxRootsCount];
+  int rootsCount = equation.solve(0.f, farDistance - nearDistance, roots);
+
+  std::vector<float> intersectionDistances;
+  for (int idx = 0; idx < rootsCount; ++idx) {
+    float root = roots[idx] + nearDistance;
+    if (root > FLOAT_ZERO) {
       intersectionDistances.push_back(root);
     }
   }
 
-  if (closestRoot != MAX_DISTANCE_TO_INTERSECTON) {
-    std::sort(intersectionDistances.begin(), intersectionDistances.end());
-    TorusPointer pointer = TorusPointer(new Torus(*this));
-    return RayIntersection(true, pointer, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
+  if (!intersectionDistances.empty()) {
+    float closestRoot = intersectionDistances.front();
+    return RayIntersection(true, this, closestRoot, getNormal(ray, closestRoot), intersectionDistances);
   }
 
   return RayIntersection();
 }
 
 Vector Torus::getNormal(const Ray &ray, float distance) const {
-  Vector point = ray.getPointAt(distance);  
-  Vector centerToPoint = point - mCenter;
-  float	centerToPointDotAxis = centerToPoint.dotProduct(mAxis);
-  Vector direction = centerToPoint - mAxis * centerToPointDotAxis;
-  direction.normalize();
-  Vector normal = point - mCenter + direction * mOuterRadius;
+  Vector point = mFrame.toLocalPoint(ray.getPointAt(distance));
+  // Normal is directed from the closest point of torus central circle to intersection point
+  float distanceToAxis = sqrtf(point.x * point.x + point.y * point.y);
+  float scale = distanceToAxis > FLOAT_ZERO ? mOuterRadius / distanceToAxis : 0.f;
+  Vector normal = mFrame.toWorldDirection(Vector(point.x - point.x * scale, point.y - point.y * scale, point.z));
   normal.normalize();
   return normal;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "shape.h"
+#include "coordinateframe.h"
 
 class Torus;
 
@@ -14,9 +15,20 @@ class Torus : public Shape {
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const Vector &getCenter() const { return mCenter; }
+    float getBoundingRadius() const { return mOuterRadius + mInnerRadius; }
+
   private:
     Vector mCenter;
     Vector mAxis;
     float mInnerRadius;
     float mOuterRadius;
+
+    // Invariants calculated at construction
+    // Local frame with origin at torus center and Z axis directed along torus axis
+    CoordinateFrame mFrame;
+    float mSquaredInnerRadius;
+    float mSquaredOuterRadius;
+    // Squared radius of bounding sphere centered at torus center
+    float mSquaredBoundingRadius;
 };
\ No newline at end of file
@@ -6,9 +6,9 @@ Triangle::Triangle(Vector vertex0, Vector vertex1, Vector vertex2, MaterialPoint
     mVertex0(vertex0),
     mVertex1(vertex1),
     mVertex2(vertex2) {
-  Vector e1 = vertex1 - vertex0;
-  Vector e2 = vertex2 - vertex0;
-  mNormal = e1.crossProduct(e2);
+  mEdge1 = vertex1 - vertex0;
+  mEdge2 = vertex2 - vertex0;
+  mNormal = mEdge1.crossProduct(mEdge2);
   mNormal.normalize();
 }
 
@@ -19,11 +19,8 @@ RayIntersection Triangle::intersectWithRay(const Ray &ray) const {
   Vector rayOrigin	= ray.getOriginPosition();
   Vector rayDirection = ray.getDirection();
 
-  Vector e1 = mVertex1 - mVertex0;
-  Vector e2 = mVertex2 - mVertex0;
-
-  Vector pvector = rayDirection.crossProduct(e2);
-  float	determinant = e1.dotProduct(pvector);
+  Vector pvector = rayDirection.crossProduct(mEdge2);
+  float	determinant = mEdge1.dotProduct(pvector);
 
   if (fabs(determinant) < FLOAT_ZERO) {
     return RayIntersection();
@@ -40,7 +37,7 @@ RayIntersection Triangle::intersectWithRay(const Ray &ray) const {
     return RayIntersection();
   }
 
-  Vector qvec = tvec.crossProduct(e1);
+  Vector qvec = tvec.crossProduct(mEdge1);
   float	mue	= rayDirection.dotProduct(qvec);
 
   mue *= invertedDeterminant;
@@ -49,7 +46,7 @@ RayIntersection Triangle::intersectWithRay(const Ray &ray) const {
     return RayIntersection();
   }
 
-  float f = e2.dotProduct(qvec);
+  float f = mEdge2.dotProduct(qvec);
   f = f * invertedDeterminant - FLOAT_ZERO;
 
   if (f < FLOAT_ZERO) {
@@ -58,8 +55,7 @@ RayIntersection Triangle::intersectWithRay(const Ray &ray) const {
   
   std::vector<float> intersectionDistances;
   intersectionDistances.push_back(f);
-  TrianglePointer pointer = TrianglePointer(new Triangle(*this));
-  return RayIntersection(true, pointer, f, getNormal(ray, f), intersectionDistances);
+  return RayIntersection(true, this, f, getNormal(ray, f), intersectionDistances);
 }
 
 Vector Triangle::getNormal(const Ray &ray, float distance) const {
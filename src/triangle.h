@@ -20,9 +20,17 @@ class Triangle : public Shape {
     virtual RayIntersection intersectWithRay(const Ray &ray) const;
     virtual Vector getNormal(const Ray &ray, float distance) const;
 
+    const Vector &getVertex0() const { return mVertex0; }
+    const Vector &getVertex1() const { return mVertex1; }
+    const Vector &getVertex2() const { return mVertex2; }
+
   protected:
     Vector mVertex0;
     Vector mVertex1;
     Vector mVertex2;
     Vector mNormal;
+
+    // Triangle edges calculated at construction
+    Vector mEdge1;
+    Vector mEdge2;
 };
\ No newline at end of file
@@ -5,8 +5,11 @@
 
 #pragma once
 
+#include <float.h>
 #include <vmath.h>
 
+#include "simdvector.h"
+
 #define FLOAT_ZERO 0.000001f
 // Small value used to emit shadow rays
 #define EPS_FOR_SHADOW_RAYS 0.01f
@@ -15,6 +18,6 @@
 
 #define MAX_DISTANCE_TO_INTERSECTON FLT_MAX
 
-typedef Vector3f Vector;
-typedef Vector3f Color;
+typedef SimdVector3 Vector;
+typedef SimdVector3 Color;
 typedef Vector2f Roots;
\ No newline at end of file